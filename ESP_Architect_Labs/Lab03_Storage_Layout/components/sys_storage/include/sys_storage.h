@@ -1,21 +1,179 @@
 #pragma once
 #include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * 配置的字段表：结构体、flash 上的编码、解码和迁移都从这张表生成。
+ *
+ *   X(类型, 字段名, 从哪个 schema 版本开始有, 老版本 blob 里没有它时的默认值)
+ *
+ * 加字段：只能加在末尾，since 写新版本号，再把 SYS_CONFIG_SCHEMA_VERSION 加一
+ * (sys_config_codec.c 里的布局指纹断言会提醒你)。老版本的 blob 是新版本的前缀，
+ * 加载时缺的字段取默认值，然后自动按新版本写回去。
+ * 字段按声明顺序紧挨着排，每个字段的偏移必须是自身大小的整数倍 (编译期检查)，
+ * 这样从对齐的缓冲区解码时每个字段只是一次对齐的读。
+ */
+#define SYS_CONFIG_FIELDS(X)              \
+    X(uint32_t, magic_id,   1, 0)         \
+    X(uint16_t, config_ver, 1, 0)         \
+    X(uint8_t,  flag,       1, 0)
+
+// v1: 7 字节裸字段 (最早的 serialize_internal)，没有头也没有 CRC
+// v2: 8 字节头 (版本 / payload 长度 / CRC32) + 字段
+#define SYS_CONFIG_SCHEMA_VERSION 2
+
 typedef struct{
-    uint32_t magic_id;
-    uint16_t config_ver;
-    uint8_t flag;
+#define SYS_CONFIG_DECLARE(type,name,since,def) type name;
+    SYS_CONFIG_FIELDS(SYS_CONFIG_DECLARE)
+#undef SYS_CONFIG_DECLARE
 } sys_config_t;
 
+// 写回缓存的计数 (关掉 CONFIG_SYS_STORAGE_WRITE_BACK 时 suppressed/coalesced/load_hits 恒为 0)
+typedef struct{
+    uint32_t saves;          // sys_storage_save 调用次数
+    uint32_t suppressed;     // 和缓存里的值一模一样，直接丢掉 (不写 flash)
+    uint32_t coalesced;      // 覆盖了还没落盘的脏值 (前一个值永远不用写了)
+    uint32_t commits;        // 真正执行的 nvs_set_blob + nvs_commit
+    uint32_t commit_errors;
+    uint32_t loads;          // sys_storage_load 调用次数
+    uint32_t load_hits;      // 直接从 RAM 返回的 load
+    uint32_t migrations;     // 读到老版本 blob，升级成当前版本写回
+    uint32_t txn_commits;    // 成功提交的批量事务
+    uint32_t txn_rollbacks;  // 挂载时 / 提交失败后擦掉的未提交槽位
+    uint32_t blob_raw_bytes;     // sys_storage_put_blob 收到的字节数
+    uint32_t blob_stored_bytes;  // 实际交给 NVS 的字节数 (含 12 字节头)
+} sys_storage_stats_t;
+
 esp_err_t sys_storage_init(void);
 esp_err_t sys_storage_save(const sys_config_t *cfg);
 esp_err_t sys_storage_load(sys_config_t *cfg);
 
+/**
+ * @brief 立刻把缓存里的脏值写进 NVS，返回时数据已经 commit
+ *
+ * 写回模式下 save 只改 RAM，掉电前必须落盘的更新 (比如写完就要断电的工厂配置) 之后调这个。
+ * esp_restart() 会通过 shutdown handler 自动调用一次。没开写回缓存时直接返回 ESP_OK。
+ */
+esp_err_t sys_storage_flush(void);
+
+void sys_storage_get_stats(sys_storage_stats_t *stats);
+void sys_storage_reset_stats(void);
+
+/*
+ * 快速启动 (CONFIG_SYS_STORAGE_FAST_BOOT)：每次 commit 成功后，配置另外写一份到 cfgsnap 分区
+ * (固定布局 + CRC)。启动时 sys_storage_init 直接 mmap 读这份快照就返回，load 马上能用；
+ * NVS 的挂载、事务恢复放到后台任务，挂好后和快照核对一次 (不一致以 NVS 为准)。
+ * 在这之前调用 save/flush/begin/get 会等到 NVS 挂好。
+ */
+typedef struct{
+    int64_t config_ready_us;  // sys_storage_init 返回、配置可以 load 的时间 (esp_timer，从上电算起)
+    int64_t nvs_ready_us;     // NVS 挂载 + 事务恢复完成的时间，0 = 后台还没做完
+    bool from_snapshot;       // 这次启动的配置来自快照
+    bool snapshot_stale;      // 快照比 NVS 旧 (commit 之后、写快照之前掉过电)
+} sys_storage_boot_info_t;
+
+void sys_storage_get_boot_info(sys_storage_boot_info_t *info);
+
+/**
+ * @brief 等后台的 NVS 挂载完成
+ * @return 挂载结果；超时返回 ESP_ERR_TIMEOUT。同步挂载时直接返回 ESP_OK
+ */
+esp_err_t sys_storage_wait_ready(uint32_t timeout_ms);
+
+/*
+ * 多个 key 的批量事务：要么全部生效，要么一个都不生效 (包括中途掉电)
+ *
+ *   sys_storage_begin();
+ *   sys_storage_put("wifi_ssid",ssid,len);
+ *   sys_storage_put("wifi_pass",pass,len);
+ *   sys_storage_commit();
+ *
+ * begin 到 commit/abort 之间持有事务锁，同一时间只有一个事务；put 把值拷进 RAM 暂存区，
+ * commit 时一次打开、一次 nvs_commit 全部写下去。key 不超过 SYS_STORAGE_KEY_MAX 个字符，不能含 '~'。
+ * 这些 key 在单独的 namespace 里，和 sys_storage_save 的配置互不影响。
+ */
+#define SYS_STORAGE_KEY_MAX 13
+
+esp_err_t sys_storage_begin(void);
+esp_err_t sys_storage_put(const char *key,const void *data,size_t len);
+esp_err_t sys_storage_commit(void);
+void sys_storage_abort(void);
+
+/**
+ * @brief 读最近一次提交的值
+ * @param data  NULL 时只在 *len 里返回长度
+ * @param len   进：data 的容量；出：值的长度
+ */
+esp_err_t sys_storage_get(const char *key,void *data,size_t *len);
+
+/*
+ * 大块数据 (校准表、查找曲线)：单独的 namespace，一个 key 一个 blob，
+ * 写的时候能压就用内置的 LZ 压一下，头里记着 codec 和原始长度，读的时候透明解开。
+ * 单个值最大 CONFIG_SYS_STORAGE_BLOB_MAX_SIZE，key 不超过 SYS_STORAGE_BLOB_KEY_MAX 个字符。
+ */
+#define SYS_STORAGE_BLOB_KEY_MAX 15
+
+#define SYS_STORAGE_CODEC_RAW 0
+#define SYS_STORAGE_CODEC_LZ  1
+
+typedef struct{
+    uint8_t codec;           // SYS_STORAGE_CODEC_*
+    uint32_t raw_len;        // 原始长度
+    uint32_t stored_len;     // NVS 里 blob 的长度 (含头)
+} sys_storage_blob_info_t;
+
+esp_err_t sys_storage_put_blob(const char *key,const void *data,size_t len);
+
+/**
+ * @param data  NULL 时只在 *len 里返回原始长度
+ * @param len   进：data 的容量；出：原始长度
+ * @return ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_SIZE：存的数据损坏
+ */
+esp_err_t sys_storage_get_blob(const char *key,void *data,size_t *len);
+esp_err_t sys_storage_blob_info(const char *key,sys_storage_blob_info_t *info);
+esp_err_t sys_storage_erase_blob(const char *key);
+
+/**
+ * @brief LZ 编解码自检：各种数据往返、截断 / 改坏的输入只报错不越界。只动内存
+ */
+esp_err_t sys_storage_blob_selftest(void);
+
+/**
+ * @brief 典型数据 (校准表 / 曲线 / 文本 / 随机) 的压缩率、编解码速度，原样存 vs 压缩存写掉的 flash
+ */
+esp_err_t sys_storage_blob_bench_run(void);
+
+/**
+ * @brief 延迟和磨损基准：配置接口，以及 16B~4KB 的值 x 1/16/64 个 key，空分区和灌到 CONFIG_SYS_STORAGE_BENCH_FILL_PCT% 各跑一遍
+ *
+ * save / commit / load 的 p50/p90/p99/max，每次操作写掉的 entry、擦掉的页和写入字节。
+ * 会擦掉整个 storage 分区 (跑完把当前配置写回去)。
+ */
+esp_err_t sys_storage_bench_run(void);
+
+/**
+ * @brief N 次单独保存 vs 一次批量提交：耗时、写掉的 NVS entry，以及擦除次数和写入字节 (仅 linux 目标)
+ */
+esp_err_t sys_storage_txn_bench_run(void);
+
+/**
+ * @brief 批量提交过程中掉电 (linux 目标，esp_partition_fail_after)，重新挂载后检查全有或全无
+ */
+esp_err_t sys_storage_txn_fault_test(void);
+
+/**
+ * @brief 编解码自检：随机值往返、v1 老格式迁移、CRC 损坏 / 截断 / 未来版本的处理
+ *
+ * 只动内存，不碰 NVS。linux 目标上默认在启动时跑 (CONFIG_SYS_STORAGE_CODEC_SELFTEST)。
+ */
+esp_err_t sys_storage_codec_selftest(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 只追加的遥测日志 (sys_storage 的一部分)，放在 partitions.csv 的 "tlog" 分区上，不经过 NVS。
+ *
+ * 布局：分区按 4KB 扇区组成环，每个扇区 = 扇区头 + 一串 4 字节对齐的记录
+ *   扇区头   magic | 扇区序号 (每次擦除 +1) | 本扇区第一条记录的 seq | CRC
+ *   记录     seq | len | type | CRC(seq,len,type,payload) | payload | 补齐
+ *
+ * + 写满一个扇区就擦下一个 (环上最旧的)：擦写次数均匀摊到所有扇区上。
+ * + 掉电恢复：挂载时找扇区序号最大的扇区，从头扫到第一个全 0xFF 的记录头就是尾部；
+ *   扫到 CRC 不对的记录 (写了一半) 就把这个扇区封掉，下一条记录写到新扇区。
+ * + 读是零拷贝的：整个分区 esp_partition_mmap 一次，记录的 data 直接指向映射出来的 flash。
+ */
+
+#define SYS_TLOG_SECTOR_SIZE  4096
+#define SYS_TLOG_MAX_PAYLOAD  (SYS_TLOG_SECTOR_SIZE-16-12)   // 一个空扇区放得下的最大记录
+
+typedef struct{
+    uint32_t seq;            // 单调递增，从 1 开始
+    uint16_t type;           // 调用者自己定义
+    uint16_t len;
+    const void *data;        // 指向 flash 映射，只读；所在扇区被轮转擦掉之前有效
+} sys_tlog_record_t;
+
+typedef struct{
+    uint32_t sector;         // 物理扇区号
+    uint32_t offset;         // 扇区内偏移
+    uint32_t remaining;      // 还没走过的扇区数
+} sys_tlog_iter_t;
+
+typedef struct{
+    uint32_t sectors;        // 环上的扇区数
+    uint32_t next_seq;       // 下一条记录的 seq
+    uint32_t appends;
+    uint32_t append_errors;
+    uint32_t bytes;          // 追加的 payload 字节数
+    uint32_t erases;         // 本次挂载以来擦过的扇区数
+    uint32_t torn_tails;     // 挂载时发现的半截记录 (掉电恢复次数)
+} sys_tlog_stats_t;
+
+/**
+ * @brief 挂载日志分区：映射整个分区，找到最新的扇区并恢复写入位置
+ */
+esp_err_t sys_tlog_init(void);
+esp_err_t sys_tlog_deinit(void);
+
+/**
+ * @brief 追加一条记录，返回时记录已经写进 flash (不经过任何 RAM 缓冲)
+ * @param out_seq  可为 NULL
+ */
+esp_err_t sys_tlog_append(uint16_t type,const void *data,size_t len,uint32_t *out_seq);
+
+/**
+ * @brief 擦掉所有扇区，seq 从 1 重新开始
+ */
+esp_err_t sys_tlog_clear(void);
+
+/**
+ * @brief 从最旧的记录开始遍历
+ *
+ * 和 append 之间没有锁：遍历期间追加的记录可能读到也可能读不到，
+ * 遍历中途扇区被轮转擦掉时该扇区剩下的记录会被 CRC 挡掉。
+ */
+void sys_tlog_iter_begin(sys_tlog_iter_t *it);
+bool sys_tlog_iter_next(sys_tlog_iter_t *it,sys_tlog_record_t *rec);
+
+void sys_tlog_get_stats(sys_tlog_stats_t *stats);
+
+/**
+ * @brief 不同记录长度下的追加吞吐和零拷贝遍历速度 (会清空日志)
+ */
+esp_err_t sys_tlog_bench_run(void);
+
+/**
+ * @brief 掉电注入测试 (会清空日志)
+ *
+ * 在任意位置写半截记录 / 半截扇区头，重新挂载后检查：已经确认的记录一条不少、seq 连续、之后还能接着写。
+ * linux 目标上额外用分区模拟的 esp_partition_fail_after() 让第 N 次 flash 操作失败，N 逐个扫过去。
+ */
+esp_err_t sys_tlog_fault_test(void);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
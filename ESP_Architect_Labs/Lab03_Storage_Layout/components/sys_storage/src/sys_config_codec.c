@@ -0,0 +1,161 @@
+#include "sys_config_codec.h"
+#include "sys_storage_priv.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const char *TAG="SYS_CODEC";
+
+#if __BYTE_ORDER__!=__ORDER_LITTLE_ENDIAN__
+#error "sys_config codec stores fields in CPU byte order, which must be little-endian"
+#endif
+
+// ----------------------------------------------------------------------
+// 1. 编译期检查
+// ----------------------------------------------------------------------
+_Static_assert(sizeof(sys_cfg_hdr_t)==8,"payload must start 4-byte aligned");
+
+// 每个字段按自身大小对齐：解码时是一次对齐的读，不用逐字节拼
+#define SYS_CONFIG_CHECK_ALIGN(type,name,since,def) \
+    _Static_assert(offsetof(sys_cfg_wire_t,name)%sizeof(type)==0,#name " is not naturally aligned on the wire");
+SYS_CONFIG_FIELDS(SYS_CONFIG_CHECK_ALIGN)
+#undef SYS_CONFIG_CHECK_ALIGN
+
+// 布局指纹：字段的顺序、大小、since 任何一个变了它就变
+enum{
+#define SYS_CONFIG_INDEX(type,name,since,def) SYS_CFG_IDX_##name,
+    SYS_CONFIG_FIELDS(SYS_CONFIG_INDEX)
+#undef SYS_CONFIG_INDEX
+};
+
+#define SYS_CONFIG_HASH(type,name,since,def) \
+    +(uint32_t)(sizeof(type)*16u+(since))*(2u*SYS_CFG_IDX_##name+1u)*2654435761u
+#define SYS_CFG_LAYOUT_HASH ((uint32_t)(0u SYS_CONFIG_FIELDS(SYS_CONFIG_HASH)))
+
+// 改了字段表就必须升版本：确认新字段加在末尾、since 是新版本号之后，把这两个数一起更新
+_Static_assert(SYS_CONFIG_SCHEMA_VERSION==2&&SYS_CFG_LAYOUT_HASH==0xE3F55D29u,
+               "SYS_CONFIG_FIELDS changed: bump SYS_CONFIG_SCHEMA_VERSION and update the layout hash");
+
+// ----------------------------------------------------------------------
+// 2. 编码 / 解码
+// ----------------------------------------------------------------------
+size_t sys_cfg_encode(const sys_config_t *cfg,uint8_t *buf)
+{
+    sys_cfg_hdr_t *hdr=(sys_cfg_hdr_t *)buf;
+    uint8_t *payload=__builtin_assume_aligned(buf+sizeof(*hdr),4);
+
+#define SYS_CONFIG_ENCODE(type,name,since,def) \
+    memcpy(payload+offsetof(sys_cfg_wire_t,name),&cfg->name,sizeof(type));
+    SYS_CONFIG_FIELDS(SYS_CONFIG_ENCODE)
+#undef SYS_CONFIG_ENCODE
+
+    hdr->version=SYS_CONFIG_SCHEMA_VERSION;
+    hdr->reserved=0;
+    hdr->len=sizeof(sys_cfg_wire_t);
+    hdr->crc=esp_rom_crc32_le(0,payload,sizeof(sys_cfg_wire_t));
+
+    return SYS_CFG_BLOB_SIZE;
+}
+
+// 老版本的 payload 是新版本的前缀：blob 里有的字段直接读，没有的 (since 更新或者长度不够) 取默认值
+static void decode_fields(const uint8_t *payload,size_t len,uint8_t version,sys_config_t *cfg)
+{
+    payload=__builtin_assume_aligned(payload,4);
+
+#define SYS_CONFIG_DECODE(type,name,since,def)                                     \
+    if((since)<=version&&offsetof(sys_cfg_wire_t,name)+sizeof(type)<=len)           \
+        memcpy(&cfg->name,payload+offsetof(sys_cfg_wire_t,name),sizeof(type));      \
+    else                                                                            \
+        cfg->name=(def);
+    SYS_CONFIG_FIELDS(SYS_CONFIG_DECODE)
+#undef SYS_CONFIG_DECODE
+}
+
+esp_err_t sys_cfg_decode(const uint8_t *buf,size_t len,sys_config_t *cfg,uint8_t *version)
+{
+    const uint8_t *payload;
+    size_t plen;
+    uint8_t ver;
+
+    if(len==SYS_CFG_V1_SIZE){
+        // v1：只有字段 (带头的 blob 至少 8 字节，不会混淆)
+        ver=1;
+        payload=buf;
+        plen=len;
+    }else{
+        const sys_cfg_hdr_t *hdr=(const sys_cfg_hdr_t *)buf;
+
+        if(len<sizeof(*hdr)||hdr->version<2||sizeof(*hdr)+hdr->len!=len) return ESP_ERR_INVALID_SIZE;
+
+        ver=hdr->version;
+        payload=buf+sizeof(*hdr);
+        plen=hdr->len;
+        if(esp_rom_crc32_le(0,payload,plen)!=hdr->crc) return ESP_ERR_INVALID_CRC;
+    }
+
+    // 比我们新的版本：认识的字段照读，多出来的忽略
+    decode_fields(payload,plen,ver,cfg);
+
+    if(version!=NULL) *version=ver;
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 3. 自检
+// ----------------------------------------------------------------------
+static uint32_t s_rng=0x12345678;
+
+static bool cfg_equal(const sys_config_t *a,const sys_config_t *b)
+{
+#define SYS_CONFIG_EQUAL(type,name,since,def) if(a->name!=b->name) return false;
+    SYS_CONFIG_FIELDS(SYS_CONFIG_EQUAL)
+#undef SYS_CONFIG_EQUAL
+    return true;
+}
+
+esp_err_t sys_storage_codec_selftest(void)
+{
+    uint8_t buf[SYS_CFG_BLOB_SIZE+8] __attribute__((aligned(4)));
+    sys_config_t in,out;
+    uint8_t ver;
+    size_t len;
+
+    // [A] 随机值往返
+    for(int i=0;i<256;i++){
+#define SYS_CONFIG_RANDOM(type,name,since,def) in.name=(type)sys_test_rng_next(&s_rng);
+        SYS_CONFIG_FIELDS(SYS_CONFIG_RANDOM)
+#undef SYS_CONFIG_RANDOM
+        len=sys_cfg_encode(&in,buf);
+        SYS_TEST_CHECK(len==SYS_CFG_BLOB_SIZE,"encoded length");
+        SYS_TEST_CHECK(sys_cfg_decode(buf,len,&out,&ver)==ESP_OK,"round trip decode");
+        SYS_TEST_CHECK(ver==SYS_CONFIG_SCHEMA_VERSION&&cfg_equal(&in,&out),"round trip value");
+    }
+
+    // [B] v1 老格式 (原来 serialize_internal 的输出)：config_ver 的高字节不能丢
+    const uint8_t v1[SYS_CFG_V1_SIZE] __attribute__((aligned(4)))={0xDD,0xCC,0xBB,0xAA,0x34,0x12,0xFF};
+    SYS_TEST_CHECK(sys_cfg_decode(v1,sizeof(v1),&out,&ver)==ESP_OK&&ver==1,"v1 decode");
+    SYS_TEST_CHECK(out.magic_id==0xAABBCCDD&&out.config_ver==0x1234&&out.flag==0xFF,"v1 value");
+
+    // [C] 迁移：v1 解码后按当前版本重新编码，再解一遍还是同样的值
+    len=sys_cfg_encode(&out,buf);
+    SYS_TEST_CHECK(sys_cfg_decode(buf,len,&in,&ver)==ESP_OK&&ver==SYS_CONFIG_SCHEMA_VERSION&&cfg_equal(&in,&out),"v1 migration");
+
+    // [D] 损坏：payload 翻一位、截断、头说的长度不对
+    buf[sizeof(sys_cfg_hdr_t)]^=0x01;
+    SYS_TEST_CHECK(sys_cfg_decode(buf,len,&out,&ver)==ESP_ERR_INVALID_CRC,"flipped bit");
+    buf[sizeof(sys_cfg_hdr_t)]^=0x01;
+    SYS_TEST_CHECK(sys_cfg_decode(buf,len-1,&out,&ver)==ESP_ERR_INVALID_SIZE,"truncated blob");
+    SYS_TEST_CHECK(sys_cfg_decode(buf,3,&out,&ver)==ESP_ERR_INVALID_SIZE,"short blob");
+
+    // [E] 未来版本 (末尾多了我们不认识的字段)：认识的字段照读
+    sys_cfg_hdr_t *hdr=(sys_cfg_hdr_t *)buf;
+    memset(buf+len,0xA5,4);
+    hdr->version=SYS_CONFIG_SCHEMA_VERSION+1;
+    hdr->len+=4;
+    hdr->crc=esp_rom_crc32_le(0,buf+sizeof(*hdr),hdr->len);
+    SYS_TEST_CHECK(sys_cfg_decode(buf,len+4,&out,&ver)==ESP_OK&&ver==SYS_CONFIG_SCHEMA_VERSION+1&&cfg_equal(&in,&out),"newer version");
+
+    ESP_LOGI(TAG,"Codec selftest passed (schema v%d, %u byte blob)",SYS_CONFIG_SCHEMA_VERSION,(unsigned)SYS_CFG_BLOB_SIZE);
+    return ESP_OK;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include "sys_storage.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// flash 上的格式： [头 8 字节] [字段，按 SYS_CONFIG_FIELDS 的顺序紧挨着排，小端]
+typedef struct{
+    uint8_t version;         // SYS_CONFIG_SCHEMA_VERSION
+    uint8_t reserved;
+    uint16_t len;            // payload 字节数
+    uint32_t crc;            // payload 的 CRC32
+} sys_cfg_hdr_t;
+
+// 字段在 payload 里的排布，只用来在编译期算偏移和大小，从不直接访问
+typedef struct __attribute__((packed)){
+#define SYS_CONFIG_WIRE(type,name,since,def) type name;
+    SYS_CONFIG_FIELDS(SYS_CONFIG_WIRE)
+#undef SYS_CONFIG_WIRE
+} sys_cfg_wire_t;
+
+#define SYS_CFG_V1_SIZE 7                                        // v1 没有头
+#define SYS_CFG_BLOB_SIZE (sizeof(sys_cfg_hdr_t)+sizeof(sys_cfg_wire_t))
+
+/**
+ * @brief 编码成当前版本
+ * @param buf  至少 SYS_CFG_BLOB_SIZE，4 字节对齐
+ * @return 写入的字节数
+ */
+size_t sys_cfg_encode(const sys_config_t *cfg,uint8_t *buf);
+
+/**
+ * @brief 解码任意版本 (v1 裸字段 / v2 起带头)，缺的字段取默认值
+ * @param buf      4 字节对齐
+ * @param version  blob 的版本，小于 SYS_CONFIG_SCHEMA_VERSION 说明需要迁移 (可为 NULL)
+ * @return ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_SIZE：blob 损坏
+ */
+esp_err_t sys_cfg_decode(const uint8_t *buf,size_t len,sys_config_t *cfg,uint8_t *version);
\ No newline at end of file
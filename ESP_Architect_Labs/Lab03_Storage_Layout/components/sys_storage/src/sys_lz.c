@@ -0,0 +1,142 @@
+#include "sys_lz.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535u
+#define RUN_MASK 15
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v,p,sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t v)
+{
+    return (v*2654435761u)>>(32-SYS_LZ_HASH_BITS);
+}
+
+// 长度 >= 15 的部分写成扩展字节
+static uint8_t *put_ext(uint8_t *op,size_t len)
+{
+    while(len>=255){
+        *op++=255;
+        len-=255;
+    }
+    *op++=(uint8_t)len;
+    return op;
+}
+
+// 一个序列：lit 个字面量，然后 (mlen>0 时) 一个匹配。放不下返回 NULL
+static uint8_t *put_seq(uint8_t *op,const uint8_t *oend,const uint8_t *lit,size_t nlit,size_t off,size_t mlen)
+{
+    // 按最坏情况估：token + 扩展 + 字面量 + offset + 扩展
+    if((size_t)(oend-op)<1+nlit/255+1+nlit+2+mlen/255+1) return NULL;
+
+    uint8_t *token=op++;
+    *token=(uint8_t)((nlit<RUN_MASK?nlit:RUN_MASK)<<4);
+    if(nlit>=RUN_MASK) op=put_ext(op,nlit-RUN_MASK);
+    memcpy(op,lit,nlit);
+    op+=nlit;
+
+    if(mlen==0) return op;
+
+    *op++=(uint8_t)off;
+    *op++=(uint8_t)(off>>8);
+    mlen-=MIN_MATCH;
+    *token|=(uint8_t)(mlen<RUN_MASK?mlen:RUN_MASK);
+    if(mlen>=RUN_MASK) op=put_ext(op,mlen-RUN_MASK);
+    return op;
+}
+
+size_t sys_lz_compress(const uint8_t *src,size_t len,uint8_t *dst,size_t cap,uint16_t *table)
+{
+    const uint8_t *ip=src;
+    const uint8_t *anchor=src;
+    const uint8_t *end=src+len;
+    uint8_t *op=dst;
+    const uint8_t *oend=dst+cap;
+
+    if(len>SYS_LZ_MAX_INPUT) return 0;
+    memset(table,0,SYS_LZ_TABLE_SIZE);
+
+    while(end-ip>=MIN_MATCH){
+        uint32_t seq=read32(ip);
+        uint32_t h=hash4(seq);
+        const uint8_t *ref=src+table[h];
+        table[h]=(uint16_t)(ip-src);
+
+        // 哈希撞了或者还没有候选 (ref==ip) 就往前走一个字节
+        if(ref>=ip||(size_t)(ip-ref)>MAX_OFFSET||read32(ref)!=seq){
+            ip++;
+            continue;
+        }
+
+        size_t mlen=MIN_MATCH;
+        while(ip+mlen<end&&ref[mlen]==ip[mlen]) mlen++;
+
+        op=put_seq(op,oend,anchor,ip-anchor,ip-ref,mlen);
+        if(op==NULL) return 0;
+
+        ip+=mlen;
+        anchor=ip;
+    }
+
+    op=put_seq(op,oend,anchor,end-anchor,0,0);
+    return op==NULL?0:(size_t)(op-dst);
+}
+
+// 读扩展字节，越界返回 false
+static bool get_ext(const uint8_t **ip,const uint8_t *iend,size_t *len)
+{
+    uint8_t b;
+    do{
+        if(*ip>=iend) return false;
+        b=*(*ip)++;
+        *len+=b;
+    }while(b==255);
+    return true;
+}
+
+esp_err_t sys_lz_decompress(const uint8_t *src,size_t len,uint8_t *dst,size_t out_len)
+{
+    const uint8_t *ip=src;
+    const uint8_t *iend=src+len;
+    uint8_t *op=dst;
+    uint8_t *oend=dst+out_len;
+
+    for(;;){
+        if(ip>=iend) return ESP_ERR_INVALID_SIZE;
+        uint8_t token=*ip++;
+
+        // [A] 字面量
+        size_t nlit=token>>4;
+        if(nlit==RUN_MASK&&!get_ext(&ip,iend,&nlit)) return ESP_ERR_INVALID_SIZE;
+        if(nlit>(size_t)(iend-ip)||nlit>(size_t)(oend-op)) return ESP_ERR_INVALID_SIZE;
+        memcpy(op,ip,nlit);
+        op+=nlit;
+        ip+=nlit;
+
+        if(ip==iend) break;                                      // 最后一个序列没有匹配
+
+        // [B] 匹配：offset 不能指到输出开头之前
+        if(iend-ip<2) return ESP_ERR_INVALID_SIZE;
+        size_t off=ip[0]|((size_t)ip[1]<<8);
+        ip+=2;
+        if(off==0||off>(size_t)(op-dst)) return ESP_ERR_INVALID_SIZE;
+
+        size_t mlen=token&RUN_MASK;
+        if(mlen==RUN_MASK&&!get_ext(&ip,iend,&mlen)) return ESP_ERR_INVALID_SIZE;
+        mlen+=MIN_MATCH;
+        if(mlen>(size_t)(oend-op)) return ESP_ERR_INVALID_SIZE;
+
+        // 匹配可以和自己重叠 (offset < 长度 时是重复前面的图案)，只能逐字节拷
+        const uint8_t *ref=op-off;
+        for(size_t i=0;i<mlen;i++) op[i]=ref[i];
+        op+=mlen;
+    }
+
+    return op==oend?ESP_OK:ESP_ERR_INVALID_SIZE;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 小型 LZ77 编解码 (字节流布局和 LZ4 block 一样，按序列排)：
+ *
+ *   [token][字面量长度扩展][字面量][offset u16 小端][匹配长度扩展]  ...  [token][字面量长度扩展][字面量]
+ *
+ * token 高 4 位 = 字面量长度，低 4 位 = 匹配长度 - 4；等于 15 时后面跟扩展字节 (每个加 0~255，直到不是 255)。
+ * 最后一个序列只有字面量。
+ *
+ * 压缩：贪心，4 字节哈希，哈希表由调用者提供 (SYS_LZ_TABLE_SIZE 字节)，不 malloc。
+ * 解压：直接写进输出缓冲区，每一步都检查边界，不用额外内存；坏数据只会返回错误，不会越界。
+ */
+#define SYS_LZ_HASH_BITS 10
+#define SYS_LZ_TABLE_SIZE ((1u<<SYS_LZ_HASH_BITS)*sizeof(uint16_t))
+#define SYS_LZ_MAX_INPUT 65535u                                  // 哈希表存的是 16 位位置
+
+// 最坏情况 (完全不可压缩) 的输出长度
+#define SYS_LZ_BOUND(n) ((n)+(n)/255+16)
+
+/**
+ * @param table  SYS_LZ_TABLE_SIZE 字节的工作区，2 字节对齐
+ * @return 压缩后的长度；放不进 cap 或者输入超过 SYS_LZ_MAX_INPUT 返回 0
+ */
+size_t sys_lz_compress(const uint8_t *src,size_t len,uint8_t *dst,size_t cap,uint16_t *table);
+
+/**
+ * @param out_len  解压后应有的长度 (存在 blob 头里)，dst 至少这么大
+ * @return ESP_ERR_INVALID_SIZE：数据损坏 / 长度对不上
+ */
+esp_err_t sys_lz_decompress(const uint8_t *src,size_t len,uint8_t *dst,size_t out_len);
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "sys_storage_priv.h"
+#include "sys_config_codec.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG="SYS_SNAP";
+
+/*
+ * 快照区：两个 4KB 扇区轮流写 (A/B)，每个扇区开头一份 [头][配置 blob]。
+ * 写一半掉电只会弄坏正在写的那个扇区，另一个还是上一份完整的快照。
+ * 启动时不需要 NVS：映射分区，挑 seq 大且 CRC 对的那份。
+ */
+#define SNAP_PARTITION "cfgsnap"
+#define SNAP_MAGIC 0x50414E53        // "SNAP"
+#define SNAP_SECTOR 4096
+#define SNAP_MAX_BLOB 256
+
+typedef struct{
+    uint32_t magic;
+    uint32_t seq;                    // 每写一次 +1
+    uint16_t len;                    // blob 长度
+    uint16_t reserved;
+    uint32_t crc;                    // 覆盖 seq/len 和 blob
+} snap_hdr_t;
+
+_Static_assert(SYS_CFG_BLOB_SIZE<=SNAP_MAX_BLOB,"config blob does not fit the snapshot");
+
+static const esp_partition_t *s_part=NULL;
+static const uint8_t *s_map=NULL;
+static esp_partition_mmap_handle_t s_map_handle;
+static SemaphoreHandle_t s_lock=NULL;
+static int s_current=-1;             // 最新快照所在扇区，-1 = 没有
+static uint32_t s_seq=0;
+
+static uint32_t snap_crc(const snap_hdr_t *h,const uint8_t *blob)
+{
+    uint32_t crc=esp_rom_crc32_le(0,(const uint8_t *)&h->seq,offsetof(snap_hdr_t,crc)-offsetof(snap_hdr_t,seq));
+    return esp_rom_crc32_le(crc,blob,h->len);
+}
+
+static const snap_hdr_t *snap_valid(int sector)
+{
+    const snap_hdr_t *h=(const snap_hdr_t *)(s_map+sector*SNAP_SECTOR);
+
+    if(h->magic!=SNAP_MAGIC||h->len>SNAP_MAX_BLOB) return NULL;
+    if(h->crc!=snap_crc(h,(const uint8_t *)(h+1))) return NULL;
+    return h;
+}
+
+esp_err_t sys_snapshot_mount(void)
+{
+    esp_err_t err;
+    const void *map;
+
+    if(s_part!=NULL) return ESP_OK;
+
+    const esp_partition_t *part=esp_partition_find_first(ESP_PARTITION_TYPE_DATA,ESP_PARTITION_SUBTYPE_ANY,SNAP_PARTITION);
+    if(part==NULL) return ESP_ERR_NOT_FOUND;
+    if(part->size<2*SNAP_SECTOR) return ESP_ERR_INVALID_SIZE;
+
+    err=esp_partition_mmap(part,0,2*SNAP_SECTOR,ESP_PARTITION_MMAP_DATA,&map,&s_map_handle);
+    if(err!=ESP_OK) return err;
+
+    s_lock=xSemaphoreCreateMutex();
+    if(s_lock==NULL){
+        esp_partition_munmap(s_map_handle);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_part=part;
+    s_map=map;
+
+    // 两份都有效时取新的 (seq 回绕按差值比较)
+    const snap_hdr_t *a=snap_valid(0);
+    const snap_hdr_t *b=snap_valid(1);
+    if(a!=NULL&&(b==NULL||(int32_t)(a->seq-b->seq)>0)){
+        s_current=0;
+        s_seq=a->seq;
+    }else if(b!=NULL){
+        s_current=1;
+        s_seq=b->seq;
+    }
+
+    return ESP_OK;
+}
+
+bool sys_snapshot_read(uint8_t *blob,size_t *len)
+{
+    if(s_part==NULL) return false;
+
+    xSemaphoreTake(s_lock,portMAX_DELAY);
+    const snap_hdr_t *h=s_current<0?NULL:snap_valid(s_current);
+    bool ok=h!=NULL&&h->len<=*len;
+    if(ok){
+        memcpy(blob,h+1,h->len);
+        *len=h->len;
+    }
+    xSemaphoreGive(s_lock);
+
+    return ok;
+}
+
+esp_err_t sys_snapshot_write(const uint8_t *blob,size_t len)
+{
+    esp_err_t err;
+    uint8_t buf[sizeof(snap_hdr_t)+SNAP_MAX_BLOB] __attribute__((aligned(4)));
+    snap_hdr_t *h=(snap_hdr_t *)buf;
+
+    if(s_part==NULL) return ESP_ERR_INVALID_STATE;
+    if(len>SNAP_MAX_BLOB) return ESP_ERR_INVALID_SIZE;
+
+    xSemaphoreTake(s_lock,portMAX_DELAY);
+
+    // 和最新快照一样就不写 (省一次擦除)
+    const snap_hdr_t *cur=s_current<0?NULL:snap_valid(s_current);
+    if(cur!=NULL&&cur->len==len&&memcmp(cur+1,blob,len)==0){
+        xSemaphoreGive(s_lock);
+        return ESP_OK;
+    }
+
+    // 写另一个扇区：当前这份在新的写完之前一直有效
+    int target=s_current==0?1:0;
+    h->magic=SNAP_MAGIC;
+    h->seq=s_seq+1;
+    h->len=(uint16_t)len;
+    h->reserved=0;
+    memcpy(h+1,blob,len);
+    h->crc=snap_crc(h,blob);
+
+    err=esp_partition_erase_range(s_part,target*SNAP_SECTOR,SNAP_SECTOR);
+    if(err==ESP_OK) err=esp_partition_write(s_part,target*SNAP_SECTOR,buf,sizeof(*h)+len);
+    if(err==ESP_OK){
+        s_current=target;
+        s_seq=h->seq;
+    }else{
+        ESP_LOGE(TAG,"Snapshot write failed: %s",esp_err_to_name(err));
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
\ No newline at end of file
@@ -1,45 +1,285 @@
 #include "sys_storage.h"
+#include "sys_config_codec.h"
+#include "sys_storage_priv.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
 #include <string.h>
 
-// static const char *TAG="SYS_STORE";
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+#include "freertos/semphr.h"
+#include "esp_system.h"
+#endif
+
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+#include "freertos/event_groups.h"
+#endif
+
+static const char *TAG="SYS_STORE";
 
-#define PARTITION_NAME "storage"     // 对应的 CSV 分区名字
-#define NAMESPACE_NAME "storage_ns"  // 分区中的一个 namespace 名字
 #define KEY_NAME "sys_cfg"           // namespace 中的一个 key 的名字
 
-// 结构体拆解成字符数组
-static void serialize_internal(const sys_config_t *src,uint8_t *buffer)
+sys_storage_stats_t g_sys_storage_stats;
+
+// ----------------------------------------------------------------------
+// 1. NVS 读写 (写回缓存和直写模式共用)
+// ----------------------------------------------------------------------
+static esp_err_t nvs_write_blob(const uint8_t *buffer,size_t len)
 {
-    buffer[0]=(uint8_t)(src->magic_id & 0xFF);
-    buffer[1]=(uint8_t)((src->magic_id>>8) & 0xFF);
-    buffer[2]=(uint8_t)((src->magic_id>>16) & 0xFF);
-    buffer[3]=(uint8_t)((src->magic_id>>24) & 0xFF);
+    nvs_handle_t my_handle;
+    esp_err_t err;
+
+    err=nvs_open_from_partition(PARTITION_NAME,NAMESPACE_NAME,NVS_READWRITE,&my_handle);
+    if(err!=ESP_OK) return err;
+
+    err=nvs_set_blob(my_handle,KEY_NAME,buffer,len);
 
-    buffer[4]=(uint8_t)(src->config_ver & 0xFF);
-    buffer[5]=(uint8_t)((src->config_ver>>8) & 0xFF);
+    if(err==ESP_OK) err=nvs_commit(my_handle);
+
+    nvs_close(my_handle);
+
+    if(err==ESP_OK) STAT_INC(commits);
+    else STAT_INC(commit_errors);
+
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+    // NVS 提交成功之后再更新快照：快照最多比 NVS 旧，不会比它新
+    if(err==ESP_OK) sys_snapshot_write(buffer,len);
+#endif
 
-    buffer[6]=src->flag;
+    return err;
 }
 
-// 字符数组合并成结构体
-static void deserialize_internal(const uint8_t *buffer,sys_config_t *dest)
+#define READ_SLACK 32                // 给更新版本固件在末尾加的字段留的空间
+
+// 读出来的可能是任意版本：统一转成当前版本的编码放进 buffer，*migrated 表示需要写回
+static esp_err_t nvs_read_blob(uint8_t *buffer,bool *migrated)
 {
-    dest->magic_id=(uint32_t)buffer[0]|
-                   (uint32_t)buffer[1]<<8|
-                   (uint32_t)buffer[2]<<16|
-                   (uint32_t)buffer[3]<<24;
+    nvs_handle_t my_handle;
+    esp_err_t err;
+    uint8_t raw[SYS_CFG_BLOB_SIZE+READ_SLACK] __attribute__((aligned(4)));
+    size_t len=sizeof(raw);
+    sys_config_t cfg;
+    uint8_t ver;
+
+    err=nvs_open_from_partition(PARTITION_NAME,NAMESPACE_NAME,NVS_READONLY,&my_handle);
+    if(err!=ESP_OK) return err;
+
+    err=nvs_get_blob(my_handle,KEY_NAME,raw,&len);
+
+    nvs_close(my_handle);
 
-    dest->config_ver=(uint16_t)buffer[4]|
-                     (uint16_t)buffer[5];
+    if(err!=ESP_OK) return err;
+
+    err=sys_cfg_decode(raw,len,&cfg,&ver);
+    if(err!=ESP_OK) return err;
 
-    dest->flag=buffer[6];
+    // 比我们新的版本 (固件降级) 按当前版本理解，但不写回，免得丢掉新固件的字段
+    *migrated=ver<SYS_CONFIG_SCHEMA_VERSION;
+    if(*migrated) ESP_LOGI(TAG,"Config blob v%d -> v%d",ver,SYS_CONFIG_SCHEMA_VERSION);
 
+    sys_cfg_encode(&cfg,buffer);
+    return ESP_OK;
 }
 
-esp_err_t sys_storage_init(void)
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+// ----------------------------------------------------------------------
+// 2. 写回缓存
+//    save 只改 RAM 并把条目标脏；刷盘任务等到 DEBOUNCE 内没有新的 save
+//    (最多等 MAX_DELAY) 再 commit。一串连续的 save 只落盘最后一个值。
+// ----------------------------------------------------------------------
+static struct{
+    uint8_t buffer[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));  // 编码后的值：比较时不会被结构体填充字节干扰
+    bool valid;                      // buffer 里是当前值 (读过或写过)
+    bool dirty;                      // buffer 比 NVS 新
+} s_cache;
+
+static SemaphoreHandle_t s_cache_lock=NULL;     // 保护 s_cache，只在拷贝时持有
+static SemaphoreHandle_t s_flush_lock=NULL;     // 整个刷盘过程互斥：flush 返回时数据一定已经落盘
+static TaskHandle_t s_flusher=NULL;
+
+static esp_err_t cache_flush(void)
+{
+    esp_err_t err=ESP_OK;
+    uint8_t buffer[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));
+    bool dirty;
+
+    xSemaphoreTake(s_flush_lock,portMAX_DELAY);
+
+    // [A] 拿走脏值，先清标志：写 flash 期间来的新 save 会重新标脏
+    xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+    dirty=s_cache.dirty;
+    if(dirty){
+        memcpy(buffer,s_cache.buffer,SYS_CFG_BLOB_SIZE);
+        s_cache.dirty=false;
+    }
+    xSemaphoreGive(s_cache_lock);
+
+    // [B] 不持有缓存锁写 flash，save/load 不会被几十毫秒的 commit 卡住
+    if(dirty){
+        sys_storage_wait_nvs();
+        err=nvs_write_blob(buffer,SYS_CFG_BLOB_SIZE);
+        if(err!=ESP_OK){
+            // 缓存里始终是最新值，重新标脏，下一次 save 或 flush 时再试
+            xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+            s_cache.dirty=true;
+            xSemaphoreGive(s_cache_lock);
+            ESP_LOGE(TAG,"Commit failed: %s",esp_err_to_name(err));
+        }
+    }
+
+    xSemaphoreGive(s_flush_lock);
+    return err;
+}
+
+static void flusher_task(void *arg)
+{
+    const TickType_t debounce=pdMS_TO_TICKS(CONFIG_SYS_STORAGE_FLUSH_DEBOUNCE_MS);
+    const TickType_t max_delay=pdMS_TO_TICKS(CONFIG_SYS_STORAGE_FLUSH_MAX_DELAY_MS);
+
+    while(1){
+        // [A] 等第一次变脏
+        ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+        TickType_t first=xTaskGetTickCount();
+
+        // [B] 防抖：DEBOUNCE 内又来了 save 就接着等，但从第一次变脏起最多等 MAX_DELAY
+        while(1){
+            TickType_t waited=xTaskGetTickCount()-first;
+            if(waited>=max_delay) break;
+
+            TickType_t wait=debounce;
+            if(wait>max_delay-waited) wait=max_delay-waited;
+            if(ulTaskNotifyTake(pdTRUE,wait)==0) break;
+        }
+
+        // [C] 落盘
+        cache_flush();
+    }
+}
+
+// esp_restart() 在停掉其他任务之前调用：最后一个值在重启前写进 flash
+static void shutdown_flush(void)
+{
+    cache_flush();
+}
+
+static esp_err_t cache_init(void)
+{
+    if(s_flusher!=NULL) return ESP_OK;
+
+    s_cache_lock=xSemaphoreCreateMutex();
+    s_flush_lock=xSemaphoreCreateMutex();
+    if(s_cache_lock==NULL||s_flush_lock==NULL) return ESP_ERR_NO_MEM;
+
+    if(xTaskCreate(flusher_task,"sys_store_flush",CONFIG_SYS_STORAGE_FLUSH_TASK_STACK_SIZE,
+                   NULL,CONFIG_SYS_STORAGE_FLUSH_TASK_PRIORITY,&s_flusher)!=pdPASS){
+        return ESP_ERR_NO_MEM;
+    }
+
+    return esp_register_shutdown_handler(shutdown_flush);
+}
+
+static esp_err_t cache_save(const uint8_t *buffer)
+{
+    if(s_cache_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+
+    // 和缓存一样 (无论是否已落盘)：什么都不用做
+    if(s_cache.valid&&memcmp(s_cache.buffer,buffer,SYS_CFG_BLOB_SIZE)==0){
+        xSemaphoreGive(s_cache_lock);
+        STAT_INC(suppressed);
+        return ESP_OK;
+    }
+
+    if(s_cache.dirty) STAT_INC(coalesced);
+
+    memcpy(s_cache.buffer,buffer,SYS_CFG_BLOB_SIZE);
+    s_cache.valid=true;
+    s_cache.dirty=true;
+
+    xSemaphoreGive(s_cache_lock);
+
+    // 每次 save 都通知：刷盘任务借此重新开始防抖计时
+    xTaskNotifyGive(s_flusher);
+    return ESP_OK;
+}
+
+static esp_err_t cache_load(uint8_t *buffer)
+{
+    esp_err_t err;
+
+    if(s_cache_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+    if(s_cache.valid){
+        memcpy(buffer,s_cache.buffer,SYS_CFG_BLOB_SIZE);
+        xSemaphoreGive(s_cache_lock);
+        STAT_INC(load_hits);
+        return ESP_OK;
+    }
+    xSemaphoreGive(s_cache_lock);
+
+    // 第一次读：走 NVS，然后留在 RAM 里
+    bool migrated;
+    sys_storage_wait_nvs();
+    err=nvs_read_blob(buffer,&migrated);
+    if(err!=ESP_OK) return err;
+
+    xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+    if(s_cache.valid){
+        // 读 NVS 期间有人 save 了：以更新的缓存为准
+        memcpy(buffer,s_cache.buffer,SYS_CFG_BLOB_SIZE);
+        migrated=false;
+    }else{
+        memcpy(s_cache.buffer,buffer,SYS_CFG_BLOB_SIZE);
+        s_cache.valid=true;
+        s_cache.dirty=migrated;      // 升级后的编码和普通 save 一样延迟落盘
+    }
+    xSemaphoreGive(s_cache_lock);
+
+    if(migrated){
+        STAT_INC(migrations);
+        xTaskNotifyGive(s_flusher);
+    }
+
+    return ESP_OK;
+}
+
+// 缓存里还是 old (启动后没人 save 过) 才换成 val
+static void cache_replace(const uint8_t *old,const uint8_t *val)
+{
+    xSemaphoreTake(s_cache_lock,portMAX_DELAY);
+    if(!s_cache.valid||(!s_cache.dirty&&memcmp(s_cache.buffer,old,SYS_CFG_BLOB_SIZE)==0)){
+        memcpy(s_cache.buffer,val,SYS_CFG_BLOB_SIZE);
+        s_cache.valid=true;
+    }
+    xSemaphoreGive(s_cache_lock);
+}
+#endif // CONFIG_SYS_STORAGE_WRITE_BACK
+
+// ----------------------------------------------------------------------
+// 3. 挂载 NVS / 快速启动
+//    有快照时 init 只读快照 (mmap，不碰 NVS) 就返回，NVS 的挂载和事务恢复放到后台任务；
+//    所有要碰 NVS 的路径先 sys_storage_wait_nvs()。
+// ----------------------------------------------------------------------
+static sys_storage_boot_info_t s_boot;
+
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+#define NVS_READY_BIT BIT0
+
+static EventGroupHandle_t s_nvs_events=NULL;
+static esp_err_t s_nvs_err=ESP_OK;
+static uint8_t s_snap_blob[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));  // 启动时的快照，已转成当前版本
+static bool s_snap_valid=false;
+#endif
+
+static esp_err_t storage_nvs_init(void)
 {
     esp_err_t err=nvs_flash_init_partition(PARTITION_NAME);
 
@@ -48,51 +288,221 @@ esp_err_t sys_storage_init(void)
         err=nvs_flash_init_partition(PARTITION_NAME);
     }
 
-    // ESP_LOGI(TAG,"Init function called (Skeleton)");
-    
+    // 上次掉电时没提交完的批量事务，在任何人读之前回滚掉
+    if(err==ESP_OK) err=sys_storage_txn_recover();
+
     return err;
 }
 
-esp_err_t sys_storage_save(const sys_config_t *cfg)
+void sys_storage_wait_nvs(void)
 {
-    nvs_handle_t my_handle;
-    esp_err_t err;
-    uint8_t buffer[7];
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+    if(s_nvs_events!=NULL) xEventGroupWaitBits(s_nvs_events,NVS_READY_BIT,pdFALSE,pdTRUE,portMAX_DELAY);
+#endif
+}
 
-    serialize_internal(cfg,buffer);
+size_t sys_storage_entries_consumed(void)
+{
+    nvs_stats_t st;
+    if(nvs_get_stats(PARTITION_NAME,&st)!=ESP_OK) return 0;
+    return st.total_entries-st.free_entries;
+}
 
-    err=nvs_open_from_partition(PARTITION_NAME,NAMESPACE_NAME,NVS_READWRITE,&my_handle);
-    if(err!=ESP_OK) return err;
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+#if !CONFIG_SYS_STORAGE_WRITE_BACK
+static bool nvs_ready(void)
+{
+    return s_nvs_events==NULL||(xEventGroupGetBits(s_nvs_events)&NVS_READY_BIT);
+}
+#endif
 
-    err=nvs_set_blob(my_handle,KEY_NAME,buffer,sizeof(buffer));
+// 快照在 NVS 提交之后才写，两者之间掉电时快照会旧一版：NVS 挂好之后核对一次，以 NVS 为准
+static void snapshot_reconcile(void)
+{
+    uint8_t nvs_blob[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));
+    bool migrated;
 
-    if(err==ESP_OK) err=nvs_commit(my_handle);
+    if(nvs_read_blob(nvs_blob,&migrated)!=ESP_OK) return;
+    if(memcmp(nvs_blob,s_snap_blob,SYS_CFG_BLOB_SIZE)==0) return;
 
-    nvs_close(my_handle);
+    s_boot.snapshot_stale=true;
+    ESP_LOGW(TAG,"Snapshot older than NVS, switching to the NVS copy");
+
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    cache_replace(s_snap_blob,nvs_blob);
+#endif
+    sys_snapshot_write(nvs_blob,SYS_CFG_BLOB_SIZE);
+}
 
-    // ESP_LOGI(TAG,"Save function called. Magic: 0x%08lX",cfg->magic_id);
+static void nvs_init_task(void *arg)
+{
+    s_nvs_err=storage_nvs_init();
+    if(s_nvs_err==ESP_OK) snapshot_reconcile();
+    else ESP_LOGE(TAG,"Deferred NVS init failed: %s",esp_err_to_name(s_nvs_err));
 
-    return err;
+    s_boot.nvs_ready_us=esp_timer_get_time();
+    xEventGroupSetBits(s_nvs_events,NVS_READY_BIT);
+    vTaskDelete(NULL);
 }
 
-esp_err_t sys_storage_load(sys_config_t *cfg)
+static bool snapshot_boot(void)
 {
-    // ESP_LOGI(TAG,"Load function called (Skeleton)");
-    // cfg->magic_id=0x12345678;
+    uint8_t raw[SYS_CFG_BLOB_SIZE+READ_SLACK] __attribute__((aligned(4)));
+    size_t len=sizeof(raw);
+    sys_config_t cfg;
 
-    nvs_handle_t my_handle;
-    esp_err_t err;
-    uint8_t buffer[7];
-    size_t len=sizeof(buffer);
+    // 没有 cfgsnap 分区 (老分区表) 或者第一次启动还没有快照：走原来的同步挂载
+    if(sys_snapshot_mount()!=ESP_OK) return false;
+    if(!sys_snapshot_read(raw,&len)||sys_cfg_decode(raw,len,&cfg,NULL)!=ESP_OK) return false;
 
-    err=nvs_open_from_partition(PARTITION_NAME,NAMESPACE_NAME,NVS_READONLY,&my_handle);
+    sys_cfg_encode(&cfg,s_snap_blob);
+
+    s_nvs_events=xEventGroupCreate();
+    if(s_nvs_events==NULL) return false;
+
+    s_snap_valid=true;
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    cache_replace(s_snap_blob,s_snap_blob);
+#endif
+
+    if(xTaskCreate(nvs_init_task,"sys_store_init",CONFIG_SYS_STORAGE_INIT_TASK_STACK_SIZE,
+                   NULL,CONFIG_SYS_STORAGE_INIT_TASK_PRIORITY,NULL)!=pdPASS){
+        vEventGroupDelete(s_nvs_events);
+        s_nvs_events=NULL;
+        s_snap_valid=false;
+        return false;
+    }
+
+    s_boot.from_snapshot=true;
+    return true;
+}
+#endif // CONFIG_SYS_STORAGE_FAST_BOOT
+
+// ----------------------------------------------------------------------
+// 4. 对外接口
+// ----------------------------------------------------------------------
+esp_err_t sys_storage_init(void)
+{
+    esp_err_t err=ESP_OK;
+
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    err=cache_init();
     if(err!=ESP_OK) return err;
+#endif
 
-    err=nvs_get_blob(my_handle,KEY_NAME,buffer,&len);
+    err=sys_storage_blob_init();
+    if(err!=ESP_OK) return err;
 
-    if(err==ESP_OK) deserialize_internal(buffer,cfg);
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+    // 只有第一次 init 走快照；之后再 init (重新挂载) 照常同步做
+    if(s_boot.config_ready_us==0&&snapshot_boot()){
+        s_boot.config_ready_us=esp_timer_get_time();
+        return ESP_OK;
+    }
+#endif
 
-    nvs_close(my_handle);
+    err=storage_nvs_init();
 
+    s_boot.nvs_ready_us=esp_timer_get_time();
+    s_boot.config_ready_us=s_boot.nvs_ready_us;
     return err;
+}
+
+esp_err_t sys_storage_wait_ready(uint32_t timeout_ms)
+{
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+    if(s_nvs_events==NULL) return ESP_OK;
+    if(!(xEventGroupWaitBits(s_nvs_events,NVS_READY_BIT,pdFALSE,pdTRUE,pdMS_TO_TICKS(timeout_ms))&NVS_READY_BIT)){
+        return ESP_ERR_TIMEOUT;
+    }
+    return s_nvs_err;
+#else
+    return ESP_OK;
+#endif
+}
+
+void sys_storage_get_boot_info(sys_storage_boot_info_t *info)
+{
+    *info=s_boot;
+}
+
+esp_err_t sys_storage_save(const sys_config_t *cfg)
+{
+    uint8_t buffer[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));
+
+    sys_cfg_encode(cfg,buffer);
+    STAT_INC(saves);
+
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    return cache_save(buffer);
+#else
+    sys_storage_wait_nvs();
+    return nvs_write_blob(buffer,SYS_CFG_BLOB_SIZE);
+#endif
+}
+
+esp_err_t sys_storage_load(sys_config_t *cfg)
+{
+    esp_err_t err;
+    uint8_t buffer[SYS_CFG_BLOB_SIZE] __attribute__((aligned(4)));
+
+    STAT_INC(loads);
+
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    err=cache_load(buffer);
+#else
+    bool migrated=false;
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+    if(s_snap_valid&&!nvs_ready()){
+        // NVS 还在后台挂载：先用启动时的快照
+        memcpy(buffer,s_snap_blob,SYS_CFG_BLOB_SIZE);
+        err=ESP_OK;
+    }else
+#endif
+    {
+        sys_storage_wait_nvs();
+        err=nvs_read_blob(buffer,&migrated);
+    }
+    if(err==ESP_OK&&migrated){
+        // 升级后的编码立刻写回，下次就不用再迁移
+        STAT_INC(migrations);
+        if(nvs_write_blob(buffer,SYS_CFG_BLOB_SIZE)!=ESP_OK) ESP_LOGW(TAG,"Migrated config not written back");
+    }
+#endif
+
+    // buffer 里已经是当前版本
+    if(err==ESP_OK) err=sys_cfg_decode(buffer,SYS_CFG_BLOB_SIZE,cfg,NULL);
+
+    return err;
+}
+
+esp_err_t sys_storage_flush(void)
+{
+#if CONFIG_SYS_STORAGE_WRITE_BACK
+    if(s_flush_lock==NULL) return ESP_ERR_INVALID_STATE;
+    return cache_flush();
+#else
+    return ESP_OK;
+#endif
+}
+
+void sys_storage_get_stats(sys_storage_stats_t *stats)
+{
+    stats->saves=__atomic_load_n(&g_sys_storage_stats.saves,__ATOMIC_RELAXED);
+    stats->suppressed=__atomic_load_n(&g_sys_storage_stats.suppressed,__ATOMIC_RELAXED);
+    stats->coalesced=__atomic_load_n(&g_sys_storage_stats.coalesced,__ATOMIC_RELAXED);
+    stats->commits=__atomic_load_n(&g_sys_storage_stats.commits,__ATOMIC_RELAXED);
+    stats->commit_errors=__atomic_load_n(&g_sys_storage_stats.commit_errors,__ATOMIC_RELAXED);
+    stats->loads=__atomic_load_n(&g_sys_storage_stats.loads,__ATOMIC_RELAXED);
+    stats->load_hits=__atomic_load_n(&g_sys_storage_stats.load_hits,__ATOMIC_RELAXED);
+    stats->migrations=__atomic_load_n(&g_sys_storage_stats.migrations,__ATOMIC_RELAXED);
+    stats->txn_commits=__atomic_load_n(&g_sys_storage_stats.txn_commits,__ATOMIC_RELAXED);
+    stats->txn_rollbacks=__atomic_load_n(&g_sys_storage_stats.txn_rollbacks,__ATOMIC_RELAXED);
+    stats->blob_raw_bytes=__atomic_load_n(&g_sys_storage_stats.blob_raw_bytes,__ATOMIC_RELAXED);
+    stats->blob_stored_bytes=__atomic_load_n(&g_sys_storage_stats.blob_stored_bytes,__ATOMIC_RELAXED);
+}
+
+void sys_storage_reset_stats(void)
+{
+    memset(&g_sys_storage_stats,0,sizeof(g_sys_storage_stats));
 }
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "sys_storage_priv.h"
+#include "sys_config_codec.h"
+
+#if CONFIG_IDF_TARGET_LINUX && CONFIG_ESP_PARTITION_ENABLE_STATS
+#include "esp_private/partition_linux.h"
+#define BENCH_FLASH_STATS 1
+#else
+#define BENCH_FLASH_STATS 0
+#endif
+
+static const char *TAG="STORE_BENCH";
+
+/*
+ * 每一格 (数据集 x 值大小 x key 个数) 跑 BENCH_OPS 次 "写一个 key、提交、读另一个 key"：
+ *   save   = open + nvs_set_blob          (sys_storage 直写时 nvs_write_blob 的前半段)
+ *   commit = nvs_commit + close
+ *   load   = open + nvs_get_blob + close
+ * 延迟进 latency_histogram 出 p50/p90/p99/max。磨损按整格平均到每次操作：
+ *   entries  = nvs_get_stats 的 total - free 差 (页被回收时会变小，按 0 算)
+ *   erases / write_bytes = linux 目标分区模拟的统计 (CONFIG_ESP_PARTITION_ENABLE_STATS)，其他目标打印 -1
+ * 开头把 storage 分区整个擦掉，同样的配置每次跑出来的 flash 操作序列一样。
+ */
+#define BENCH_NAMESPACE "storage_bench"
+#define FILL_NAMESPACE "storage_fill"
+#define BENCH_OPS CONFIG_SYS_STORAGE_BENCH_OPS
+#define FILL_PCT CONFIG_SYS_STORAGE_BENCH_FILL_PCT
+#define FILL_VALUE_SIZE 256
+#define NVS_ENTRY_SIZE 32
+#define BENCH_MAX_VALUE 4096
+
+static const uint32_t s_value_sizes[]={16,256,1024,4096};
+static const uint32_t s_key_counts[]={1,16,64};
+
+static uint8_t s_value[BENCH_MAX_VALUE];
+static uint8_t s_back[BENCH_MAX_VALUE];
+
+static latency_hist_t s_hist[3];             // save / commit / load
+static latency_hist_t s_snap;
+
+enum{ OP_SAVE, OP_COMMIT, OP_LOAD };
+
+// 分区统计是全局的：快速启动打开时，配置每次 commit 之后还会擦写 cfgsnap 的一个扇区，
+// 分不开就在 set 列里标出来，免得和纯 NVS 的行直接比
+#if CONFIG_SYS_STORAGE_FAST_BOOT
+#define BENCH_CONFIG_SET "config+cfgsnap"
+#else
+#define BENCH_CONFIG_SET "config"
+#endif
+
+// ----------------------------------------------------------------------
+// 1. 计数
+// ----------------------------------------------------------------------
+typedef struct{
+    size_t entries;                  // 累计写掉的 entry
+    size_t erases;                   // 擦掉的扇区 (= NVS 页)
+    size_t write_bytes;
+} wear_t;
+
+static size_t entries_free(void)
+{
+    nvs_stats_t st;
+    if(nvs_get_stats(PARTITION_NAME,&st)!=ESP_OK) return 0;
+    return st.free_entries;
+}
+
+static void wear_begin(wear_t *w)
+{
+    memset(w,0,sizeof(*w));
+#if BENCH_FLASH_STATS
+    esp_partition_clear_stats();
+#endif
+}
+
+static void wear_end(wear_t *w)
+{
+#if BENCH_FLASH_STATS
+    w->erases=esp_partition_get_erase_ops();
+    w->write_bytes=esp_partition_get_write_bytes();
+#endif
+}
+
+// 一个值在 NVS 里占几个 entry：1 个头 + 数据按 32 字节向上取整 (大 blob 还有分块索引，这里不算)
+static size_t value_entries(size_t len)
+{
+    return 1+(len+NVS_ENTRY_SIZE-1)/NVS_ENTRY_SIZE;
+}
+
+// ----------------------------------------------------------------------
+// 2. 准备：擦分区、清空 namespace、按比例灌满
+// ----------------------------------------------------------------------
+static esp_err_t partition_reset(void)
+{
+    esp_err_t err;
+
+    nvs_flash_deinit_partition(PARTITION_NAME);
+    err=nvs_flash_erase_partition(PARTITION_NAME);
+    if(err==ESP_OK) err=nvs_flash_init_partition(PARTITION_NAME);
+    if(err==ESP_OK) err=sys_storage_txn_recover();
+    return err;
+}
+
+static esp_err_t namespace_clear(const char *ns)
+{
+    nvs_handle_t h;
+    esp_err_t err=nvs_open_from_partition(PARTITION_NAME,ns,NVS_READWRITE,&h);
+    if(err!=ESP_OK) return err;
+
+    err=nvs_erase_all(h);
+    if(err==ESP_OK) err=nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+// 写填充值直到已用 entry 到 FILL_PCT%，或者 NVS 说没地方了 (它自己要留一页做回收)
+static esp_err_t partition_fill(void)
+{
+    nvs_stats_t st;
+    nvs_handle_t h;
+    char key[16];
+    esp_err_t err;
+
+    err=nvs_open_from_partition(PARTITION_NAME,FILL_NAMESPACE,NVS_READWRITE,&h);
+    if(err!=ESP_OK) return err;
+
+    memset(s_value,0x5A,FILL_VALUE_SIZE);
+    for(uint32_t i=0;err==ESP_OK;i++){
+        err=nvs_get_stats(PARTITION_NAME,&st);
+        if(err!=ESP_OK||(st.total_entries-st.free_entries)*100>=(size_t)st.total_entries*FILL_PCT) break;
+
+        snprintf(key,sizeof(key),"fill%lu",(unsigned long)i);
+        s_value[0]=(uint8_t)i;
+        err=nvs_set_blob(h,key,s_value,FILL_VALUE_SIZE);
+    }
+    if(err==ESP_ERR_NVS_NOT_ENOUGH_SPACE) err=ESP_OK;
+    if(err==ESP_OK) err=nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+// ----------------------------------------------------------------------
+// 3. 一格
+// ----------------------------------------------------------------------
+static inline void record(int op,int64_t t0,int64_t t1)
+{
+    latency_hist_record(&s_hist[op],(uint32_t)(t1-t0));
+}
+
+static esp_err_t run_nvs(uint32_t len,uint32_t keys,wear_t *w)
+{
+    esp_err_t err=ESP_OK;
+    nvs_handle_t h;
+    char key[16];
+
+    for(uint32_t i=0;i<BENCH_OPS&&err==ESP_OK;i++){
+        // 每次的值都不一样，NVS 不会因为内容相同跳过写
+        memset(s_value,(uint8_t)i,len);
+        s_value[0]=(uint8_t)(i>>8);
+        snprintf(key,sizeof(key),"k%lu",(unsigned long)(i%keys));
+
+        size_t e0=sys_storage_entries_consumed();
+        int64_t t0=esp_timer_get_time();
+        err=nvs_open_from_partition(PARTITION_NAME,BENCH_NAMESPACE,NVS_READWRITE,&h);
+        if(err!=ESP_OK) break;
+        err=nvs_set_blob(h,key,s_value,len);
+        int64_t t1=esp_timer_get_time();
+        if(err==ESP_OK) err=nvs_commit(h);
+        nvs_close(h);
+        int64_t t2=esp_timer_get_time();
+        size_t e1=sys_storage_entries_consumed();
+        if(err!=ESP_OK) break;
+
+        record(OP_SAVE,t0,t1);
+        record(OP_COMMIT,t1,t2);
+        if(e1>e0) w->entries+=e1-e0;
+
+        // 读一个已经写过的 key (keys==1 时就是刚写的那个)
+        size_t n=sizeof(s_back);
+        snprintf(key,sizeof(key),"k%lu",(unsigned long)(i*7%(i<keys?i+1:keys)));
+        t0=esp_timer_get_time();
+        err=nvs_open_from_partition(PARTITION_NAME,BENCH_NAMESPACE,NVS_READONLY,&h);
+        if(err!=ESP_OK) break;
+        err=nvs_get_blob(h,key,s_back,&n);
+        nvs_close(h);
+        record(OP_LOAD,t0,esp_timer_get_time());
+    }
+    return err;
+}
+
+// 配置本身走对外接口：写回模式下 save 只改 RAM，flush 才是 commit；直写模式下 flush 什么都不做
+static esp_err_t run_config(wear_t *w)
+{
+    esp_err_t err=ESP_OK;
+    sys_config_t cfg;
+
+    err=sys_storage_load(&cfg);
+    if(err==ESP_ERR_NVS_NOT_FOUND) memset(&cfg,0,sizeof(cfg));
+    else if(err!=ESP_OK) return err;
+
+    for(uint32_t i=0;i<BENCH_OPS;i++){
+        cfg.flag=(uint8_t)i;
+        cfg.config_ver=(uint16_t)(i>>8);
+
+        size_t e0=sys_storage_entries_consumed();
+        int64_t t0=esp_timer_get_time();
+        err=sys_storage_save(&cfg);
+        int64_t t1=esp_timer_get_time();
+        if(err==ESP_OK) err=sys_storage_flush();
+        int64_t t2=esp_timer_get_time();
+        size_t e1=sys_storage_entries_consumed();
+        if(err!=ESP_OK) return err;
+
+        record(OP_SAVE,t0,t1);
+        record(OP_COMMIT,t1,t2);
+        if(e1>e0) w->entries+=e1-e0;
+
+        t0=esp_timer_get_time();
+        err=sys_storage_load(&cfg);
+        record(OP_LOAD,t0,esp_timer_get_time());
+        if(err!=ESP_OK) return err;
+    }
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 4. 输出
+// ----------------------------------------------------------------------
+static void emit_row(const char *phase,const char *set,uint32_t len,uint32_t keys,const wear_t *w)
+{
+    latency_hist_summary_t s[3];
+
+    for(int op=0;op<3;op++){
+        latency_hist_snapshot(&s_hist[op],&s_snap,true);
+        latency_hist_summarize(&s_snap,&s[op]);
+    }
+
+    printf("%s,%s,%lu,%lu,%d",phase,set,(unsigned long)len,(unsigned long)keys,BENCH_OPS);
+    for(int op=0;op<3;op++){
+        printf(",%lu,%lu,%lu,%lu",(unsigned long)s[op].p50,(unsigned long)s[op].p90,
+               (unsigned long)s[op].p99,(unsigned long)s[op].max);
+    }
+    printf(",%.2f",(double)w->entries/BENCH_OPS);
+#if BENCH_FLASH_STATS
+    printf(",%.3f,%.1f\n",(double)w->erases/BENCH_OPS,(double)w->write_bytes/BENCH_OPS);
+#else
+    printf(",-1,-1\n");
+#endif
+    fflush(stdout);
+}
+
+static esp_err_t run_phase(const char *phase)
+{
+    esp_err_t err;
+    wear_t w;
+
+    // [A] 配置 (sys_storage_save / flush / load)
+    wear_begin(&w);
+    err=run_config(&w);
+    wear_end(&w);
+    if(err!=ESP_OK){
+        ESP_LOGE(TAG,"%s config: %s",phase,esp_err_to_name(err));
+        return err;
+    }
+    emit_row(phase,BENCH_CONFIG_SET,SYS_CFG_BLOB_SIZE,1,&w);
+
+    // [B] 值大小 x key 个数
+    for(size_t s=0;s<sizeof(s_value_sizes)/sizeof(s_value_sizes[0]);s++){
+        for(size_t k=0;k<sizeof(s_key_counts)/sizeof(s_key_counts[0]);k++){
+            uint32_t len=s_value_sizes[s];
+            uint32_t keys=s_key_counts[k];
+
+            // 工作集最多占剩余空间的一半，否则测到的只是 "写满了"
+            if(keys*value_entries(len)*2>entries_free()) continue;
+
+            err=namespace_clear(BENCH_NAMESPACE);
+            if(err!=ESP_OK) return err;
+
+            wear_begin(&w);
+            err=run_nvs(len,keys,&w);
+            wear_end(&w);
+            if(err!=ESP_OK){
+                ESP_LOGE(TAG,"%s nvs %lu x %lu: %s",phase,(unsigned long)len,(unsigned long)keys,esp_err_to_name(err));
+                return err;
+            }
+            emit_row(phase,"nvs",len,keys,&w);
+        }
+    }
+    return namespace_clear(BENCH_NAMESPACE);
+}
+
+esp_err_t sys_storage_bench_run(void)
+{
+    esp_err_t err;
+    sys_config_t cfg;
+    bool have_cfg;
+
+    sys_storage_wait_nvs();
+
+    // 跑完把配置写回去 (擦分区之前先落盘，拿一份当前值)
+    sys_storage_flush();
+    have_cfg=sys_storage_load(&cfg)==ESP_OK;
+
+    for(int op=0;op<3;op++) latency_hist_init(&s_hist[op]);
+
+    err=partition_reset();
+    if(err==ESP_OK){
+        printf("STORE_BENCH_BEGIN\n");
+        printf("phase,set,value_bytes,keys,ops,"
+               "save_p50_us,save_p90_us,save_p99_us,save_max_us,"
+               "commit_p50_us,commit_p90_us,commit_p99_us,commit_max_us,"
+               "load_p50_us,load_p90_us,load_p99_us,load_max_us,"
+               "entries_per_op,erases_per_op,write_bytes_per_op\n");
+
+        // [空分区] 然后 [灌到 FILL_PCT% 之后]：回收 (搬页 + 擦除) 的代价出现在 p99 / max 和 erases 里
+        err=run_phase("empty");
+        if(err==ESP_OK) err=partition_fill();
+        if(err==ESP_OK) err=run_phase("near_full");
+
+        printf("STORE_BENCH_END\n");
+    }else{
+        // 分区已经 deinit，可能擦了一半：重新挂上 NVS，下面照样把配置写回去
+        ESP_LOGE(TAG,"Partition reset failed: %s",esp_err_to_name(err));
+        if(nvs_flash_init_partition(PARTITION_NAME)==ESP_OK) sys_storage_txn_recover();
+    }
+
+    namespace_clear(FILL_NAMESPACE);
+    if(have_cfg){
+        sys_storage_save(&cfg);
+        sys_storage_flush();
+    }
+    return err;
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "sys_storage_priv.h"
+#include "sys_lz.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG="SYS_BLOB";
+
+/*
+ * 大块数据 (校准表、查找曲线，几 KB) 在单独的 namespace 里，一个 key 一个 NVS blob：
+ *   [头 12 字节：codec / 原始长度 / 原始数据的 CRC32][payload]
+ * 压得下来 (至少省 1/8) 就存 LZ，压不下来或者太短就原样存；读的时候按头里的 codec 解。
+ * 关掉压缩之后写的都是原样，但老的 LZ blob 照样能读。
+ */
+#define BLOB_NAMESPACE "storage_blob"
+#define BLOB_MAX_SIZE CONFIG_SYS_STORAGE_BLOB_MAX_SIZE
+
+typedef struct{
+    uint8_t codec;                   // SYS_STORAGE_CODEC_*
+    uint8_t reserved[3];
+    uint32_t raw_len;                // 解出来的长度
+    uint32_t crc;                    // 原始数据的 CRC32，解完再核对一次
+} blob_hdr_t;
+
+_Static_assert(sizeof(blob_hdr_t)==12,"payload must start 4-byte aligned");
+_Static_assert(BLOB_MAX_SIZE<=SYS_LZ_MAX_INPUT,"blob too large for the LZ codec");
+
+// 压缩输出上限是原长的 7/8，放不下就存原样，所以工作区只要 头 + BLOB_MAX_SIZE
+static SemaphoreHandle_t s_blob_lock=NULL;   // 保护下面的工作区
+static uint8_t s_work[sizeof(blob_hdr_t)+BLOB_MAX_SIZE] __attribute__((aligned(4)));
+#if CONFIG_SYS_STORAGE_BLOB_COMPRESS
+static uint16_t s_table[SYS_LZ_TABLE_SIZE/sizeof(uint16_t)];
+#endif
+
+static bool key_valid(const char *key)
+{
+    size_t n=strlen(key);
+    return n>0&&n<=SYS_STORAGE_BLOB_KEY_MAX;
+}
+
+esp_err_t sys_storage_blob_init(void)
+{
+    if(s_blob_lock==NULL) s_blob_lock=xSemaphoreCreateMutex();
+    return s_blob_lock==NULL?ESP_ERR_NO_MEM:ESP_OK;
+}
+
+// 在 s_work 里拼好 [头][payload]，返回总长度
+static size_t blob_encode(const uint8_t *data,size_t len)
+{
+    blob_hdr_t *hdr=(blob_hdr_t *)s_work;
+    uint8_t *payload=s_work+sizeof(*hdr);
+    size_t plen=0;
+
+    memset(hdr,0,sizeof(*hdr));
+    hdr->raw_len=len;
+    hdr->crc=esp_rom_crc32_le(0,data,len);
+
+#if CONFIG_SYS_STORAGE_BLOB_COMPRESS
+    if(len>=CONFIG_SYS_STORAGE_BLOB_MIN_COMPRESS){
+        plen=sys_lz_compress(data,len,payload,len-len/8,s_table);
+    }
+#endif
+
+    if(plen>0){
+        hdr->codec=SYS_STORAGE_CODEC_LZ;
+    }else{
+        hdr->codec=SYS_STORAGE_CODEC_RAW;
+        memcpy(payload,data,len);
+        plen=len;
+    }
+    return sizeof(*hdr)+plen;
+}
+
+// s_work 里的 n 字节是不是一个完整的 blob
+static bool blob_check(size_t n)
+{
+    const blob_hdr_t *hdr=(const blob_hdr_t *)s_work;
+
+    if(n<sizeof(*hdr)||hdr->raw_len>BLOB_MAX_SIZE) return false;
+    if(hdr->codec==SYS_STORAGE_CODEC_RAW) return n-sizeof(*hdr)==hdr->raw_len;
+    return hdr->codec==SYS_STORAGE_CODEC_LZ;
+}
+
+// 读进 s_work (调用者持有 s_blob_lock)
+static esp_err_t blob_read(const char *key,size_t *n)
+{
+    nvs_handle_t h;
+    esp_err_t err=nvs_open_from_partition(PARTITION_NAME,BLOB_NAMESPACE,NVS_READONLY,&h);
+    if(err!=ESP_OK) return err;
+
+    *n=sizeof(s_work);
+    err=nvs_get_blob(h,key,s_work,n);
+    nvs_close(h);
+
+    if(err==ESP_OK&&!blob_check(*n)){
+        ESP_LOGE(TAG,"Blob '%s' has a bad header",key);
+        err=ESP_ERR_INVALID_SIZE;
+    }
+    return err;
+}
+
+esp_err_t sys_storage_put_blob(const char *key,const void *data,size_t len)
+{
+    nvs_handle_t h;
+    esp_err_t err;
+
+    if(!key_valid(key)||(data==NULL&&len>0)) return ESP_ERR_INVALID_ARG;
+    if(len>BLOB_MAX_SIZE) return ESP_ERR_INVALID_SIZE;
+    sys_storage_wait_nvs();
+    if(s_blob_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_blob_lock,portMAX_DELAY);
+
+    size_t n=blob_encode(data,len);
+
+    err=nvs_open_from_partition(PARTITION_NAME,BLOB_NAMESPACE,NVS_READWRITE,&h);
+    if(err==ESP_OK){
+        err=nvs_set_blob(h,key,s_work,n);
+        if(err==ESP_OK) err=nvs_commit(h);
+        nvs_close(h);
+    }
+
+    xSemaphoreGive(s_blob_lock);
+
+    if(err==ESP_OK){
+        STAT_ADD(blob_raw_bytes,len);
+        STAT_ADD(blob_stored_bytes,n);
+    }else{
+        ESP_LOGE(TAG,"Put '%s' failed: %s",key,esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t sys_storage_get_blob(const char *key,void *data,size_t *len)
+{
+    esp_err_t err;
+    size_t n;
+
+    if(!key_valid(key)||len==NULL) return ESP_ERR_INVALID_ARG;
+    sys_storage_wait_nvs();
+    if(s_blob_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_blob_lock,portMAX_DELAY);
+
+    err=blob_read(key,&n);
+    const blob_hdr_t *hdr=(const blob_hdr_t *)s_work;
+    const uint8_t *payload=s_work+sizeof(*hdr);
+
+    if(err==ESP_OK&&data!=NULL){
+        if(*len<hdr->raw_len){
+            err=ESP_ERR_NVS_INVALID_LENGTH;
+        }else if(hdr->codec==SYS_STORAGE_CODEC_LZ){
+            // 直接解进调用者的缓冲区，不需要第二块内存
+            err=sys_lz_decompress(payload,n-sizeof(*hdr),data,hdr->raw_len);
+        }else{
+            memcpy(data,payload,hdr->raw_len);
+        }
+        if(err==ESP_OK&&esp_rom_crc32_le(0,data,hdr->raw_len)!=hdr->crc) err=ESP_ERR_INVALID_CRC;
+    }
+    if(err==ESP_OK) *len=hdr->raw_len;
+
+    xSemaphoreGive(s_blob_lock);
+    return err;
+}
+
+esp_err_t sys_storage_blob_info(const char *key,sys_storage_blob_info_t *info)
+{
+    esp_err_t err;
+    size_t n;
+
+    if(!key_valid(key)) return ESP_ERR_INVALID_ARG;
+    sys_storage_wait_nvs();
+    if(s_blob_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_blob_lock,portMAX_DELAY);
+    err=blob_read(key,&n);
+    if(err==ESP_OK){
+        const blob_hdr_t *hdr=(const blob_hdr_t *)s_work;
+        info->codec=hdr->codec;
+        info->raw_len=hdr->raw_len;
+        info->stored_len=n;
+    }
+    xSemaphoreGive(s_blob_lock);
+
+    return err;
+}
+
+esp_err_t sys_storage_erase_blob(const char *key)
+{
+    nvs_handle_t h;
+    esp_err_t err;
+
+    if(!key_valid(key)) return ESP_ERR_INVALID_ARG;
+    sys_storage_wait_nvs();
+
+    err=nvs_open_from_partition(PARTITION_NAME,BLOB_NAMESPACE,NVS_READWRITE,&h);
+    if(err!=ESP_OK) return err;
+    err=nvs_erase_key(h,key);
+    if(err==ESP_OK) err=nvs_commit(h);
+    nvs_close(h);
+
+    return err;
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "sys_storage_priv.h"
+#include "sys_lz.h"
+
+static const char *TAG="BLOB_BENCH";
+
+#define BENCH_NAMESPACE "storage_bench"
+#define BENCH_SIZE (CONFIG_SYS_STORAGE_BLOB_MAX_SIZE<4096?CONFIG_SYS_STORAGE_BLOB_MAX_SIZE:4096)
+#define BENCH_ROUNDS 20
+#define NVS_ENTRY_SIZE 32
+#define GUARD_SIZE 16
+
+static uint8_t s_data[BENCH_SIZE] __attribute__((aligned(4)));
+static uint8_t s_packed[SYS_LZ_BOUND(BENCH_SIZE)];
+static uint8_t s_back[BENCH_SIZE+GUARD_SIZE];
+static uint16_t s_table[SYS_LZ_TABLE_SIZE/sizeof(uint16_t)];
+
+// ----------------------------------------------------------------------
+// 1. 典型数据
+// ----------------------------------------------------------------------
+static uint32_t s_rng=0x2545F491;
+
+// 16 个通道 x 每个 64 个点的 int16 校准表：大部分通道还是出厂默认曲线，少数几个有各自的偏移
+static void gen_calib(uint8_t *buf,size_t len)
+{
+    int16_t *v=(int16_t *)buf;
+    for(size_t i=0;i<len/sizeof(int16_t);i++){
+        uint32_t ch=(i/64)%16;
+        int32_t x=i%64;
+        int32_t y=x*x/4+x*16;
+        if(ch%5==3) y+=(int32_t)(sys_test_rng_next(&s_rng)%7)-3;
+        v[i]=(int16_t)y;
+    }
+}
+
+// float 查找曲线 (sin)，每个值都不一样：压缩最差的一类"正常"数据
+static void gen_curve(uint8_t *buf,size_t len)
+{
+    float *v=(float *)buf;
+    size_t n=len/sizeof(float);
+    for(size_t i=0;i<n;i++) v[i]=sinf(6.2831853f*i/n);
+}
+
+// 稀疏表：大部分是 0，每 64 字节里有几个非零
+static void gen_sparse(uint8_t *buf,size_t len)
+{
+    memset(buf,0,len);
+    for(size_t i=0;i<len;i+=64) buf[i]=(uint8_t)sys_test_rng_next(&s_rng);
+}
+
+// JSON 风格的文本配置
+static void gen_text(uint8_t *buf,size_t len)
+{
+    size_t n=0;
+    char line[64];
+    for(int i=0;n<len;i++){
+        int k=snprintf(line,sizeof(line),"{\"ch\":%d,\"gain\":1.%03d,\"offset\":%d},\n",i,i*37%1000,i%8-4);
+        size_t c=(size_t)k<len-n?(size_t)k:len-n;
+        memcpy(buf+n,line,c);
+        n+=c;
+    }
+}
+
+// 随机字节：不可压缩，put 之后应该原样存
+static void gen_random(uint8_t *buf,size_t len)
+{
+    for(size_t i=0;i<len;i++) buf[i]=(uint8_t)(sys_test_rng_next(&s_rng)>>24);
+}
+
+typedef struct{
+    const char *name;
+    void (*gen)(uint8_t *buf,size_t len);
+} bench_data_t;
+
+static const bench_data_t s_sets[]={
+    {"calib_i16",gen_calib},
+    {"curve_f32",gen_curve},
+    {"sparse",gen_sparse},
+    {"text",gen_text},
+    {"random",gen_random},
+};
+
+// ----------------------------------------------------------------------
+// 2. 自检：往返，以及坏数据只报错、不越界
+// ----------------------------------------------------------------------
+
+// 解进 s_back，后面的保护字节不能被碰
+static esp_err_t decode_guarded(const uint8_t *src,size_t len,size_t out_len)
+{
+    memset(s_back+out_len,0xA5,GUARD_SIZE);
+    esp_err_t err=sys_lz_decompress(src,len,s_back,out_len);
+    for(size_t i=0;i<GUARD_SIZE;i++){
+        if(s_back[out_len+i]!=0xA5) return ESP_ERR_INVALID_STATE;
+    }
+    return err;
+}
+
+esp_err_t sys_storage_blob_selftest(void)
+{
+    static const size_t sizes[]={0,1,3,4,5,15,16,19,64,255,270,1000,BENCH_SIZE};
+
+    // [A] 每种数据、各种长度往返 (包括 0 和比最小匹配还短的)
+    for(size_t s=0;s<sizeof(s_sets)/sizeof(s_sets[0]);s++){
+        s_sets[s].gen(s_data,BENCH_SIZE);
+        for(size_t i=0;i<sizeof(sizes)/sizeof(sizes[0]);i++){
+            size_t n=sizes[i];
+            size_t packed=sys_lz_compress(s_data,n,s_packed,sizeof(s_packed),s_table);
+            SYS_TEST_CHECK(packed>0&&packed<=SYS_LZ_BOUND(n),"compress within bound");
+            SYS_TEST_CHECK(decode_guarded(s_packed,packed,n)==ESP_OK,"round trip decode");
+            SYS_TEST_CHECK(memcmp(s_back,s_data,n)==0,"round trip value");
+        }
+    }
+
+    // [B] 长重复 (扩展长度字节、offset 比长度小的自重叠匹配)
+    memset(s_data,'x',BENCH_SIZE);
+    size_t packed=sys_lz_compress(s_data,BENCH_SIZE,s_packed,sizeof(s_packed),s_table);
+    SYS_TEST_CHECK(packed>0&&packed<64,"long run compresses");
+    SYS_TEST_CHECK(decode_guarded(s_packed,packed,BENCH_SIZE)==ESP_OK&&memcmp(s_back,s_data,BENCH_SIZE)==0,"long run value");
+
+    // [C] 输出放不下时返回 0，调用者改存原样
+    gen_random(s_data,BENCH_SIZE);
+    SYS_TEST_CHECK(sys_lz_compress(s_data,BENCH_SIZE,s_packed,BENCH_SIZE-BENCH_SIZE/8,s_table)==0,"incompressible rejected");
+
+    // [D] 坏数据：每种截断、随机改字节、长度对不上，都不能写出 out_len 之外
+    gen_text(s_data,BENCH_SIZE);
+    packed=sys_lz_compress(s_data,BENCH_SIZE,s_packed,sizeof(s_packed),s_table);
+    for(size_t cut=0;cut<packed;cut++){
+        SYS_TEST_CHECK(decode_guarded(s_packed,cut,BENCH_SIZE)==ESP_ERR_INVALID_SIZE,"truncated stream");
+    }
+    SYS_TEST_CHECK(decode_guarded(s_packed,packed,BENCH_SIZE-1)==ESP_ERR_INVALID_SIZE,"output length too short");
+    for(int i=0;i<2000;i++){
+        size_t pos=sys_test_rng_next(&s_rng)%packed;
+        uint8_t old=s_packed[pos];
+        s_packed[pos]^=(uint8_t)(1u<<(sys_test_rng_next(&s_rng)%8));
+        esp_err_t err=decode_guarded(s_packed,packed,BENCH_SIZE);
+        SYS_TEST_CHECK(err==ESP_OK||err==ESP_ERR_INVALID_SIZE,"corrupted stream stays in bounds");
+        s_packed[pos]=old;
+    }
+
+    ESP_LOGI(TAG,"LZ codec selftest passed");
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 3. 基准
+// ----------------------------------------------------------------------
+// 原样写：和不经过 sys_storage_put_blob 直接 nvs_set_blob 一样
+static esp_err_t put_raw(const char *key,const uint8_t *data,size_t len)
+{
+    nvs_handle_t h;
+    esp_err_t err=nvs_open_from_partition(PARTITION_NAME,BENCH_NAMESPACE,NVS_READWRITE,&h);
+    if(err!=ESP_OK) return err;
+
+    nvs_erase_key(h,key);                                        // 上次跑剩下的一样的值会被 NVS 跳过
+    err=nvs_set_blob(h,key,data,len);
+    if(err==ESP_OK) err=nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+esp_err_t sys_storage_blob_bench_run(void)
+{
+    esp_err_t err;
+    char key[16];
+
+    printf("BLOB_BENCH_BEGIN\n");
+    printf("data,raw_bytes,stored_bytes,ratio,enc_mb_s,dec_mb_s,"
+           "raw_flash_bytes,raw_write_us,blob_flash_bytes,blob_write_us,read_us\n");
+
+    for(size_t s=0;s<sizeof(s_sets)/sizeof(s_sets[0]);s++){
+        s_sets[s].gen(s_data,BENCH_SIZE);
+
+        // [A] 编解码速度 (只动内存)
+        size_t packed=0;
+        int64_t t0=esp_timer_get_time();
+        for(int r=0;r<BENCH_ROUNDS;r++) packed=sys_lz_compress(s_data,BENCH_SIZE,s_packed,sizeof(s_packed),s_table);
+        int64_t enc_us=esp_timer_get_time()-t0;
+
+        t0=esp_timer_get_time();
+        for(int r=0;r<BENCH_ROUNDS;r++) err=sys_lz_decompress(s_packed,packed,s_back,BENCH_SIZE);
+        int64_t dec_us=esp_timer_get_time()-t0;
+        if(err!=ESP_OK||memcmp(s_back,s_data,BENCH_SIZE)!=0){
+            ESP_LOGE(TAG,"%s: round trip mismatch",s_sets[s].name);
+            return ESP_FAIL;
+        }
+
+        // [B] 写进 NVS：原样 vs sys_storage_put_blob，entry 数 x 32 字节 = 写掉的 flash
+        snprintf(key,sizeof(key),"raw_%u",(unsigned)s);
+        size_t e0=sys_storage_entries_consumed();
+        t0=esp_timer_get_time();
+        err=put_raw(key,s_data,BENCH_SIZE);
+        int64_t raw_us=esp_timer_get_time()-t0;
+        size_t e1=sys_storage_entries_consumed();
+        size_t raw_entries=e1>e0?e1-e0:0;
+        if(err!=ESP_OK){
+            ESP_LOGE(TAG,"%s: raw write failed: %s",s_sets[s].name,esp_err_to_name(err));
+            return err;
+        }
+
+        snprintf(key,sizeof(key),"bench_%u",(unsigned)s);
+        sys_storage_erase_blob(key);
+        e0=sys_storage_entries_consumed();
+        t0=esp_timer_get_time();
+        err=sys_storage_put_blob(key,s_data,BENCH_SIZE);
+        int64_t blob_us=esp_timer_get_time()-t0;
+        e1=sys_storage_entries_consumed();
+        size_t blob_entries=e1>e0?e1-e0:0;
+        if(err!=ESP_OK) return err;                              // put_blob 自己打了日志
+
+        // [C] 读回来 (含解压和 CRC)
+        size_t n=BENCH_SIZE;
+        t0=esp_timer_get_time();
+        err=sys_storage_get_blob(key,s_back,&n);
+        int64_t read_us=esp_timer_get_time()-t0;
+        if(err!=ESP_OK||n!=BENCH_SIZE||memcmp(s_back,s_data,BENCH_SIZE)!=0){
+            ESP_LOGE(TAG,"%s: stored blob mismatch",s_sets[s].name);
+            return ESP_FAIL;
+        }
+
+        sys_storage_blob_info_t info;
+        err=sys_storage_blob_info(key,&info);
+        if(err!=ESP_OK) return err;
+
+        printf("%s,%d,%lu,%.2f,%.2f,%.2f,%u,%lld,%u,%lld,%lld\n",s_sets[s].name,BENCH_SIZE,
+               (unsigned long)info.stored_len,(double)BENCH_SIZE/info.stored_len,
+               enc_us>0?(double)BENCH_SIZE*BENCH_ROUNDS/enc_us:0.0,
+               dec_us>0?(double)BENCH_SIZE*BENCH_ROUNDS/dec_us:0.0,
+               (unsigned)(raw_entries*NVS_ENTRY_SIZE),(long long)raw_us,
+               (unsigned)(blob_entries*NVS_ENTRY_SIZE),(long long)blob_us,(long long)read_us);
+        fflush(stdout);
+    }
+
+    printf("BLOB_BENCH_END\n");
+    return ESP_OK;
+}
\ No newline at end of file
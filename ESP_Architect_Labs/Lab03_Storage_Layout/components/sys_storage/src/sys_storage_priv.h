@@ -0,0 +1,44 @@
+#pragma once
+#include "sys_storage.h"
+
+// sys_storage 各个源文件之间共用的东西
+
+#define PARTITION_NAME "storage"     // 对应的 CSV 分区名字
+#define NAMESPACE_NAME "storage_ns"  // 分区中的一个 namespace 名字
+
+extern sys_storage_stats_t g_sys_storage_stats;
+
+// 计数可能同时被调用者和刷盘任务改，用原子加
+#define STAT_INC(field) __atomic_fetch_add(&g_sys_storage_stats.field,1,__ATOMIC_RELAXED)
+#define STAT_ADD(field,n) __atomic_fetch_add(&g_sys_storage_stats.field,(n),__ATOMIC_RELAXED)
+
+// 挂载时调用：把掉电时没提交完的事务留下的槽位擦掉 (sys_storage_txn.c)
+esp_err_t sys_storage_txn_recover(void);
+
+// init 时调用：创建大块数据的锁 (sys_storage_blob.c)
+esp_err_t sys_storage_blob_init(void);
+
+// 快速启动时 NVS 在后台挂载：要碰 NVS 的路径先等它挂好 (没开快速启动时直接返回)
+void sys_storage_wait_nvs(void);
+
+// 配置快照：固定布局 + CRC，mmap 直接读，不经过 NVS (sys_snapshot.c)
+esp_err_t sys_snapshot_mount(void);
+bool sys_snapshot_read(uint8_t *blob,size_t *len);
+esp_err_t sys_snapshot_write(const uint8_t *blob,size_t len);
+
+// ----------------------------------------------------------------------
+// 自检 / 基准共用
+// ----------------------------------------------------------------------
+// 线性同余，每个调用方自己带种子，结果可复现
+static inline uint32_t sys_test_rng_next(uint32_t *state)
+{
+    *state=*state*1664525u+1013904223u;
+    return *state;
+}
+
+// 自检失败时打一行日志就返回，用的是调用文件自己的 TAG
+#define SYS_TEST_CHECK(cond,what) do{ if(!(cond)){ ESP_LOGE(TAG,"selftest: %s",what); return ESP_FAIL; } }while(0)
+
+// storage 分区写掉了多少 entry：used + 已作废的 = total - free
+// (页被回收搬家时会变小，只看同一轮里的差；取不到统计时返回 0) (sys_storage.c)
+size_t sys_storage_entries_consumed(void);
@@ -0,0 +1,363 @@
+#include "sys_storage_priv.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const char *TAG="SYS_TXN";
+
+/*
+ * 全有或全无是这样做到的：
+ *   + 每个 key 在 NVS 里有两个槽 "<key>~0" / "<key>~1"，槽的内容 = [代号 u32][值]。
+ *   + "~gen" 记录最后一次提交成功的代号 G。读的时候只认代号 <= G 的槽，两个都认时取代号大的。
+ *   + 提交 G+1：每个 key 写进 "不是当前值" 的那个槽 (当前值一个字节都不动)，最后写 "~gen"=G+1。
+ *     单个 NVS entry 的写本身是原子的，所以 "~gen" 就是整个事务的提交点：
+ *     在它之前掉电，新写的槽代号都是 G+1 > G，读的人看不见；在它之后掉电，事务已经完整。
+ *   + 挂载时把代号 > G 的槽擦掉，免得下一个事务提交 G+1 时把它们也 "顺带" 提交了。
+ */
+#define TXN_NAMESPACE "storage_txn"
+#define GEN_KEY "~gen"
+
+#define TXN_MAX_KEYS CONFIG_SYS_STORAGE_TXN_MAX_KEYS
+#define TXN_BUF_SIZE CONFIG_SYS_STORAGE_TXN_BUF_SIZE
+
+typedef struct{
+    char key[SYS_STORAGE_KEY_MAX+1];
+    uint16_t off;                    // 在 s_stage 里的位置
+    uint16_t len;
+    int8_t slot;                     // 提交时写进了哪个槽 (失败回滚用)
+    bool live;                       // 同一个 key 被 put 两次时，前一次作废
+} txn_entry_t;
+
+static SemaphoreHandle_t s_txn_lock=NULL;    // begin 到 commit/abort 持有
+static SemaphoreHandle_t s_io_lock=NULL;     // 保护 s_scratch 和 s_gen
+static TaskHandle_t s_owner=NULL;
+
+static txn_entry_t s_entries[TXN_MAX_KEYS];
+static uint32_t s_entry_count=0;
+static uint8_t s_stage[TXN_BUF_SIZE];
+static uint32_t s_stage_used=0;
+
+static uint32_t s_gen=0;                     // 已提交的代号
+static bool s_needs_recovery=false;          // 提交失败后回滚也失败：s_gen 和未提交的槽都不可信
+static uint8_t s_scratch[sizeof(uint32_t)+TXN_BUF_SIZE] __attribute__((aligned(4)));
+
+// ----------------------------------------------------------------------
+// 1. 槽
+// ----------------------------------------------------------------------
+static void slot_key(const char *key,int slot,char *out)
+{
+    size_t n=strlen(key);
+    memcpy(out,key,n);
+    out[n]='~';
+    out[n+1]=(char)('0'+slot);
+    out[n+2]='\0';
+}
+
+// 槽读进 s_scratch；不存在 / 太短都当作空槽
+static bool slot_read(nvs_handle_t h,const char *key,int slot,uint32_t *gen,size_t *len)
+{
+    char name[SYS_STORAGE_KEY_MAX+3];
+    size_t n=sizeof(s_scratch);
+
+    slot_key(key,slot,name);
+    if(nvs_get_blob(h,name,s_scratch,&n)!=ESP_OK||n<sizeof(uint32_t)) return false;
+
+    memcpy(gen,s_scratch,sizeof(*gen));
+    *len=n-sizeof(uint32_t);
+    return true;
+}
+
+// 当前值所在的槽 (代号 <= s_gen 里最大的)，没有返回 -1
+static int slot_current(nvs_handle_t h,const char *key)
+{
+    uint32_t gen[2];
+    size_t len;
+    bool ok[2];
+
+    for(int s=0;s<2;s++){
+        ok[s]=slot_read(h,key,s,&gen[s],&len)&&gen[s]<=s_gen;
+    }
+
+    if(ok[0]&&ok[1]) return gen[1]>gen[0]?1:0;
+    if(ok[0]) return 0;
+    if(ok[1]) return 1;
+    return -1;
+}
+
+// ----------------------------------------------------------------------
+// 2. 恢复：擦掉代号 > G 的槽
+// ----------------------------------------------------------------------
+#define RECOVER_BATCH 8
+
+static esp_err_t txn_rollback(nvs_handle_t h)
+{
+    esp_err_t err;
+    char stale[RECOVER_BATCH][NVS_KEY_NAME_MAX_SIZE];
+    int n;
+
+    // 遍历期间不改 namespace：先收集一批，再擦，直到一个都收集不到
+    do{
+        nvs_iterator_t it=NULL;
+        n=0;
+
+        err=nvs_entry_find(PARTITION_NAME,TXN_NAMESPACE,NVS_TYPE_BLOB,&it);
+        while(err==ESP_OK&&n<RECOVER_BATCH){
+            nvs_entry_info_t info;
+            uint32_t gen;
+            size_t len=sizeof(s_scratch);
+
+            nvs_entry_info(it,&info);
+            if(nvs_get_blob(h,info.key,s_scratch,&len)==ESP_OK&&len>=sizeof(gen)){
+                memcpy(&gen,s_scratch,sizeof(gen));
+                if(gen>s_gen) strcpy(stale[n++],info.key);
+            }
+            err=nvs_entry_next(&it);
+        }
+        nvs_release_iterator(it);
+        if(err!=ESP_OK&&err!=ESP_ERR_NVS_NOT_FOUND) return err;
+
+        for(int i=0;i<n;i++){
+            err=nvs_erase_key(h,stale[i]);
+            if(err!=ESP_OK) return err;
+            STAT_INC(txn_rollbacks);
+        }
+    }while(n==RECOVER_BATCH);
+
+    return nvs_commit(h);
+}
+
+static esp_err_t txn_reload(void)
+{
+    nvs_handle_t h;
+    esp_err_t err;
+
+    err=nvs_open_from_partition(PARTITION_NAME,TXN_NAMESPACE,NVS_READWRITE,&h);
+    if(err!=ESP_OK) return err;
+
+    err=nvs_get_u32(h,GEN_KEY,&s_gen);
+    if(err==ESP_ERR_NVS_NOT_FOUND){
+        s_gen=0;
+        err=ESP_OK;
+    }
+    if(err==ESP_OK) err=txn_rollback(h);
+
+    nvs_close(h);
+    return err;
+}
+
+/*
+ * 上次提交失败后没能回滚：先重做一遍 reload，成功之前不接受新事务。
+ * 否则 s_gen 可能落后于盘上的 "~gen"，下一次提交会复用同一个代号，
+ * 或者把残留的未提交槽 "顺带" 提交。调用者持有 s_io_lock。
+ */
+static esp_err_t txn_check_recovered(void)
+{
+    esp_err_t err;
+
+    if(!s_needs_recovery) return ESP_OK;
+
+    err=txn_reload();
+    if(err!=ESP_OK){
+        ESP_LOGE(TAG,"Recovery still failing: %s",esp_err_to_name(err));
+        return err;
+    }
+    s_needs_recovery=false;
+    ESP_LOGW(TAG,"Recovered, committed generation %lu",(unsigned long)s_gen);
+    return ESP_OK;
+}
+
+esp_err_t sys_storage_txn_recover(void)
+{
+    esp_err_t err;
+
+    if(s_txn_lock==NULL){
+        s_txn_lock=xSemaphoreCreateMutex();
+        s_io_lock=xSemaphoreCreateMutex();
+        if(s_txn_lock==NULL||s_io_lock==NULL) return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_io_lock,portMAX_DELAY);
+    err=txn_reload();
+    if(err==ESP_OK) s_needs_recovery=false;
+    xSemaphoreGive(s_io_lock);
+
+    if(err==ESP_OK) ESP_LOGI(TAG,"Committed generation %lu",(unsigned long)s_gen);
+    return err;
+}
+
+// ----------------------------------------------------------------------
+// 3. 事务
+// ----------------------------------------------------------------------
+static bool key_valid(const char *key)
+{
+    size_t n=strlen(key);
+    return n>0&&n<=SYS_STORAGE_KEY_MAX&&strchr(key,'~')==NULL;
+}
+
+static void stage_reset(void)
+{
+    s_entry_count=0;
+    s_stage_used=0;
+}
+
+esp_err_t sys_storage_begin(void)
+{
+    esp_err_t err;
+
+    if(s_owner==xTaskGetCurrentTaskHandle()) return ESP_ERR_INVALID_STATE;     // 不支持嵌套
+    sys_storage_wait_nvs();
+    if(s_txn_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_txn_lock,portMAX_DELAY);
+
+    xSemaphoreTake(s_io_lock,portMAX_DELAY);
+    err=txn_check_recovered();
+    xSemaphoreGive(s_io_lock);
+    if(err!=ESP_OK){
+        xSemaphoreGive(s_txn_lock);
+        return err;
+    }
+
+    s_owner=xTaskGetCurrentTaskHandle();
+    stage_reset();
+    return ESP_OK;
+}
+
+esp_err_t sys_storage_put(const char *key,const void *data,size_t len)
+{
+    if(s_owner!=xTaskGetCurrentTaskHandle()) return ESP_ERR_INVALID_STATE;
+    if(!key_valid(key)) return ESP_ERR_INVALID_ARG;
+    if(s_entry_count>=TXN_MAX_KEYS||s_stage_used+len>TXN_BUF_SIZE) return ESP_ERR_NO_MEM;
+
+    // 同一个 key 再 put 一次：以后一次为准 (暂存区不回收，commit/abort 时整体清空)
+    for(uint32_t i=0;i<s_entry_count;i++){
+        if(s_entries[i].live&&strcmp(s_entries[i].key,key)==0) s_entries[i].live=false;
+    }
+
+    txn_entry_t *e=&s_entries[s_entry_count++];
+    strcpy(e->key,key);
+    e->off=(uint16_t)s_stage_used;
+    e->len=(uint16_t)len;
+    e->slot=-1;
+    e->live=true;
+    memcpy(s_stage+s_stage_used,data,len);
+    s_stage_used+=len;
+
+    return ESP_OK;
+}
+
+static esp_err_t txn_write(nvs_handle_t h,uint32_t gen)
+{
+    esp_err_t err;
+    char name[SYS_STORAGE_KEY_MAX+3];
+
+    for(uint32_t i=0;i<s_entry_count;i++){
+        txn_entry_t *e=&s_entries[i];
+        if(!e->live) continue;
+
+        // [A] 写进不是当前值的那个槽
+        e->slot=(int8_t)(slot_current(h,e->key)==0?1:0);
+
+        memcpy(s_scratch,&gen,sizeof(gen));
+        memcpy(s_scratch+sizeof(gen),s_stage+e->off,e->len);
+        slot_key(e->key,e->slot,name);
+        err=nvs_set_blob(h,name,s_scratch,sizeof(gen)+e->len);
+        if(err!=ESP_OK) return err;
+    }
+
+    // [B] 提交点
+    err=nvs_set_u32(h,GEN_KEY,gen);
+    if(err!=ESP_OK) return err;
+
+    return nvs_commit(h);
+}
+
+esp_err_t sys_storage_commit(void)
+{
+    nvs_handle_t h;
+    esp_err_t err;
+
+    if(s_owner!=xTaskGetCurrentTaskHandle()) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_io_lock,portMAX_DELAY);
+
+    err=txn_check_recovered();
+    if(err==ESP_OK){
+        err=nvs_open_from_partition(PARTITION_NAME,TXN_NAMESPACE,NVS_READWRITE,&h);
+        if(err==ESP_OK){
+            err=txn_write(h,s_gen+1);
+            nvs_close(h);
+        }
+
+        if(err==ESP_OK){
+            s_gen++;
+        }else{
+            // "~gen" 可能写进去了也可能没有：重新读一遍，再把没提交的槽擦掉
+            uint32_t gen=s_gen;
+            ESP_LOGE(TAG,"Commit failed: %s",esp_err_to_name(err));
+            if(txn_reload()!=ESP_OK){
+                // 回滚不完整：锁住事务，下一次 begin/commit 先重试 reload
+                ESP_LOGE(TAG,"Rollback failed, transactions blocked until recovery succeeds");
+                s_needs_recovery=true;
+            }else if(s_gen==gen+1){
+                err=ESP_OK;                  // 提交点已经落盘，事务其实成功了
+            }
+        }
+    }
+    if(err==ESP_OK) STAT_INC(txn_commits);
+
+    xSemaphoreGive(s_io_lock);
+
+    stage_reset();
+    s_owner=NULL;
+    xSemaphoreGive(s_txn_lock);
+    return err;
+}
+
+void sys_storage_abort(void)
+{
+    if(s_owner!=xTaskGetCurrentTaskHandle()) return;
+
+    stage_reset();
+    s_owner=NULL;
+    xSemaphoreGive(s_txn_lock);
+}
+
+esp_err_t sys_storage_get(const char *key,void *data,size_t *len)
+{
+    nvs_handle_t h;
+    esp_err_t err;
+    uint32_t gen;
+    size_t n;
+
+    if(!key_valid(key)) return ESP_ERR_INVALID_ARG;
+    sys_storage_wait_nvs();
+    if(s_io_lock==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_io_lock,portMAX_DELAY);
+
+    err=nvs_open_from_partition(PARTITION_NAME,TXN_NAMESPACE,NVS_READONLY,&h);
+    if(err==ESP_OK){
+        int slot=slot_current(h,key);
+
+        if(slot<0||!slot_read(h,key,slot,&gen,&n)){
+            err=ESP_ERR_NVS_NOT_FOUND;
+        }else if(data!=NULL&&*len<n){
+            err=ESP_ERR_NVS_INVALID_LENGTH;
+        }else{
+            if(data!=NULL) memcpy(data,s_scratch+sizeof(gen),n);
+        }
+        if(err==ESP_OK||err==ESP_ERR_NVS_INVALID_LENGTH) *len=n;
+
+        nvs_close(h);
+    }
+
+    xSemaphoreGive(s_io_lock);
+    return err;
+}
\ No newline at end of file
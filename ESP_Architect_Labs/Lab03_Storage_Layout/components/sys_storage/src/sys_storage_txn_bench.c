@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "sys_storage_priv.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include "esp_private/partition_linux.h"
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX && CONFIG_ESP_PARTITION_ENABLE_STATS
+#define BENCH_FLASH_STATS 1
+#else
+#define BENCH_FLASH_STATS 0
+#endif
+
+static const char *TAG="TXN_BENCH";
+
+#define BENCH_NAMESPACE "storage_bench"
+#define BENCH_VALUE_SIZE 32
+#define BENCH_REPEAT 5
+
+static const uint32_t s_key_counts[]={4,16,32};
+
+static uint8_t s_value[BENCH_VALUE_SIZE];
+
+// ----------------------------------------------------------------------
+// 1. 两种保存方式
+// ----------------------------------------------------------------------
+// [单独保存] 每个 key 一次 open / set / commit / close，和 sys_storage_save 直写时一样
+static esp_err_t save_separate(uint32_t keys)
+{
+    esp_err_t err=ESP_OK;
+    char key[16];
+
+    for(uint32_t k=0;k<keys&&err==ESP_OK;k++){
+        nvs_handle_t h;
+        snprintf(key,sizeof(key),"b%lu",(unsigned long)k);
+        err=nvs_open_from_partition(PARTITION_NAME,BENCH_NAMESPACE,NVS_READWRITE,&h);
+        if(err!=ESP_OK) break;
+        err=nvs_set_blob(h,key,s_value,sizeof(s_value));
+        if(err==ESP_OK) err=nvs_commit(h);
+        nvs_close(h);
+    }
+    return err;
+}
+
+// [批量] 一个事务，一次 commit
+static esp_err_t save_batched(uint32_t keys)
+{
+    esp_err_t err;
+    char key[16];
+
+    err=sys_storage_begin();
+    if(err!=ESP_OK) return err;
+
+    for(uint32_t k=0;k<keys;k++){
+        snprintf(key,sizeof(key),"b%lu",(unsigned long)k);
+        err=sys_storage_put(key,s_value,sizeof(s_value));
+        if(err!=ESP_OK){
+            sys_storage_abort();
+            return err;
+        }
+    }
+    return sys_storage_commit();
+}
+
+esp_err_t sys_storage_txn_bench_run(void)
+{
+    esp_err_t err;
+    static const char *const names[]={"separate","batched"};
+
+    printf("TXN_BENCH_BEGIN\n");
+    // entries = nvs_get_stats 的 total - free 差；erases / write_bytes = linux 目标分区模拟的统计，其他目标打印 -1
+    printf("mode,keys,value_bytes,elapsed_us,us_per_key,entries_written,erases,write_bytes\n");
+
+    for(size_t i=0;i<sizeof(s_key_counts)/sizeof(s_key_counts[0]);i++){
+        uint32_t keys=s_key_counts[i];
+        if(keys>CONFIG_SYS_STORAGE_TXN_MAX_KEYS||keys*BENCH_VALUE_SIZE>CONFIG_SYS_STORAGE_TXN_BUF_SIZE) continue;
+
+        for(int m=0;m<2;m++){
+            int64_t us=0;
+            size_t entries=0;
+#if BENCH_FLASH_STATS
+            size_t erases=0;
+            size_t write_bytes=0;
+#endif
+
+            for(int r=0;r<BENCH_REPEAT;r++){
+                memset(s_value,(uint8_t)(r+1),sizeof(s_value));      // 每轮的值都不同，NVS 不会跳过
+
+                size_t e0=sys_storage_entries_consumed();
+#if BENCH_FLASH_STATS
+                esp_partition_clear_stats();
+#endif
+                int64_t t0=esp_timer_get_time();
+                err=(m==0)?save_separate(keys):save_batched(keys);
+                us+=esp_timer_get_time()-t0;
+                size_t e1=sys_storage_entries_consumed();
+#if BENCH_FLASH_STATS
+                erases+=esp_partition_get_erase_ops();
+                write_bytes+=esp_partition_get_write_bytes();
+#endif
+                if(err!=ESP_OK){
+                    ESP_LOGE(TAG,"%s keys=%lu failed: %s",names[m],(unsigned long)keys,esp_err_to_name(err));
+                    return err;
+                }
+                if(e1>e0) entries+=e1-e0;
+            }
+
+            us/=BENCH_REPEAT;
+            printf("%s,%lu,%d,%lld,%.1f,%.1f",names[m],(unsigned long)keys,BENCH_VALUE_SIZE,
+                   (long long)us,(double)us/keys,(double)entries/BENCH_REPEAT);
+#if BENCH_FLASH_STATS
+            printf(",%.1f,%.1f\n",(double)erases/BENCH_REPEAT,(double)write_bytes/BENCH_REPEAT);
+#else
+            printf(",-1,-1\n");
+#endif
+            fflush(stdout);
+        }
+    }
+
+    printf("TXN_BENCH_END\n");
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 2. 掉电注入：第 n 次擦/写失败 = 在提交的第 n 步断电，重新挂载后所有 key 必须同属一个版本
+// ----------------------------------------------------------------------
+#define FAULT_KEYS 8
+#define FAULT_MAX_CUT 96
+
+static esp_err_t put_version(uint32_t version)
+{
+    esp_err_t err=sys_storage_begin();
+    char key[16];
+
+    for(uint32_t k=0;k<FAULT_KEYS&&err==ESP_OK;k++){
+        uint32_t v[4]={version,k,version*k,~version};
+        snprintf(key,sizeof(key),"f%lu",(unsigned long)k);
+        err=sys_storage_put(key,v,sizeof(v));
+    }
+    if(err!=ESP_OK){
+        sys_storage_abort();
+        return err;
+    }
+    return sys_storage_commit();
+}
+
+// 所有 key 都是同一个版本才返回 ESP_OK
+static esp_err_t read_version(uint32_t *version)
+{
+    char key[16];
+
+    for(uint32_t k=0;k<FAULT_KEYS;k++){
+        uint32_t v[4];
+        size_t len=sizeof(v);
+        snprintf(key,sizeof(key),"f%lu",(unsigned long)k);
+        if(sys_storage_get(key,v,&len)!=ESP_OK||len!=sizeof(v)) return ESP_FAIL;
+        if(v[1]!=k||v[2]!=v[0]*k||v[3]!=~v[0]) return ESP_FAIL;
+        if(k==0) *version=v[0];
+        else if(v[0]!=*version) return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sys_storage_txn_fault_test(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    esp_err_t err;
+    uint32_t version=1,seen=0;
+    uint32_t cuts=0;
+
+    err=put_version(version);
+    if(err!=ESP_OK) return err;
+
+    for(size_t n=1;n<=FAULT_MAX_CUT;n++){
+        esp_partition_fail_after(n,ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        esp_err_t commit=put_version(version+1);
+        esp_partition_fail_after(SIZE_MAX,0);
+        if(commit!=ESP_OK) cuts++;
+
+        // "重启"：丢掉 NVS 在 RAM 里的状态，从 flash 重新挂载 (会跑事务恢复)
+        nvs_flash_deinit_partition(PARTITION_NAME);
+        err=sys_storage_init();
+        if(err!=ESP_OK){
+            ESP_LOGE(TAG,"cut %u: remount failed: %s",(unsigned)n,esp_err_to_name(err));
+            return err;
+        }
+
+        if(read_version(&seen)!=ESP_OK||(seen!=version&&seen!=version+1)||(commit==ESP_OK&&seen!=version+1)){
+            ESP_LOGE(TAG,"cut %u: torn transaction (commit=%s)",(unsigned)n,esp_err_to_name(commit));
+            return ESP_FAIL;
+        }
+        version=seen;
+    }
+
+    ESP_LOGI(TAG,"Transaction fault test passed: %lu power cuts, all-or-nothing every time",(unsigned long)cuts);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
\ No newline at end of file
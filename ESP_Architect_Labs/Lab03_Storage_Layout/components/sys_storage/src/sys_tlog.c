@@ -0,0 +1,373 @@
+#include "sys_tlog.h"
+#include "sys_tlog_priv.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG="SYS_TLOG";
+
+#define PARTITION_NAME "tlog"        // 对应的 CSV 分区名字
+
+#define SECTOR_MAGIC 0x474F4C54      // "TLOG"
+#define BLANK_WORD 0xFFFFFFFF        // 擦除后的 flash
+
+// 扇区头，擦除之后第一个写
+typedef struct{
+    uint32_t magic;
+    uint32_t sector_seq;             // 每擦一个扇区 +1，最大的就是正在写的扇区
+    uint32_t first_seq;              // 本扇区第一条记录的 seq (扇区还空着时用来恢复 next_seq)
+    uint32_t crc;
+} tlog_sector_hdr_t;
+
+// 记录头，后面紧跟 payload，整条记录补齐到 4 字节
+typedef struct{
+    uint32_t seq;
+    uint16_t len;
+    uint16_t type;
+    uint32_t crc;                    // 覆盖 seq/len/type 和 payload
+} tlog_rec_hdr_t;
+
+_Static_assert(sizeof(tlog_sector_hdr_t)==16,"sector header layout");
+_Static_assert(sizeof(tlog_rec_hdr_t)==12,"record header layout");
+_Static_assert(SYS_TLOG_MAX_PAYLOAD==SYS_TLOG_SECTOR_SIZE-sizeof(tlog_sector_hdr_t)-sizeof(tlog_rec_hdr_t),"max payload");
+
+#define REC_ALIGN(n) (((n)+3u)&~3u)
+
+static struct{
+    const esp_partition_t *part;
+    const uint8_t *map;              // 整个分区的只读映射
+    esp_partition_mmap_handle_t map_handle;
+    SemaphoreHandle_t lock;          // 追加 / 轮转互斥
+    uint32_t sectors;
+    uint32_t active;                 // 正在写的扇区
+    uint32_t sector_seq;             // active 的扇区序号
+    uint32_t write_off;              // active 内下一条记录的偏移
+    bool sealed;                     // active 尾部有半截数据，下一条必须换扇区
+    sys_tlog_stats_t stats;
+} s_log;
+
+// ----------------------------------------------------------------------
+// 1. 解析 (挂载恢复和遍历共用，都直接读映射)
+// ----------------------------------------------------------------------
+static uint32_t sector_hdr_crc(const tlog_sector_hdr_t *h)
+{
+    return esp_rom_crc32_le(0,(const uint8_t *)h,offsetof(tlog_sector_hdr_t,crc));
+}
+
+static uint32_t rec_crc(const tlog_rec_hdr_t *h,const void *payload)
+{
+    uint32_t crc=esp_rom_crc32_le(0,(const uint8_t *)h,offsetof(tlog_rec_hdr_t,crc));
+    return esp_rom_crc32_le(crc,payload,h->len);
+}
+
+static const tlog_sector_hdr_t *sector_hdr(uint32_t sector)
+{
+    const tlog_sector_hdr_t *h=(const tlog_sector_hdr_t *)(s_log.map+sector*SYS_TLOG_SECTOR_SIZE);
+
+    if(h->magic!=SECTOR_MAGIC||h->crc!=sector_hdr_crc(h)) return NULL;
+    return h;
+}
+
+typedef enum{
+    REC_OK,
+    REC_END,                         // 全 0xFF：扇区在这里结束
+    REC_TORN,                        // 写了一半
+} rec_state_t;
+
+static rec_state_t rec_parse(uint32_t sector,uint32_t off,const tlog_rec_hdr_t **out)
+{
+    if(off+sizeof(tlog_rec_hdr_t)>SYS_TLOG_SECTOR_SIZE) return REC_END;
+
+    const uint8_t *base=s_log.map+sector*SYS_TLOG_SECTOR_SIZE;
+    const tlog_rec_hdr_t *h=(const tlog_rec_hdr_t *)(base+off);
+    const uint32_t *w=(const uint32_t *)h;
+
+    if(w[0]==BLANK_WORD&&w[1]==BLANK_WORD&&w[2]==BLANK_WORD) return REC_END;
+
+    if(off+sizeof(*h)+h->len>SYS_TLOG_SECTOR_SIZE) return REC_TORN;
+    if(h->crc!=rec_crc(h,h+1)) return REC_TORN;
+
+    *out=h;
+    return REC_OK;
+}
+
+static bool sector_blank(uint32_t sector)
+{
+    const uint32_t *w=(const uint32_t *)(s_log.map+sector*SYS_TLOG_SECTOR_SIZE);
+
+    for(uint32_t i=0;i<SYS_TLOG_SECTOR_SIZE/4;i++){
+        if(w[i]!=BLANK_WORD) return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 2. 扇区轮转
+// ----------------------------------------------------------------------
+// 擦 sector (已经是空的就跳过，省一次擦除)，写扇区头，切过去
+static esp_err_t sector_open(uint32_t sector,uint32_t sector_seq,uint32_t first_seq)
+{
+    esp_err_t err;
+    uint32_t addr=sector*SYS_TLOG_SECTOR_SIZE;
+
+    if(!sector_blank(sector)){
+        err=esp_partition_erase_range(s_log.part,addr,SYS_TLOG_SECTOR_SIZE);
+        if(err!=ESP_OK) return err;
+        s_log.stats.erases++;
+    }
+
+    tlog_sector_hdr_t h={
+        .magic=SECTOR_MAGIC,
+        .sector_seq=sector_seq,
+        .first_seq=first_seq,
+    };
+    h.crc=sector_hdr_crc(&h);
+
+    // 扇区头写了一半：挂载时 CRC 不对，当作没用过的扇区，下次轮到时重新擦
+    err=esp_partition_write(s_log.part,addr,&h,sizeof(h));
+    if(err!=ESP_OK) return err;
+
+    s_log.active=sector;
+    s_log.sector_seq=sector_seq;
+    s_log.write_off=sizeof(h);
+    s_log.sealed=false;
+    return ESP_OK;
+}
+
+static esp_err_t sector_rotate(void)
+{
+    // 下一个扇区就是环上最旧的：擦掉它等于丢掉最旧的一批记录
+    return sector_open((s_log.active+1)%s_log.sectors,s_log.sector_seq+1,s_log.stats.next_seq);
+}
+
+// ----------------------------------------------------------------------
+// 3. 挂载 / 掉电恢复
+// ----------------------------------------------------------------------
+static esp_err_t log_recover(void)
+{
+    const tlog_sector_hdr_t *newest=NULL;
+
+    // [A] 扇区序号最大的有效扇区就是掉电前正在写的
+    for(uint32_t i=0;i<s_log.sectors;i++){
+        const tlog_sector_hdr_t *h=sector_hdr(i);
+        if(h!=NULL&&(newest==NULL||h->sector_seq>newest->sector_seq)){
+            newest=h;
+            s_log.active=i;
+        }
+    }
+
+    if(newest==NULL){
+        // 全新的分区 (或者什么都没写成过)
+        s_log.stats.next_seq=1;
+        return sector_open(0,1,1);
+    }
+
+    s_log.sector_seq=newest->sector_seq;
+    s_log.stats.next_seq=newest->first_seq;
+    s_log.write_off=sizeof(tlog_sector_hdr_t);
+    s_log.sealed=false;
+
+    // [B] 顺着记录扫到尾部
+    while(1){
+        const tlog_rec_hdr_t *h;
+        rec_state_t st=rec_parse(s_log.active,s_log.write_off,&h);
+
+        if(st==REC_END) break;
+        if(st==REC_TORN){
+            // [C] 半截记录后面的字节已经不是 0xFF，不能接着写：封掉这个扇区
+            s_log.sealed=true;
+            s_log.stats.torn_tails++;
+            ESP_LOGW(TAG,"Torn record at sector %lu offset %lu, sealing sector",
+                     (unsigned long)s_log.active,(unsigned long)s_log.write_off);
+            break;
+        }
+
+        s_log.stats.next_seq=h->seq+1;
+        s_log.write_off+=REC_ALIGN(sizeof(*h)+h->len);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t sys_tlog_init(void)
+{
+    esp_err_t err;
+    const void *map;
+
+    if(s_log.part!=NULL) return ESP_OK;
+
+    const esp_partition_t *part=esp_partition_find_first(ESP_PARTITION_TYPE_DATA,ESP_PARTITION_SUBTYPE_ANY,PARTITION_NAME);
+    if(part==NULL) return ESP_ERR_NOT_FOUND;
+    if(part->size<2*SYS_TLOG_SECTOR_SIZE||part->size%SYS_TLOG_SECTOR_SIZE!=0) return ESP_ERR_INVALID_SIZE;
+
+    // 映射整个分区：写 flash 时 IDF 会把对应的 cache 作废，映射里读到的总是最新内容
+    err=esp_partition_mmap(part,0,part->size,ESP_PARTITION_MMAP_DATA,&map,&s_log.map_handle);
+    if(err!=ESP_OK) return err;
+
+    s_log.lock=xSemaphoreCreateMutex();
+    if(s_log.lock==NULL){
+        esp_partition_munmap(s_log.map_handle);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_log.part=part;
+    s_log.map=map;
+    s_log.sectors=part->size/SYS_TLOG_SECTOR_SIZE;
+    memset(&s_log.stats,0,sizeof(s_log.stats));
+    s_log.stats.sectors=s_log.sectors;
+
+    err=log_recover();
+    if(err!=ESP_OK){
+        sys_tlog_deinit();
+        return err;
+    }
+
+    ESP_LOGI(TAG,"Mounted %lu sectors, active %lu @%lu, next seq %lu",
+             (unsigned long)s_log.sectors,(unsigned long)s_log.active,
+             (unsigned long)s_log.write_off,(unsigned long)s_log.stats.next_seq);
+    return ESP_OK;
+}
+
+esp_err_t sys_tlog_deinit(void)
+{
+    if(s_log.part==NULL) return ESP_ERR_INVALID_STATE;
+
+    esp_partition_munmap(s_log.map_handle);
+    vSemaphoreDelete(s_log.lock);
+    memset(&s_log,0,sizeof(s_log));
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 4. 追加 / 遍历
+// ----------------------------------------------------------------------
+esp_err_t sys_tlog_append(uint16_t type,const void *data,size_t len,uint32_t *out_seq)
+{
+    esp_err_t err=ESP_OK;
+
+    if(s_log.part==NULL) return ESP_ERR_INVALID_STATE;
+    if(len>SYS_TLOG_MAX_PAYLOAD) return ESP_ERR_INVALID_SIZE;
+
+    xSemaphoreTake(s_log.lock,portMAX_DELAY);
+
+    uint32_t size=REC_ALIGN(sizeof(tlog_rec_hdr_t)+len);
+    if(s_log.sealed||s_log.write_off+size>SYS_TLOG_SECTOR_SIZE){
+        err=sector_rotate();
+    }
+
+    if(err==ESP_OK){
+        tlog_rec_hdr_t h={
+            .seq=s_log.stats.next_seq,
+            .len=(uint16_t)len,
+            .type=type,
+        };
+        h.crc=rec_crc(&h,data);
+
+        // 先头后 payload，中间掉电 = CRC 不对 = 挂载时当作半截记录
+        uint32_t addr=s_log.active*SYS_TLOG_SECTOR_SIZE+s_log.write_off;
+        err=esp_partition_write(s_log.part,addr,&h,sizeof(h));
+        if(err==ESP_OK&&len>0) err=esp_partition_write(s_log.part,addr+sizeof(h),data,len);
+
+        if(err==ESP_OK){
+            s_log.write_off+=size;
+            s_log.stats.next_seq++;
+            s_log.stats.appends++;
+            s_log.stats.bytes+=len;
+            if(out_seq!=NULL) *out_seq=h.seq;
+        }else{
+            // 尾部可能留下了半截数据
+            s_log.sealed=true;
+        }
+    }
+
+    if(err!=ESP_OK) s_log.stats.append_errors++;
+
+    xSemaphoreGive(s_log.lock);
+    return err;
+}
+
+esp_err_t sys_tlog_clear(void)
+{
+    esp_err_t err;
+
+    if(s_log.part==NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_log.lock,portMAX_DELAY);
+
+    err=esp_partition_erase_range(s_log.part,0,s_log.part->size);
+    if(err==ESP_OK){
+        s_log.stats.erases+=s_log.sectors;
+        s_log.stats.next_seq=1;
+        err=sector_open(0,1,1);
+    }
+
+    xSemaphoreGive(s_log.lock);
+    return err;
+}
+
+void sys_tlog_iter_begin(sys_tlog_iter_t *it)
+{
+    // 没挂上分区 (sectors 也是 0)：空迭代，next 直接返回 false
+    if(s_log.part==NULL){
+        it->sector=0;
+        it->offset=0;
+        it->remaining=0;
+        return;
+    }
+
+    // active 的下一个扇区是环上最旧的
+    it->sector=(s_log.active+1)%s_log.sectors;
+    it->offset=sizeof(tlog_sector_hdr_t);
+    it->remaining=s_log.sectors;
+}
+
+bool sys_tlog_iter_next(sys_tlog_iter_t *it,sys_tlog_record_t *rec)
+{
+    if(s_log.part==NULL) return false;
+
+    while(it->remaining>0){
+        const tlog_rec_hdr_t *h;
+
+        if(sector_hdr(it->sector)!=NULL&&rec_parse(it->sector,it->offset,&h)==REC_OK){
+            rec->seq=h->seq;
+            rec->type=h->type;
+            rec->len=h->len;
+            rec->data=h+1;
+            it->offset+=REC_ALIGN(sizeof(*h)+h->len);
+            return true;
+        }
+
+        // 空扇区 / 扇区结束 / 半截记录：下一个扇区
+        it->sector=(it->sector+1)%s_log.sectors;
+        it->offset=sizeof(tlog_sector_hdr_t);
+        it->remaining--;
+    }
+
+    return false;
+}
+
+void sys_tlog_get_stats(sys_tlog_stats_t *stats)
+{
+    if(s_log.part==NULL){
+        memset(stats,0,sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_log.lock,portMAX_DELAY);
+    *stats=s_log.stats;
+    xSemaphoreGive(s_log.lock);
+}
+
+const esp_partition_t *sys_tlog_priv_partition(void)
+{
+    return s_log.part;
+}
+
+uint32_t sys_tlog_priv_tail(void)
+{
+    if(s_log.sealed) return UINT32_MAX;
+    return s_log.active*SYS_TLOG_SECTOR_SIZE+s_log.write_off;
+}
\ No newline at end of file
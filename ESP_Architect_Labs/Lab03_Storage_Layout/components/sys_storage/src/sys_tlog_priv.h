@@ -0,0 +1,10 @@
+#pragma once
+#include "esp_partition.h"
+#include <stdint.h>
+
+// 只给 sys_tlog_test.c 用：往尾部直接写半截数据来模拟掉电
+
+const esp_partition_t *sys_tlog_priv_partition(void);
+
+// 下一条记录会写到的分区内偏移；当前扇区已经封掉时返回 UINT32_MAX
+uint32_t sys_tlog_priv_tail(void);
\ No newline at end of file
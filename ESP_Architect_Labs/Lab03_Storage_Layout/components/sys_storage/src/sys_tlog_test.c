@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "sdkconfig.h"
+#include "sys_tlog.h"
+#include "sys_tlog_priv.h"
+#include "sys_storage_priv.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include "esp_private/partition_linux.h"
+#endif
+
+static const char *TAG="TLOG_TEST";
+
+#define TEST_ROUNDS 40
+#define TEST_MAX_BURST 48            // 每轮最多追加几条 (最长记录约 20 条一个扇区，经常跨扇区)
+
+// ----------------------------------------------------------------------
+// 1. 记录内容完全由 seq 决定，恢复之后可以逐字节核对
+// ----------------------------------------------------------------------
+static uint8_t s_buf[256];
+static uint32_t s_rng=1;
+
+static size_t payload_for(uint32_t seq,uint8_t *buf)
+{
+    size_t len=8+(seq*37)%(sizeof(s_buf)-8);
+    for(size_t i=0;i<len;i++) buf[i]=(uint8_t)(seq*131+i);
+    return len;
+}
+
+static esp_err_t append_seq(uint32_t *acked)
+{
+    uint32_t seq=*acked+1;
+    size_t len=payload_for(seq,s_buf);
+    uint32_t got;
+
+    esp_err_t err=sys_tlog_append((uint16_t)seq,s_buf,len,&got);
+    if(err!=ESP_OK) return err;
+    if(got!=seq){
+        ESP_LOGE(TAG,"Append returned seq %lu, expected %lu",(unsigned long)got,(unsigned long)seq);
+        return ESP_FAIL;
+    }
+    *acked=seq;
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 2. 重新挂载并核对
+//    已确认的最后一条必须在；最多多出一条 (失败的那次可能已经完整写进去了)；
+//    环头上被轮转擦掉的旧记录不算丢。
+// ----------------------------------------------------------------------
+static esp_err_t remount_and_verify(uint32_t *acked,const char *what)
+{
+    esp_err_t err;
+
+    sys_tlog_deinit();
+    err=sys_tlog_init();
+    if(err!=ESP_OK){
+        ESP_LOGE(TAG,"[%s] remount failed: %s",what,esp_err_to_name(err));
+        return err;
+    }
+
+    sys_tlog_iter_t it;
+    sys_tlog_record_t rec;
+    uint32_t prev=0,count=0;
+    uint8_t expect[sizeof(s_buf)];
+
+    sys_tlog_iter_begin(&it);
+    while(sys_tlog_iter_next(&it,&rec)){
+        size_t len=payload_for(rec.seq,expect);
+        if((prev!=0&&rec.seq!=prev+1)||rec.len!=len||rec.type!=(uint16_t)rec.seq||memcmp(rec.data,expect,len)!=0){
+            ESP_LOGE(TAG,"[%s] bad record seq %lu after %lu",what,(unsigned long)rec.seq,(unsigned long)prev);
+            return ESP_FAIL;
+        }
+        prev=rec.seq;
+        count++;
+    }
+
+    if(prev<*acked||prev>*acked+1||(*acked>0&&count==0)){
+        ESP_LOGE(TAG,"[%s] last seq %lu, acked %lu",what,(unsigned long)prev,(unsigned long)*acked);
+        return ESP_FAIL;
+    }
+
+    // 没确认但已经完整落盘的那一条，从现在起也算确认了
+    *acked=prev;
+
+    // 恢复之后必须还能接着写
+    return append_seq(acked);
+}
+
+// ----------------------------------------------------------------------
+// 3. 手工写半截数据 (任何目标上都能跑)
+// ----------------------------------------------------------------------
+typedef enum{
+    TORN_REC_HEADER,                 // 记录头只写了前几个字节
+    TORN_REC_PAYLOAD,                // 记录头完整，payload 写了一半
+    TORN_SECTOR_HEADER,              // 擦完下一个扇区，扇区头写了一半
+    TORN_KINDS,
+} torn_kind_t;
+
+static const char *const s_torn_names[]={"torn_rec_header","torn_rec_payload","torn_sector_header"};
+
+static esp_err_t inject_torn(torn_kind_t kind,uint32_t acked)
+{
+    const esp_partition_t *part=sys_tlog_priv_partition();
+    uint32_t tail=sys_tlog_priv_tail();
+    uint8_t junk[8];
+    esp_err_t err;
+
+    if(tail==UINT32_MAX) return ESP_OK;      // 已经封掉了，没有地方可写
+
+    // 下一条记录本来的样子 (头部字段按 sys_tlog.c 的布局，payload 用真实内容)
+    uint32_t seq=acked+1;
+    size_t len=payload_for(seq,s_buf);
+    uint32_t hdr[3]={seq,(uint32_t)len|(uint32_t)(uint16_t)seq<<16,0x12345678};
+
+    switch(kind){
+    case TORN_REC_HEADER:
+        return esp_partition_write(part,tail,hdr,6);
+
+    case TORN_REC_PAYLOAD:
+        if(tail%SYS_TLOG_SECTOR_SIZE+sizeof(hdr)+len>SYS_TLOG_SECTOR_SIZE) return ESP_OK;
+        err=esp_partition_write(part,tail,hdr,sizeof(hdr));
+        if(err==ESP_OK) err=esp_partition_write(part,tail+sizeof(hdr),s_buf,len/2);
+        return err;
+
+    default:{
+        uint32_t next=(tail/SYS_TLOG_SECTOR_SIZE+1)%(part->size/SYS_TLOG_SECTOR_SIZE);
+        memset(junk,0x5A,sizeof(junk));
+        err=esp_partition_erase_range(part,next*SYS_TLOG_SECTOR_SIZE,SYS_TLOG_SECTOR_SIZE);
+        if(err==ESP_OK) err=esp_partition_write(part,next*SYS_TLOG_SECTOR_SIZE,junk,sizeof(junk));
+        return err;
+    }
+    }
+}
+
+static esp_err_t run_torn_writes(void)
+{
+    esp_err_t err;
+    uint32_t acked=0;
+
+    err=sys_tlog_clear();
+    if(err!=ESP_OK) return err;
+
+    for(int round=0;round<TEST_ROUNDS;round++){
+        uint32_t burst=1+(sys_test_rng_next(&s_rng)>>8)%TEST_MAX_BURST;
+        for(uint32_t k=0;k<burst;k++){
+            err=append_seq(&acked);
+            if(err!=ESP_OK) return err;
+        }
+
+        torn_kind_t kind=(torn_kind_t)(round%TORN_KINDS);
+        err=inject_torn(kind,acked);
+        if(err!=ESP_OK) return err;
+
+        err=remount_and_verify(&acked,s_torn_names[kind]);
+        if(err!=ESP_OK) return err;
+    }
+
+    ESP_LOGI(TAG,"torn writes: %d rounds ok, last seq %lu",TEST_ROUNDS,(unsigned long)acked);
+    return ESP_OK;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+// ----------------------------------------------------------------------
+// 4. 分区模拟的掉电：第 n 次擦/写失败 (之后的操作也都失败，直到重新设置)
+// ----------------------------------------------------------------------
+static esp_err_t run_fail_after(void)
+{
+    esp_err_t err;
+    uint32_t acked=0;
+    uint32_t cuts=0;
+
+    err=sys_tlog_clear();
+    if(err!=ESP_OK) return err;
+
+    for(size_t n=1;n<=TEST_ROUNDS*4;n++){
+        esp_partition_fail_after(n,ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+
+        // 一直写到 "掉电"
+        for(int k=0;k<TEST_MAX_BURST*4;k++){
+            if(append_seq(&acked)!=ESP_OK){
+                cuts++;
+                break;
+            }
+        }
+
+        esp_partition_fail_after(SIZE_MAX,0);
+
+        char what[24];
+        snprintf(what,sizeof(what),"fail_after_%u",(unsigned)n);
+        err=remount_and_verify(&acked,what);
+        if(err!=ESP_OK) return err;
+    }
+
+    ESP_LOGI(TAG,"fail_after: %lu power cuts ok, last seq %lu",(unsigned long)cuts,(unsigned long)acked);
+    return ESP_OK;
+}
+#endif
+
+esp_err_t sys_tlog_fault_test(void)
+{
+    esp_err_t err=run_torn_writes();
+
+#if CONFIG_IDF_TARGET_LINUX
+    if(err==ESP_OK) err=run_fail_after();
+#endif
+
+    sys_tlog_stats_t st;
+    sys_tlog_get_stats(&st);
+    ESP_LOGI(TAG,"Fault test %s (torn tails seen at last mount: %lu)",
+             err==ESP_OK?"PASSED":"FAILED",(unsigned long)st.torn_tails);
+
+    if(err==ESP_OK) err=sys_tlog_clear();
+    return err;
+}
\ No newline at end of file
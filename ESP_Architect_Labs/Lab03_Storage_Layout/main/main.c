@@ -2,7 +2,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "sdkconfig.h"
 #include "sys_storage.h"
+#include "sys_tlog.h"
 
 static const char *TAG="MAIN";
 
@@ -10,8 +12,24 @@ void app_main(void)
 {
     ESP_LOGI(TAG,"Syetem Starting...");
 
+#if CONFIG_SYS_STORAGE_CODEC_SELFTEST
+    ESP_ERROR_CHECK(sys_storage_codec_selftest());
+#endif
+
+#if CONFIG_SYS_STORAGE_BLOB_SELFTEST
+    ESP_ERROR_CHECK(sys_storage_blob_selftest());
+#endif
+
     ESP_ERROR_CHECK(sys_storage_init());
 
+    // 上电到拿到配置的时间：有快照时 init 不等 NVS 挂载 (关掉 CONFIG_SYS_STORAGE_FAST_BOOT 对比)
+    sys_storage_boot_info_t boot;
+    sys_storage_get_boot_info(&boot);
+    ESP_LOGI(TAG,"Config ready at %lld us (%s)",(long long)boot.config_ready_us,boot.from_snapshot?"snapshot":"NVS");
+    ESP_ERROR_CHECK(sys_storage_wait_ready(5000));
+    sys_storage_get_boot_info(&boot);
+    ESP_LOGI(TAG,"NVS ready at %lld us%s",(long long)boot.nvs_ready_us,boot.snapshot_stale?", snapshot was stale":"");
+
     sys_config_t tx_data={
         .magic_id=0xAABBCCDD,
         .config_ver=1,
@@ -34,13 +52,98 @@ void app_main(void)
     if(sys_storage_load(&rx_data)==ESP_OK)
     {
         ESP_LOGI(TAG,"Load API returned Success.");
-        ESP_LOGI(TAG,"Read Data->Magic:0x%08lX",rx_data.magic_id);
+        ESP_LOGI(TAG,"Read Data->Magic:0x%08lX Ver:%u Flag:0x%02X",(unsigned long)rx_data.magic_id,rx_data.config_ver,rx_data.flag);
     }
     else
     {
         ESP_LOGE(TAG,"Load API failed!");
     }
 
+    // 连续写一串：写回模式下只有最后一个值会落盘，和缓存一样的值直接丢掉
+    for(int i=0;i<20;i++)
+    {
+        tx_data.flag=(uint8_t)i;
+        sys_storage_save(&tx_data);
+    }
+    for(int i=0;i<10;i++)
+    {
+        sys_storage_save(&tx_data);
+        sys_storage_load(&rx_data);
+    }
+
+    sys_storage_stats_t st;
+    sys_storage_get_stats(&st);
+    ESP_LOGI(TAG,"Before flush: saves=%lu suppressed=%lu coalesced=%lu commits=%lu loads=%lu hits=%lu",
+             (unsigned long)st.saves,(unsigned long)st.suppressed,(unsigned long)st.coalesced,
+             (unsigned long)st.commits,(unsigned long)st.loads,(unsigned long)st.load_hits);
+
+    if(sys_storage_flush()!=ESP_OK)
+    {
+        ESP_LOGE(TAG,"Flush failed!");
+    }
+
+    sys_storage_get_stats(&st);
+    ESP_LOGI(TAG,"After flush:  commits=%lu errors=%lu",(unsigned long)st.commits,(unsigned long)st.commit_errors);
+
+    // 批量事务：几个相关的 key 一起生效
+    uint32_t boot_count=0;
+    size_t len=sizeof(boot_count);
+    sys_storage_get("boot_count",&boot_count,&len);
+    boot_count++;
+    if(sys_storage_begin()==ESP_OK)
+    {
+        sys_storage_put("boot_count",&boot_count,sizeof(boot_count));
+        sys_storage_put("last_cfg",&rx_data,sizeof(rx_data));
+        if(sys_storage_commit()==ESP_OK)
+        {
+            ESP_LOGI(TAG,"Boot #%lu committed",(unsigned long)boot_count);
+        }
+    }
+
+#if CONFIG_SYS_STORAGE_TXN_FAULT_TEST
+    sys_storage_txn_fault_test();
+#endif
+
+#if CONFIG_SYS_STORAGE_TXN_BENCH
+    sys_storage_txn_bench_run();
+#endif
+
+#if CONFIG_SYS_STORAGE_BLOB_BENCH
+    sys_storage_blob_bench_run();
+#endif
+
+#if CONFIG_SYS_STORAGE_BENCH
+    sys_storage_bench_run();
+#endif
+
+    // 遥测日志：每次上电追加一条，看得出掉电前写到了哪
+    ESP_ERROR_CHECK(sys_tlog_init());
+
+#if CONFIG_SYS_TLOG_FAULT_TEST
+    sys_tlog_fault_test();
+#endif
+
+#if CONFIG_SYS_TLOG_BENCH
+    sys_tlog_bench_run();
+#endif
+
+    uint32_t seq=0;
+    if(sys_tlog_append(0,&rx_data,sizeof(rx_data),&seq)==ESP_OK)
+    {
+        ESP_LOGI(TAG,"Boot record appended, seq=%lu",(unsigned long)seq);
+    }
+
+    sys_tlog_iter_t it;
+    sys_tlog_record_t rec;
+    uint32_t count=0,oldest=0;
+    sys_tlog_iter_begin(&it);
+    while(sys_tlog_iter_next(&it,&rec))
+    {
+        if(count==0) oldest=rec.seq;
+        count++;
+    }
+    ESP_LOGI(TAG,"Telemetry log: %lu records, seq %lu..%lu",(unsigned long)count,(unsigned long)oldest,(unsigned long)seq);
+
     while(1)
     {
         vTaskDelay(pdMS_TO_TICKS(1000));
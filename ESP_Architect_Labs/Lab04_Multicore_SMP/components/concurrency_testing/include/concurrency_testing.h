@@ -3,13 +3,34 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "esp_err.h"
 
 #ifdef __cplusplus
 extern "C"{
 #endif
 
+/* 锁算法对比的一组参数 (运行时可改，不用重新烧录) */
+typedef struct {
+    uint32_t cs_nops;       // 临界区长度：持锁期间空转的 nop 数
+    uint32_t read_pct;      // 读操作占比 0~100 (读写锁 / seqlock 的读者可以并发)
+    uint32_t ops_per_core;  // 每轮每个核做多少次操作 (轮数见 SMP_TEST_WARMUP_RUNS / SMP_TEST_MEASURED_RUNS)
+} smp_lock_params_t;
+
 void start_smp_test(void);
 
+/**
+ * @brief 用同一组参数依次测所有锁 (none / atomic / portmux / mutex / ticket / mcs / ttas / rwlock / seqlock)
+ * 每种锁一行 CSV (SMP_LOCK_BENCH_BEGIN / SMP_LOCK_BENCH_END 之间)：
+ * 每次操作周期数的均值/标准差/最小/最大 (smp_harness 多轮测量)、ops/s、
+ * 两个核的公平性、等锁周期分布、丢失的更新和撕裂的读
+ */
+esp_err_t smp_lock_bench_run(const smp_lock_params_t *params);
+
+/**
+ * @brief 扫参：所有锁 x SMP_LOCK_BENCH_CS_NOPS x SMP_LOCK_BENCH_READ_PCT
+ */
+esp_err_t smp_lock_bench_sweep(void);
+
 #ifdef __cplusplus
 }
 #endif
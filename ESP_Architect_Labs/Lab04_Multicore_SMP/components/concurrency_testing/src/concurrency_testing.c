@@ -2,12 +2,17 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
-#include "esp_timer.h"
 #include "sdkconfig.h"
+#include "cpu_load.h"
+#include "sharded_counter.h"
+#include "smp_harness.h"
 #include "concurrency_testing.h"
 
+#define LOOP_COUNT      100000
+#define EXPECTED_TOTAL  (2 * LOOP_COUNT)
+
 volatile int g_shared_counter=0;
-volatile bool test_start_signal = false;
+static uint32_t g_lost_total = 0;     // 所有测量轮丢掉的加法次数之和
 
 #if CONFIG_SMP_RACE_CONDITION_SPINLOCK
     static portMUX_TYPE my_spinlock=portMUX_INITIALIZER_UNLOCKED;
@@ -17,19 +22,25 @@ volatile bool test_start_signal = false;
     static SemaphoreHandle_t my_mutex=NULL;
 #endif
 
-void worker_task(void *arg){
-    const int loop_count=100000;
+#if CONFIG_SMP_RACE_CONDITION_SHARDED
+    static sharded_counter_t my_counter;
+#endif
+
+// 一轮：每个核加 LOOP_COUNT 次。起跑和收尾的同步都由 smp_harness 的屏障负责
+static uint32_t worker_body(int core, void *ctx){
     int i;
     int temp;
 
-    while (test_start_signal == false) {
-        // 空转等待，什么都不做
-        vTaskDelay(1);
-    }
-
-    int64_t start_time=esp_timer_get_time();
+    for(i=0;i<LOOP_COUNT;i++){
+        #if CONFIG_SMP_RACE_CONDITION_SHARDED
+            // 同样的 "干活" 时间，但不需要拿旧值：每个核只加自己的槽
+            for(int j=0; j<50; j++) {
+                __asm__ __volatile__("nop");
+            }
+            sharded_counter_inc(&my_counter);
+            continue;
+        #endif
 
-    for(i=0;i<loop_count;i++){
         #if CONFIG_SMP_RACE_CONDITION_SPINLOCK
             portENTER_CRITICAL(&my_spinlock);
         #endif
@@ -64,17 +75,32 @@ void worker_task(void *arg){
 
     }
 
-    int64_t end_time=esp_timer_get_time();
-    int time_ms=(int)(end_time-start_time)/1000;
-    printf("Core %d: Done! Added %d times. Cost: %d ms\n", xPortGetCoreID(), loop_count, time_ms);
-    vTaskDelete(NULL);
+    return LOOP_COUNT;
 }
 
-void start_smp_test(void) {
+static void round_setup(void *ctx){
     g_shared_counter = 0;
+#if CONFIG_SMP_RACE_CONDITION_SHARDED
+    sharded_counter_reset(&my_counter);
+#endif
+}
 
-    test_start_signal = false;
-    
+static bool round_verify(void *ctx){
+#if CONFIG_SMP_RACE_CONDITION_SHARDED
+    // 热路径上没有共享变量，结果在读的时候才汇总
+    g_shared_counter = (int)sharded_counter_read(&my_counter);
+#endif
+    g_lost_total += EXPECTED_TOTAL - g_shared_counter;
+    return g_shared_counter == EXPECTED_TOTAL;
+}
+
+static void measure_begin(void *ctx){
+    // 预热轮结束，从这里开始统计两个核的忙碌比例
+    g_lost_total = 0;
+    cpu_load_window_begin();
+}
+
+void start_smp_test(void) {
     printf("-------------------------------------------------\n");
     printf("Starting SMP Race Condition Test...\n");
 
@@ -88,31 +114,55 @@ void start_smp_test(void) {
         if (my_mutex == NULL) {
             my_mutex = xSemaphoreCreateMutex();
         }
+    #elif CONFIG_SMP_RACE_CONDITION_SHARDED
+        printf("Mode: SHARDED COUNTER (Expect Correct 200,000)\n");
     #endif
     
+    printf("Runs: %d warmup + %d measured\n", CONFIG_SMP_TEST_WARMUP_RUNS, CONFIG_SMP_TEST_MEASURED_RUNS);
     printf("-------------------------------------------------\n");
 
-    xTaskCreatePinnedToCore(worker_task, "Worker_Core0", 2048, NULL, 5, NULL, 0);
-
-    xTaskCreatePinnedToCore(worker_task, "Worker_Core1", 2048, NULL, 5, NULL, 1);
+    const smp_harness_case_t tc = {
+        .name = "race_test",
+        .setup = round_setup,
+        .body = worker_body,
+        .verify = round_verify,
+        .reset = measure_begin,
+        .warmup = CONFIG_SMP_TEST_WARMUP_RUNS,
+        .iterations = CONFIG_SMP_TEST_MEASURED_RUNS,
+    };
+    smp_harness_result_t res;
+    if (smp_harness_run(&tc, &res) != ESP_OK) {
+        printf("Failed to start harness workers\n");
+        return;
+    }
 
-    for(int k=0; k<10000; k++) { __asm__ __volatile__("nop"); }
+    // 忙碌周期 / 总加法次数 = 每次加法的真实代价 (含自旋等锁 / 互斥量切换)
+    cpu_load_report_t load;
+    if (cpu_load_window_end(&load) == ESP_OK) {
+        cpu_load_print("smp_test", &load, EXPECTED_TOTAL * res.iterations, "op");
+    }
 
-    printf("Start!!!\n");
-    
-    // === 核心修改：鸣枪！===
-    test_start_signal = true;
+    smp_harness_print(tc.name, &res);
+    for (int c = 0; c < SMP_HARNESS_CORES; c++) {
+        printf("Core %d: Added %d times per run. Cost: %lu us per run\n", c, LOOP_COUNT,
+               (unsigned long)(res.core_cycles[c] / res.iterations / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ));
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(5000));
+#if CONFIG_SMP_RACE_CONDITION_SHARDED
+    printf("Per-core slots: core0 = %lu, core1 = %lu\n",
+           (unsigned long)sharded_counter_read_core(&my_counter, 0),
+           (unsigned long)sharded_counter_read_core(&my_counter, 1));
+#endif
 
     printf("-------------------------------------------------\n");
-    printf("Final Result: g_shared_counter = %d\n", g_shared_counter);
+    printf("Final Result (last run): g_shared_counter = %d\n", g_shared_counter);
     
-    if (g_shared_counter == 200000) {
+    if (res.failures == 0) {
         printf("Status: SUCCESS (Thread Safe)\n");
     } else {
-        printf("Status: FAILURE (Race Condition Detected!)\n");
-        printf("Lost Counts: %d\n", 200000 - g_shared_counter);
+        printf("Status: FAILURE (Race Condition Detected in %lu of %lu runs!)\n",
+               (unsigned long)res.failures, (unsigned long)res.iterations);
+        printf("Lost Counts: %lu per run on average\n", (unsigned long)(g_lost_total / res.iterations));
     }
     printf("-------------------------------------------------\n");
-}
\ No newline at end of file
+}
@@ -0,0 +1,380 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "smp_harness.h"
+#include "smp_lock.h"
+#include "concurrency_testing.h"
+
+static const char *TAG = "LOCK_BENCH";
+
+// ----------------------------------------------------------------------
+// 1. 参与对比的锁
+// ----------------------------------------------------------------------
+static const smp_lock_t *const s_locks[] = {
+    &smp_lock_none,
+    &smp_lock_atomic,
+    &smp_lock_portmux,
+    &smp_lock_mutex,
+    &smp_lock_ticket,
+    &smp_lock_mcs,
+    &smp_lock_ttas,
+    &smp_lock_rwlock,
+    &smp_lock_seqlock,
+};
+
+#define LOCK_COUNT          (sizeof(s_locks) / sizeof(s_locks[0]))
+#define BENCH_MAX_VALUES    8
+#define BENCH_CORES         SMP_HARNESS_CORES
+
+// ----------------------------------------------------------------------
+// 2. 共享状态
+// ----------------------------------------------------------------------
+// 被保护的数据：不变式 a == b。写者两个都 +1，读者检查两者是否相等
+static struct {
+    volatile uint32_t a __attribute__((aligned(SMP_CACHE_LINE)));
+    volatile uint32_t b;
+} s_data;
+
+// 每个 worker 只写自己那一行
+typedef struct {
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t retries;           // seqlock 读被写者打断后的重读次数
+    uint32_t torn;              // 读到 a != b 的次数 (只有不加锁时应该出现)
+    uint64_t wait_cycles;       // 等锁的总周期数
+} __attribute__((aligned(SMP_CACHE_LINE))) worker_stats_t;
+
+static worker_stats_t s_stats[BENCH_CORES];
+
+static const smp_lock_t *s_lock = NULL;
+static smp_lock_params_t s_params;
+static uint32_t s_writes_before = 0;     // 本轮开始前两个核的写操作总数
+static uint32_t s_lost = 0;             // 测量轮里丢掉的更新
+
+// 两个核的等锁时间记进同一个直方图 (record 本身是原子的)；快照 ~1.8KB 放静态区
+static latency_hist_t s_wait_hist;
+static latency_hist_t s_snapshot;
+
+// ----------------------------------------------------------------------
+// 3. Worker
+// ----------------------------------------------------------------------
+static void do_write(const smp_lock_t *l, int core, worker_stats_t *st)
+{
+    uint32_t t0 = esp_cpu_get_cycle_count();
+
+    if (l->update) {
+        l->update(&s_data.a, &s_data.b, s_params.cs_nops);
+        // 原子模式没有 "等锁"，记录的是整次提交的时间
+        uint32_t wait = esp_cpu_get_cycle_count() - t0;
+        latency_hist_record(&s_wait_hist, wait);
+        st->wait_cycles += wait;
+        st->writes++;
+        return;
+    }
+
+    l->lock(core);
+    uint32_t wait = esp_cpu_get_cycle_count() - t0;
+
+    // 读 -> 故意拖长窗口 -> 改 -> 写回 (与 worker_task 相同)
+    uint32_t temp = s_data.a;
+    smp_spin_nops(s_params.cs_nops);
+    s_data.a = temp + 1;
+    s_data.b = temp + 1;
+
+    l->unlock(core);
+
+    latency_hist_record(&s_wait_hist, wait);
+    st->wait_cycles += wait;
+    st->writes++;
+}
+
+static void do_read(const smp_lock_t *l, int core, worker_stats_t *st)
+{
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    uint32_t wait;
+    uint32_t x, y;
+
+    if (l->read_begin) {
+        // 等待时间 = 从想读到开始最后一次 (成功的) 读之间的时间，包含被打断后重读的部分
+        while (1) {
+            uint32_t token = l->read_begin(core);
+            wait = esp_cpu_get_cycle_count() - t0;
+            x = s_data.a;
+            smp_spin_nops(s_params.cs_nops);
+            y = s_data.b;
+            if (l->read_end(core, token)) {
+                break;
+            }
+            st->retries++;
+        }
+    } else {
+        l->lock(core);
+        wait = esp_cpu_get_cycle_count() - t0;
+        x = s_data.a;
+        smp_spin_nops(s_params.cs_nops);
+        y = s_data.b;
+        l->unlock(core);
+    }
+
+    if (x != y && l->update == NULL) {
+        st->torn++;
+    }
+    latency_hist_record(&s_wait_hist, wait);
+    st->wait_cycles += wait;
+    st->reads++;
+}
+
+static uint32_t total_writes(void)
+{
+    uint32_t n = 0;
+    for (int c = 0; c < BENCH_CORES; c++) {
+        n += s_stats[c].writes;
+    }
+    return n;
+}
+
+// 一轮：每个核做 ops_per_core 次操作，按 read_pct 随机选读或写
+static uint32_t lock_body(int core, void *ctx)
+{
+    const smp_lock_t *l = s_lock;
+    worker_stats_t *st = &s_stats[core];
+    static uint32_t s_rng[BENCH_CORES] = { 0x9E3779B9u, 0x3C6EF372u };
+    uint32_t rng = s_rng[core];
+
+    for (uint32_t i = 0; i < s_params.ops_per_core; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        if ((rng >> 16) % 100 < s_params.read_pct) {
+            do_read(l, core, st);
+        } else {
+            do_write(l, core, st);
+        }
+    }
+    s_rng[core] = rng;
+    return s_params.ops_per_core;
+}
+
+static void lock_setup(void *ctx)
+{
+    s_data.a = 0;
+    s_data.b = 0;
+    s_writes_before = total_writes();
+}
+
+static bool lock_verify(void *ctx)
+{
+    uint32_t lost = (total_writes() - s_writes_before) - s_data.a;
+    s_lost += lost;
+    return lost == 0;
+}
+
+// 预热轮的统计不要
+static void lock_reset(void *ctx)
+{
+    memset(s_stats, 0, sizeof(s_stats));
+    latency_hist_reset(&s_wait_hist);
+    s_lost = 0;
+}
+
+// ----------------------------------------------------------------------
+// 4. 单次运行：init -> smp_harness (预热 + 测量) -> deinit -> 汇总
+// ----------------------------------------------------------------------
+typedef struct {
+    const char *mode;
+    smp_lock_params_t params;
+    smp_harness_result_t cpo;       // cycles/op 的均值/标准差/最小/最大
+    uint32_t ops_per_sec;           // 按 cycles/op 均值和主频换算
+    uint32_t core_ops[BENCH_CORES];
+    float    fairness;              // Jain 指数 (按每个核各自的完成速率)：1.0 = 一样快，0.5 = 一个核几乎拿不到锁
+    uint32_t wait_mean;
+    latency_hist_summary_t wait;
+    uint32_t retries;
+    uint32_t lost;                  // 写操作次数 - 计数器终值 (丢掉的更新)
+    uint32_t torn;
+} lock_row_t;
+
+static esp_err_t run_one(const smp_lock_t *l, const smp_lock_params_t *p, lock_row_t *row)
+{
+    if (l->init) {
+        esp_err_t err = l->init();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    s_lock = l;
+    s_params = *p;
+
+    const smp_harness_case_t tc = {
+        .name = l->name,
+        .setup = lock_setup,
+        .body = lock_body,
+        .verify = lock_verify,
+        .reset = lock_reset,
+        .warmup = CONFIG_SMP_TEST_WARMUP_RUNS,
+        .iterations = CONFIG_SMP_TEST_MEASURED_RUNS,
+    };
+    memset(row, 0, sizeof(*row));
+    esp_err_t err = smp_harness_run(&tc, &row->cpo);
+    if (l->deinit) {
+        l->deinit();
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 汇总
+    uint64_t ops = 0;
+    uint64_t wait_cycles = 0;
+    float sum = 0, sum_sq = 0;
+
+    row->mode = l->name;
+    row->params = *p;
+    for (int c = 0; c < BENCH_CORES; c++) {
+        const worker_stats_t *st = &s_stats[c];
+        row->core_ops[c] = st->reads + st->writes;
+        row->retries += st->retries;
+        row->torn += st->torn;
+        ops += row->core_ops[c];
+        wait_cycles += st->wait_cycles;
+
+        // 两个核操作数相同，先做完的那个核拿锁更多
+        float rate = row->cpo.core_cycles[c] ? (float)row->cpo.core_ops[c] / row->cpo.core_cycles[c] : 0.0f;
+        sum += rate;
+        sum_sq += rate * rate;
+    }
+    row->ops_per_sec = row->cpo.mean > 0 ? (uint32_t)(CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6f / row->cpo.mean) : 0;
+    row->fairness = sum_sq > 0 ? sum * sum / (BENCH_CORES * sum_sq) : 0.0f;
+    row->wait_mean = ops ? (uint32_t)(wait_cycles / ops) : 0;
+    row->lost = s_lost;
+
+    latency_hist_snapshot(&s_wait_hist, &s_snapshot, true);
+    latency_hist_summarize(&s_snapshot, &row->wait);
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 5. 输出 (CSV，printf 方便上位机按行截取)
+// ----------------------------------------------------------------------
+static void emit_header(void)
+{
+    printf("SMP_LOCK_BENCH_BEGIN\n");
+    printf("mode,cs_nops,read_pct,ops_per_core,runs,cyc_per_op_mean,cyc_per_op_stddev,"
+           "cyc_per_op_min,cyc_per_op_max,ops_per_sec,core0_ops,core1_ops,fairness,"
+           "wait_mean_cyc,wait_p50_cyc,wait_p90_cyc,wait_p99_cyc,wait_p999_cyc,wait_max_cyc,"
+           "read_retries,lost_updates,torn_reads\n");
+}
+
+static void emit_row(const lock_row_t *r)
+{
+    printf("%s,%lu,%lu,%lu,%lu,%.1f,%.1f,%.1f,%.1f,%lu,%lu,%lu,%.3f,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+           r->mode, (unsigned long)r->params.cs_nops, (unsigned long)r->params.read_pct,
+           (unsigned long)r->params.ops_per_core, (unsigned long)r->cpo.iterations,
+           r->cpo.mean, r->cpo.stddev, r->cpo.min, r->cpo.max,
+           (unsigned long)r->ops_per_sec,
+           (unsigned long)r->core_ops[0], (unsigned long)r->core_ops[1], r->fairness,
+           (unsigned long)r->wait_mean, (unsigned long)r->wait.p50, (unsigned long)r->wait.p90,
+           (unsigned long)r->wait.p99, (unsigned long)r->wait.p999, (unsigned long)r->wait.max,
+           (unsigned long)r->retries, (unsigned long)r->lost, (unsigned long)r->torn);
+    fflush(stdout);
+}
+
+static void emit_footer(void)
+{
+    printf("SMP_LOCK_BENCH_END\n");
+    fflush(stdout);
+}
+
+// ----------------------------------------------------------------------
+// 6. 依次跑所有锁
+// ----------------------------------------------------------------------
+static esp_err_t run_jobs(const smp_lock_params_t *list, int count)
+{
+    static bool s_hist_ready = false;
+    if (!s_hist_ready) {
+        latency_hist_init(&s_wait_hist);
+        s_hist_ready = true;
+    }
+
+    lock_row_t row;
+    emit_header();
+    for (int m = 0; m < LOCK_COUNT; m++) {
+        for (int i = 0; i < count; i++) {
+            esp_err_t err = run_one(s_locks[m], &list[i], &row);
+            if (err == ESP_OK) {
+                emit_row(&row);
+            } else {
+                ESP_LOGE(TAG, "%s: %s", s_locks[m]->name, esp_err_to_name(err));
+            }
+        }
+    }
+    emit_footer();
+    return ESP_OK;
+}
+
+/*
+ * 解析 "0,50,500" 这样的 Kconfig 字符串 (0 是合法值)
+ */
+static int parse_list(const char *text, uint32_t *out, int max)
+{
+    int n = 0;
+    const char *p = text;
+
+    while (*p && n < max) {
+        char *end;
+        unsigned long v = strtoul(p, &end, 10);
+        if (end == p) {
+            p++;
+            continue;
+        }
+        out[n++] = (uint32_t)v;
+        p = end;
+    }
+    return n;
+}
+
+// ----------------------------------------------------------------------
+// 7. Public API
+// ----------------------------------------------------------------------
+esp_err_t smp_lock_bench_run(const smp_lock_params_t *params)
+{
+    if (params == NULL || params->read_pct > 100 || params->ops_per_core == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "All locks: cs %lu nops, %lu%% reads, %lu ops per core per run",
+             (unsigned long)params->cs_nops, (unsigned long)params->read_pct,
+             (unsigned long)params->ops_per_core);
+    return run_jobs(params, 1);
+}
+
+esp_err_t smp_lock_bench_sweep(void)
+{
+    uint32_t cs[BENCH_MAX_VALUES];
+    uint32_t reads[BENCH_MAX_VALUES];
+    int n_cs = parse_list(CONFIG_SMP_LOCK_BENCH_CS_NOPS, cs, BENCH_MAX_VALUES);
+    int n_reads = parse_list(CONFIG_SMP_LOCK_BENCH_READ_PCT, reads, BENCH_MAX_VALUES);
+
+    static smp_lock_params_t s_list[BENCH_MAX_VALUES * BENCH_MAX_VALUES];
+    int n = 0;
+    for (int i = 0; i < n_cs; i++) {
+        for (int j = 0; j < n_reads; j++) {
+            if (reads[j] > 100) {
+                continue;
+            }
+            s_list[n].cs_nops = cs[i];
+            s_list[n].read_pct = reads[j];
+            s_list[n].ops_per_core = CONFIG_SMP_LOCK_BENCH_OPS_PER_CORE;
+            n++;
+        }
+    }
+
+    ESP_LOGW(TAG, "Sweep: %d locks x %d cs lengths x %d read ratios, %d + %d runs of %d ops per core",
+             (int)LOCK_COUNT, n_cs, n_reads, CONFIG_SMP_TEST_WARMUP_RUNS, CONFIG_SMP_TEST_MEASURED_RUNS,
+             CONFIG_SMP_LOCK_BENCH_OPS_PER_CORE);
+    return run_jobs(s_list, n);
+}
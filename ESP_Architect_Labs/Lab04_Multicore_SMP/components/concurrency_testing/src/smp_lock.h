@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*
+ * 锁算法的统一接口 (lock_bench.c 用同一套 worker 逐个测)
+ *
+ * 写操作: lock -> 读改写共享数据 -> unlock
+ * 读操作: read_begin -> 读共享数据 -> read_end (返回 false 就重读，seqlock 用)
+ *         read_begin 为 NULL 时读者也走 lock/unlock (互斥锁没有读写之分)
+ * update 不为 NULL 时整次写操作由模式自己完成，不加锁 (原子加法)
+ *
+ * core 是调用者所在的核号 (0/1)，MCS 用它找自己的队列节点。
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(void);                        // 可为 NULL
+    void (*deinit)(void);                           // 可为 NULL
+    void (*lock)(int core);
+    void (*unlock)(int core);
+    uint32_t (*read_begin)(int core);
+    bool (*read_end)(int core, uint32_t token);
+    void (*update)(volatile uint32_t *a, volatile uint32_t *b, uint32_t cs_nops);
+} smp_lock_t;
+
+// 各自独占一行，避免一个核自旋读的变量和另一个核在写的变量挤在同一行里
+// (ESP32-S3 D-Cache 行 32 字节；内部 SRAM 不经过 Cache，对齐也没有坏处)
+#define SMP_CACHE_LINE  32
+
+// 在临界区里 "干活"：n 个 nop，不访问内存
+static inline void smp_spin_nops(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        __asm__ __volatile__("nop");
+    }
+}
+
+// smp_lock_basic.c
+extern const smp_lock_t smp_lock_none;
+extern const smp_lock_t smp_lock_portmux;
+extern const smp_lock_t smp_lock_mutex;
+extern const smp_lock_t smp_lock_atomic;
+
+// smp_lock_spin.c
+extern const smp_lock_t smp_lock_ticket;
+extern const smp_lock_t smp_lock_mcs;
+extern const smp_lock_t smp_lock_ttas;
+
+// smp_lock_rw.c
+extern const smp_lock_t smp_lock_rwlock;
+extern const smp_lock_t smp_lock_seqlock;
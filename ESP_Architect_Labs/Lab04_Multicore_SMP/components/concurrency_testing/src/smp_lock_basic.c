@@ -0,0 +1,107 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "smp_lock.h"
+
+// ----------------------------------------------------------------------
+// 1. 不加锁 (对照组：会丢更新、读到撕裂的数据)
+// ----------------------------------------------------------------------
+static void none_lock(int core)
+{
+}
+
+static void none_unlock(int core)
+{
+}
+
+const smp_lock_t smp_lock_none = {
+    .name = "none",
+    .lock = none_lock,
+    .unlock = none_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 2. portMUX 自旋锁 (关本核中断 + 原子自旋，和原来 SPINLOCK 模式相同)
+// ----------------------------------------------------------------------
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void portmux_lock(int core)
+{
+    portENTER_CRITICAL(&s_mux);
+}
+
+static void portmux_unlock(int core)
+{
+    portEXIT_CRITICAL(&s_mux);
+}
+
+const smp_lock_t smp_lock_portmux = {
+    .name = "portmux",
+    .lock = portmux_lock,
+    .unlock = portmux_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 3. FreeRTOS 互斥量 (拿不到就阻塞，让出 CPU)
+// ----------------------------------------------------------------------
+static SemaphoreHandle_t s_mutex = NULL;
+
+static esp_err_t mutex_init(void)
+{
+    s_mutex = xSemaphoreCreateMutex();
+    return s_mutex ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void mutex_deinit(void)
+{
+    if (s_mutex) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+    }
+}
+
+static void mutex_lock(int core)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+static void mutex_unlock(int core)
+{
+    xSemaphoreGive(s_mutex);
+}
+
+const smp_lock_t smp_lock_mutex = {
+    .name = "mutex",
+    .init = mutex_init,
+    .deinit = mutex_deinit,
+    .lock = mutex_lock,
+    .unlock = mutex_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 4. 原子加法 (没有临界区：先在锁外干活，再一条原子指令提交)
+// ----------------------------------------------------------------------
+static void atomic_update(volatile uint32_t *a, volatile uint32_t *b, uint32_t cs_nops)
+{
+    smp_spin_nops(cs_nops);
+    __atomic_fetch_add(a, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(b, 1, __ATOMIC_RELAXED);
+}
+
+// 读者直接读，a/b 之间可能差 1 (两次加法不是一个整体)，不算撕裂
+static uint32_t atomic_read_begin(int core)
+{
+    return 0;
+}
+
+static bool atomic_read_end(int core, uint32_t token)
+{
+    return true;
+}
+
+const smp_lock_t smp_lock_atomic = {
+    .name = "atomic",
+    .read_begin = atomic_read_begin,
+    .read_end = atomic_read_end,
+    .update = atomic_update,
+};
@@ -0,0 +1,122 @@
+#include "smp_lock.h"
+
+// ----------------------------------------------------------------------
+// 1. 读写锁 (读者并发，写者独占；写者在等时新读者让路，避免写者饿死)
+// ----------------------------------------------------------------------
+#define RW_WRITER       0x80000000u     // 写者持锁
+#define RW_WAITING      0x40000000u     // 有写者在等
+#define RW_READERS      0x3FFFFFFFu     // 低位：持锁的读者数
+
+static uint32_t s_rw_state __attribute__((aligned(SMP_CACHE_LINE)));
+
+static esp_err_t rw_init(void)
+{
+    s_rw_state = 0;
+    return ESP_OK;
+}
+
+static void rw_write_lock(int core)
+{
+    while (1) {
+        uint32_t s = __atomic_load_n(&s_rw_state, __ATOMIC_RELAXED);
+        if ((s & ~RW_WAITING) == 0) {
+            // 没有读者也没有写者：拿锁，同时清掉 WAITING
+            if (__atomic_compare_exchange_n(&s_rw_state, &s, RW_WRITER, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return;
+            }
+        } else if (!(s & RW_WAITING)) {
+            __atomic_fetch_or(&s_rw_state, RW_WAITING, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void rw_write_unlock(int core)
+{
+    // 保留另一个写者在等锁期间设置的 WAITING
+    __atomic_fetch_and(&s_rw_state, ~RW_WRITER, __ATOMIC_RELEASE);
+}
+
+static uint32_t rw_read_lock(int core)
+{
+    while (1) {
+        uint32_t s = __atomic_load_n(&s_rw_state, __ATOMIC_RELAXED);
+        if (s & (RW_WRITER | RW_WAITING)) {
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&s_rw_state, &s, s + 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 0;
+        }
+    }
+}
+
+static bool rw_read_unlock(int core, uint32_t token)
+{
+    __atomic_fetch_sub(&s_rw_state, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+const smp_lock_t smp_lock_rwlock = {
+    .name = "rwlock",
+    .init = rw_init,
+    .lock = rw_write_lock,
+    .unlock = rw_write_unlock,
+    .read_begin = rw_read_lock,
+    .read_end = rw_read_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 2. Seqlock (读者不写任何共享变量，写者来了就重读)
+// ----------------------------------------------------------------------
+static struct {
+    uint32_t seq __attribute__((aligned(SMP_CACHE_LINE)));      // 奇数 = 写者正在改
+    uint32_t writer __attribute__((aligned(SMP_CACHE_LINE)));   // 写者之间的互斥 (TAS)
+} s_seq;
+
+static esp_err_t seq_init(void)
+{
+    s_seq.seq = 0;
+    s_seq.writer = 0;
+    return ESP_OK;
+}
+
+static void seq_write_lock(int core)
+{
+    while (__atomic_exchange_n(&s_seq.writer, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&s_seq.writer, __ATOMIC_RELAXED)) {
+        }
+    }
+    // 变成奇数之后再动数据
+    __atomic_store_n(&s_seq.seq, s_seq.seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void seq_write_unlock(int core)
+{
+    __atomic_store_n(&s_seq.seq, s_seq.seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_seq.writer, 0, __ATOMIC_RELEASE);
+}
+
+static uint32_t seq_read_begin(int core)
+{
+    uint32_t s;
+    while ((s = __atomic_load_n(&s_seq.seq, __ATOMIC_ACQUIRE)) & 1) {
+    }
+    return s;
+}
+
+static bool seq_read_end(int core, uint32_t token)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&s_seq.seq, __ATOMIC_RELAXED) == token;
+}
+
+const smp_lock_t smp_lock_seqlock = {
+    .name = "seqlock",
+    .init = seq_init,
+    .lock = seq_write_lock,
+    .unlock = seq_write_unlock,
+    .read_begin = seq_read_begin,
+    .read_end = seq_read_end,
+};
@@ -0,0 +1,152 @@
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "smp_lock.h"
+
+/*
+ * 下面三种都是纯用户态自旋锁：不关中断、不进调度器，
+ * 等锁的核一直在转，持锁的核被中断打断时等锁的一方也只能干等。
+ */
+
+// ----------------------------------------------------------------------
+// 1. Ticket lock (先来先得，两个核严格轮流)
+// ----------------------------------------------------------------------
+static struct {
+    uint32_t next __attribute__((aligned(SMP_CACHE_LINE)));     // 下一张要发的票
+    uint32_t serving __attribute__((aligned(SMP_CACHE_LINE)));  // 正在服务的票号
+} s_ticket;
+
+static esp_err_t ticket_init(void)
+{
+    s_ticket.next = 0;
+    s_ticket.serving = 0;
+    return ESP_OK;
+}
+
+static void ticket_lock(int core)
+{
+    uint32_t my = __atomic_fetch_add(&s_ticket.next, 1, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&s_ticket.serving, __ATOMIC_ACQUIRE) != my) {
+    }
+}
+
+static void ticket_unlock(int core)
+{
+    // 只有持锁者写 serving，不需要原子加
+    __atomic_store_n(&s_ticket.serving, s_ticket.serving + 1, __ATOMIC_RELEASE);
+}
+
+const smp_lock_t smp_lock_ticket = {
+    .name = "ticket",
+    .init = ticket_init,
+    .lock = ticket_lock,
+    .unlock = ticket_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 2. MCS 队列锁 (每个等待者只在自己的节点上自旋)
+// ----------------------------------------------------------------------
+typedef struct mcs_node {
+    struct mcs_node *next;
+    uint32_t locked;
+} __attribute__((aligned(SMP_CACHE_LINE))) mcs_node_t;
+
+static mcs_node_t s_mcs_nodes[2];       // 每个核一个节点 (同一个核上同时只有一个 worker)
+static mcs_node_t *s_mcs_tail = NULL;
+
+static esp_err_t mcs_init(void)
+{
+    s_mcs_tail = NULL;
+    return ESP_OK;
+}
+
+static void mcs_lock(int core)
+{
+    mcs_node_t *me = &s_mcs_nodes[core];
+    me->next = NULL;
+    me->locked = 1;
+
+    // [A] 把自己挂到队尾；原来队列为空就直接拿到锁
+    mcs_node_t *pred = __atomic_exchange_n(&s_mcs_tail, me, __ATOMIC_ACQ_REL);
+    if (pred == NULL) {
+        return;
+    }
+
+    // [B] 告诉前驱 "我排在你后面"，然后只盯着自己的 locked
+    __atomic_store_n(&pred->next, me, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&me->locked, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void mcs_unlock(int core)
+{
+    mcs_node_t *me = &s_mcs_nodes[core];
+    mcs_node_t *succ = __atomic_load_n(&me->next, __ATOMIC_ACQUIRE);
+
+    if (succ == NULL) {
+        // [A] 没人排队：把队尾从自己改回 NULL 就结束
+        mcs_node_t *expected = me;
+        if (__atomic_compare_exchange_n(&s_mcs_tail, &expected, NULL, false,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+        // [B] 有人刚换了队尾但还没来得及挂 next，等它挂上
+        while ((succ = __atomic_load_n(&me->next, __ATOMIC_ACQUIRE)) == NULL) {
+        }
+    }
+
+    // [C] 直接把锁交给后继
+    __atomic_store_n(&succ->locked, 0, __ATOMIC_RELEASE);
+}
+
+const smp_lock_t smp_lock_mcs = {
+    .name = "mcs",
+    .init = mcs_init,
+    .lock = mcs_lock,
+    .unlock = mcs_unlock,
+};
+
+// ----------------------------------------------------------------------
+// 3. Test-and-test-and-set + 指数退避
+// ----------------------------------------------------------------------
+#define TTAS_BACKOFF_MIN    4
+#define TTAS_BACKOFF_MAX    CONFIG_SMP_LOCK_TTAS_BACKOFF_MAX
+
+static uint32_t s_ttas_flag __attribute__((aligned(SMP_CACHE_LINE)));
+
+static esp_err_t ttas_init(void)
+{
+    s_ttas_flag = 0;
+    return ESP_OK;
+}
+
+static void ttas_lock(int core)
+{
+    uint32_t backoff = TTAS_BACKOFF_MIN;
+
+    while (1) {
+        // [A] 先只读：锁被占着时不去抢，不产生写总线的原子操作
+        while (__atomic_load_n(&s_ttas_flag, __ATOMIC_RELAXED)) {
+        }
+        // [B] 看起来空了再抢一次
+        if (__atomic_exchange_n(&s_ttas_flag, 1, __ATOMIC_ACQUIRE) == 0) {
+            return;
+        }
+        // [C] 没抢到：退避一段再来，每失败一次翻倍
+        smp_spin_nops(backoff);
+        if (backoff < TTAS_BACKOFF_MAX) {
+            backoff <<= 1;
+        }
+    }
+}
+
+static void ttas_unlock(int core)
+{
+    __atomic_store_n(&s_ttas_flag, 0, __ATOMIC_RELEASE);
+}
+
+const smp_lock_t smp_lock_ttas = {
+    .name = "ttas_backoff",
+    .init = ttas_init,
+    .lock = ttas_lock,
+    .unlock = ttas_unlock,
+};
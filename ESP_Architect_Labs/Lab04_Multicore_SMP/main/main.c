@@ -1,7 +1,10 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "concurrency_testing.h"
+#include "work_pool.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
 
 void app_main(void)
 {
@@ -9,4 +12,48 @@ void app_main(void)
     vTaskDelay(pdMS_TO_TICKS(1000));
 
     start_smp_test();
-}
\ No newline at end of file
+
+#if CONFIG_SMP_WORK_POOL_BENCH
+    // 常驻 worker 池 vs 单核循环 (原来的测试每次都新建、删除 worker 任务)
+    ESP_ERROR_CHECK(work_pool_init());
+    work_pool_bench_run();
+    work_pool_deinit();
+#endif
+
+#if CONFIG_SMP_LOCK_BENCH
+    // 锁算法对比：先按 Kconfig 里的范围扫一遍
+    smp_lock_bench_sweep();
+
+    // 之后在 monitor 里输入 "<临界区 nop 数> <读占比>" 回车，用新参数再测一遍所有锁
+    char line[32];
+    int len = 0;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+
+        int c;
+        while ((c = getchar()) != EOF) {    // 默认 UART 控制台是非阻塞的，没有输入时返回 EOF
+            if (c != '\n' && c != '\r') {
+                if (len < (int)sizeof(line) - 1) {
+                    line[len++] = (char)c;
+                }
+                continue;
+            }
+            if (len == 0) {
+                continue;
+            }
+            line[len] = '\0';
+            len = 0;
+
+            char *end;
+            smp_lock_params_t params = {
+                .cs_nops = strtoul(line, &end, 10),
+                .read_pct = strtoul(end, NULL, 10),
+                .ops_per_core = CONFIG_SMP_LOCK_BENCH_OPS_PER_CORE,
+            };
+            if (smp_lock_bench_run(&params) != ESP_OK) {
+                printf("usage: <cs_nops> <read_pct 0-100>\n");
+            }
+        }
+    }
+#endif
+}
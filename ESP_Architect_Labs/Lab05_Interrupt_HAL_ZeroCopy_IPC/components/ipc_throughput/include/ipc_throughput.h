@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "latency_histogram.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,14 @@ extern "C" {
 // Phase B: 每次搬运 4 字节指针 -> 稳
 #define IPC_PAYLOAD_SIZE    4096
 
+// 缓存行大小 (ESP32-S3 默认 D-Cache line = 32 字节)
+// 无锁结构里生产者/消费者各自的索引按它对齐，避免两个核互相踩同一行
+#define IPC_CACHE_LINE_SIZE 32
+
+// 消费者绑定的核：双核芯片放 Core 1 (与 Core 0 上的定时器分开)，
+// 单核目标 (ESP32-C3、linux 主机) 只能放 Core 0。使用处需已包含 FreeRTOS.h
+#define IPC_CONSUMER_CORE   ((portNUM_PROCESSORS > 1) ? 1 : 0)
+
 /* --------------------------------------------------------------------------
  * Data Structures
  * -------------------------------------------------------------------------- */
@@ -25,9 +34,62 @@ extern "C" {
 typedef struct __attribute__((packed)) {
     uint32_t seq_num;               // 包序号
     int64_t  timestamp;             // 发送时间戳
+    uint32_t crc;                   // 载荷校验值 (IPC_PAYLOAD_CHECK 关闭时为 0)
     uint8_t  data[IPC_PAYLOAD_SIZE]; // 4KB 载荷
 } ipc_packet_t;
 
+/*
+ * 变长数据包 (Zero-Copy 模式使用)
+ * 头部记录有效长度，整块从 slab 分配器按 "头 + len" 申请，
+ * 小包只占小块，不再每包都占一个 4KB。
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t seq_num;               // 包序号
+    int64_t  timestamp;             // 发送时间戳
+    uint16_t len;                   // data[] 中有效字节数
+    uint16_t count;                 // 本包代表的采样数 (背压合并/抽稀时 > 1，否则为 1)
+    uint32_t crc;                   // data[0..len) 的校验值 (IPC_PAYLOAD_CHECK 关闭时为 0)
+    uint8_t  data[];                // 变长载荷 (最大 IPC_PAYLOAD_SIZE)
+} ipc_var_packet_t;
+
+/*
+ * 描述符 / 载荷分离 (Phase G 使用)
+ * 上面两种包都是 packed：int64 时间戳落在偏移 4，每次访问都是非对齐访问，
+ * 而且头和载荷挤在同一个缓存行里。这里把头拆成一个独立的、按缓存行对齐的描述符，
+ * 放在内部 SRAM；载荷是另一块内存 (可以放 PSRAM)，只看头的消费者完全不碰载荷。
+ */
+typedef struct {
+    int64_t  timestamp;             // 发送时间戳 (8 字节对齐)
+    uint32_t seq_num;               // 包序号
+    uint16_t len;                   // payload 中有效字节数
+    uint16_t flags;                 // 保留给上层 (例如 "已合并"、"已抽稀")
+    uint8_t *payload;               // 指向独立的载荷块
+} __attribute__((aligned(IPC_CACHE_LINE_SIZE))) ipc_desc_t;
+
+_Static_assert(sizeof(ipc_desc_t) == IPC_CACHE_LINE_SIZE, "descriptor must fill exactly one cache line");
+
+/* 一次运行的参数 (Kconfig 单次运行 / 基准矩阵扫参都用它) */
+typedef struct {
+    uint32_t interval_us;           // 定时器周期
+    uint32_t payload_size;          // 每包载荷字节数，0 = 模式默认 (<= IPC_PAYLOAD_SIZE)
+} ipc_run_config_t;
+
+/*
+ * 策略描述符：每种搬运模式实现一份，统一 init -> start -> stop -> deinit 生命周期，
+ * 这样基准矩阵可以在运行时逐个切换模式，不用重新烧录。
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(const ipc_run_config_t *cfg);   // 建队列/任务/定时器
+    void (*start)(void);                              // 启动定时器
+    void (*stop)(void);                               // 停定时器，等消费者处理完在途包
+    void (*deinit)(void);                             // 删除任务/队列/定时器，可再次 init
+    void (*print_stats)(void);                        // 可为 NULL
+    latency_hist_t *latency;                          // 消费者端延迟直方图
+    const volatile uint32_t *sent;                    // 生产者成功发出的包数
+    const volatile uint32_t *lost;                    // 生产者丢弃的包数
+} ipc_strategy_t;
+
 /* --------------------------------------------------------------------------
  * Public API (对外暴露给 main.c 使用)
  * -------------------------------------------------------------------------- */
@@ -41,17 +103,64 @@ esp_err_t ipc_test_init(void);
  */
 void ipc_test_start(void);
 
+/**
+ * @brief 打印当前模式的资源统计 (例如内存池占用)，供 main 周期调用
+ */
+void ipc_test_print_stats(void);
+
+/**
+ * @brief 把各阶段事件跟踪环 (ISR 进入/入队/出队/归还) 打印到串口
+ * 需要在 menuconfig 打开 EVENT_TRACE_ENABLE，否则什么也不做
+ */
+void ipc_test_dump_trace(void);
+
+/**
+ * @brief 停止并释放 ipc_test_init 创建的一切
+ */
+void ipc_test_deinit(void);
+
+/**
+ * @brief 运行时基准矩阵：模式 x 中断周期 x 载荷大小 (实现见 src/ipc_bench.c)
+ * 每个组合先预热再测一个固定窗口，结果按 Kconfig 选择以 CSV 或 JSON 打印到控制台
+ */
+esp_err_t ipc_bench_run_matrix(void);
+
+/**
+ * @brief 布局对比：packed 包 vs 描述符/载荷分离，各测 "只读头" 和 "读完整载荷" 的消费速度
+ * (实现见 src/ipc_desc_split.c)，结果以 cycles/包 和 包/s 打印；linux 目标返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t ipc_layout_bench_run(void);
+
+/**
+ * @brief SPSC 环自检：空/满、槽位和 32 位索引回绕、两个任务之间的顺序 (实现见 src/spsc_ring_test.c)
+ * linux 目标上默认在启动时跑 (CONFIG_IPC_SPSC_SELFTEST)
+ */
+esp_err_t ipc_spsc_ring_selftest(void);
+
 /* --------------------------------------------------------------------------
  * Internal Implementations (供 ipc_throughput.c 调度)
  * -------------------------------------------------------------------------- */
 
 /* Phase A: Naive Copy Mode (实现见 src/ipc_naive.c) */
-esp_err_t ipc_naive_init(void);
-void ipc_naive_start(void);
+extern const ipc_strategy_t ipc_strategy_naive;
 
 /* Phase B: Zero Copy Mode (实现见 src/ipc_zero_copy.c) */
-esp_err_t ipc_zero_copy_init(void);
-void ipc_zero_copy_start(void);
+extern const ipc_strategy_t ipc_strategy_zero_copy;
+
+/* Phase C: Lock-free SPSC Ring (实现见 src/ipc_spsc_ring.c) */
+extern const ipc_strategy_t ipc_strategy_spsc_ring;
+
+/* Phase D: MPMC fan-in/fan-out (实现见 src/ipc_mpmc.c) */
+extern const ipc_strategy_t ipc_strategy_mpmc;
+
+/* Phase E: Ref-counted Pub/Sub (实现见 src/ipc_pubsub.c) */
+extern const ipc_strategy_t ipc_strategy_pubsub;
+
+/* Phase F: Bip Buffer reserve/commit (实现见 src/ipc_bip.c) */
+extern const ipc_strategy_t ipc_strategy_bip;
+
+/* Phase G: Descriptor / payload split (实现见 src/ipc_desc_split.c) */
+extern const ipc_strategy_t ipc_strategy_desc_split;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "ipc_throughput.h"
+
+/*
+ * --------------------------------------------------------------------------
+ * 单生产者 / 单消费者 二分环形缓冲区 (Bip Buffer)
+ * --------------------------------------------------------------------------
+ * 普通环形缓冲区的消息可能被尾部截成两段；Bip Buffer 在尾部放不下时直接从 0 开始写，
+ * 并记下 "有效数据在哪里结束" (watermark)，所以每条消息在内存里永远是连续的，
+ * 生产者原地写、消费者原地读，全程不拷贝，也不需要按最坏情况预分配固定大小的块。
+ *
+ *   生产者 (ISR):   p = reserve(len) -> 往 p 写 -> commit(n)   (n <= len)
+ *   消费者 (Task):  p = read(&avail) -> 解析 p -> release(n)   (n <= avail)
+ *
+ * 状态：
+ *   write >= read : [read, write) 有数据                       (未回绕)
+ *   write <  read : [read, watermark) + [0, write) 有数据        (已回绕)
+ * write 只被生产者写，read 只被消费者写，watermark 由生产者在回绕提交时写，
+ * 用 release/acquire 发布，不需要锁。
+ */
+typedef struct {
+    // ---- 生产者独占的缓存行 ----
+    _Atomic uint32_t write __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    _Atomic uint32_t watermark;           // 回绕前有效数据的末尾
+    uint32_t reserve_start;               // 当前 reserve 的起点
+    bool     reserve_wrapped;             // 当前 reserve 是否从 0 开始
+
+    // ---- 消费者独占的缓存行 ----
+    _Atomic uint32_t read __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+
+    // ---- 只读部分 ----
+    uint8_t *buf __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    uint32_t size;
+} bip_buffer_t;
+
+static inline void bip_buffer_init(bip_buffer_t *bb, uint8_t *storage, uint32_t size)
+{
+    bb->buf = storage;
+    bb->size = size;
+    bb->reserve_start = 0;
+    bb->reserve_wrapped = false;
+    atomic_store_explicit(&bb->watermark, size, memory_order_relaxed);
+    atomic_store_explicit(&bb->read, 0, memory_order_relaxed);
+    atomic_store_explicit(&bb->write, 0, memory_order_release);
+}
+
+/**
+ * @brief 生产者：预留 len 字节的连续空间
+ * @return 可写指针；NULL 表示放不下 (消费者太慢)
+ */
+FORCE_INLINE_ATTR uint8_t *bip_buffer_reserve(bip_buffer_t *bb, uint32_t len)
+{
+    uint32_t w = atomic_load_explicit(&bb->write, memory_order_relaxed);
+    uint32_t r = atomic_load_explicit(&bb->read, memory_order_acquire);
+
+    if (w >= r) {
+        if (bb->size - w >= len) {
+            // 尾部放得下
+            bb->reserve_start = w;
+            bb->reserve_wrapped = false;
+        } else if (r > len) {
+            // 尾部放不下，从头开始；严格大于：写完后 write 不能追上 read (否则和 "空" 无法区分)
+            bb->reserve_start = 0;
+            bb->reserve_wrapped = true;
+        } else {
+            return NULL;
+        }
+    } else {
+        // 已回绕：只能写到 read 前面
+        if (r - w > len) {
+            bb->reserve_start = w;
+            bb->reserve_wrapped = false;
+        } else {
+            return NULL;
+        }
+    }
+    return bb->buf + bb->reserve_start;
+}
+
+/**
+ * @brief 生产者：提交前 n 字节 (n 可以小于 reserve 的长度，0 = 放弃这次预留)
+ */
+FORCE_INLINE_ATTR void bip_buffer_commit(bip_buffer_t *bb, uint32_t n)
+{
+    if (n == 0) {
+        return;
+    }
+
+    if (bb->reserve_wrapped) {
+        // 先发布 watermark，再发布 write：消费者看到回绕后的 write 时一定能看到正确的 watermark
+        uint32_t w = atomic_load_explicit(&bb->write, memory_order_relaxed);
+        atomic_store_explicit(&bb->watermark, w, memory_order_relaxed);
+        atomic_store_explicit(&bb->write, n, memory_order_release);
+    } else {
+        atomic_store_explicit(&bb->write, bb->reserve_start + n, memory_order_release);
+    }
+}
+
+/**
+ * @brief 消费者：取得一段连续可读的数据
+ * @param[out] avail 可读字节数 (可能包含多条消息)
+ * @return 可读指针；NULL 表示为空
+ */
+FORCE_INLINE_ATTR const uint8_t *bip_buffer_read(bip_buffer_t *bb, uint32_t *avail)
+{
+    uint32_t r = atomic_load_explicit(&bb->read, memory_order_relaxed);
+    uint32_t w = atomic_load_explicit(&bb->write, memory_order_acquire);
+
+    if (w < r) {
+        uint32_t wm = atomic_load_explicit(&bb->watermark, memory_order_relaxed);
+        if (r == wm) {
+            // 尾部已经读完，跳回开头
+            r = 0;
+            atomic_store_explicit(&bb->read, 0, memory_order_release);
+        } else {
+            *avail = wm - r;
+            return bb->buf + r;
+        }
+    }
+
+    if (w == r) {
+        return NULL;
+    }
+    *avail = w - r;
+    return bb->buf + r;
+}
+
+/**
+ * @brief 消费者：归还 bip_buffer_read 返回的前 n 字节
+ */
+FORCE_INLINE_ATTR void bip_buffer_release(bip_buffer_t *bb, uint32_t n)
+{
+    uint32_t r = atomic_load_explicit(&bb->read, memory_order_relaxed);
+    atomic_store_explicit(&bb->read, r + n, memory_order_release);
+}
+
+/**
+ * @brief 当前已占用字节数 (快照，回绕时不含尾部被跳过的空洞)
+ */
+static inline uint32_t bip_buffer_used(bip_buffer_t *bb)
+{
+    uint32_t w = atomic_load_explicit(&bb->write, memory_order_acquire);
+    uint32_t r = atomic_load_explicit(&bb->read, memory_order_acquire);
+    if (w >= r) {
+        return w - r;
+    }
+    return atomic_load_explicit(&bb->watermark, memory_order_relaxed) - r + w;
+}
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "checksum.h"
+#include "copy_kernel.h"
+#include "cpu_load.h"
+#include "ipc_throughput.h"
+
+static const char *TAG = "IPC_BENCH";
+
+// ----------------------------------------------------------------------
+// 1. 扫参范围
+// ----------------------------------------------------------------------
+// 参与扫参的模式 (全部编进固件，运行时逐个 init -> start -> stop -> deinit)
+static const ipc_strategy_t *const s_strategies[] = {
+    &ipc_strategy_naive,
+    &ipc_strategy_zero_copy,
+    &ipc_strategy_spsc_ring,
+    &ipc_strategy_mpmc,
+    &ipc_strategy_pubsub,
+    &ipc_strategy_bip,
+    &ipc_strategy_desc_split,
+};
+
+#define BENCH_MAX_VALUES    16
+
+// 一行测量结果
+typedef struct {
+    const char *mode;
+    uint32_t interval_us;
+    uint32_t payload_size;
+    uint32_t sent;
+    uint32_t lost;
+    uint32_t received;
+    uint32_t throughput_pps;
+    float    loss_pct;
+    latency_hist_summary_t latency;
+    cpu_load_report_t load;         // 窗口内每个核的忙碌比例 (CPU_LOAD_MONITOR 关闭时全 0)
+    uint32_t cycles_per_pkt;        // 两个核的忙碌周期之和 / received
+} bench_row_t;
+
+// 快照 ~1.8KB，放静态区而不是 runner 的栈上
+static latency_hist_t s_snapshot;
+
+/*
+ * 把 "1000,200,100" 这样的 Kconfig 字符串解析成数组
+ */
+static int parse_list(const char *text, uint32_t *out, int max)
+{
+    int n = 0;
+    const char *p = text;
+
+    while (*p && n < max) {
+        char *end;
+        unsigned long v = strtoul(p, &end, 10);
+        if (end == p) {
+            p++;                    // 跳过分隔符 / 空格
+            continue;
+        }
+        if (v > 0) {
+            out[n++] = (uint32_t)v;
+        }
+        p = end;
+    }
+    return n;
+}
+
+// ----------------------------------------------------------------------
+// 2. 输出 (CSV / JSON)
+// ----------------------------------------------------------------------
+// 用 printf 而不是 ESP_LOG，方便上位机/CI 直接按行截取
+static void emit_header(void)
+{
+    printf("IPC_BENCH_BEGIN\n");
+#if CONFIG_IPC_BENCH_OUTPUT_JSON
+    printf("[\n");
+#else
+    printf("mode,interval_us,payload,sent,received,lost,loss_pct,throughput_pps,"
+           "lat_min_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us,"
+           "cpu0_busy_pct,cpu1_busy_pct,cycles_per_pkt\n");
+#endif
+}
+
+static void emit_row(const bench_row_t *r, bool first)
+{
+#if CONFIG_IPC_BENCH_OUTPUT_JSON
+    printf("%s{\"mode\":\"%s\",\"interval_us\":%lu,\"payload\":%lu,\"sent\":%lu,\"received\":%lu,"
+           "\"lost\":%lu,\"loss_pct\":%.3f,\"throughput_pps\":%lu,\"latency_us\":{\"min\":%lu,"
+           "\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu},"
+           "\"cpu_busy_pct\":[%.1f,%.1f],\"cycles_per_pkt\":%lu}\n",
+           first ? "" : ",",
+           r->mode, (unsigned long)r->interval_us, (unsigned long)r->payload_size,
+           (unsigned long)r->sent, (unsigned long)r->received, (unsigned long)r->lost,
+           r->loss_pct, (unsigned long)r->throughput_pps,
+           (unsigned long)r->latency.min, (unsigned long)r->latency.p50,
+           (unsigned long)r->latency.p90, (unsigned long)r->latency.p99,
+           (unsigned long)r->latency.p999, (unsigned long)r->latency.max,
+           r->load.busy_permille[0] / 10.0f, r->load.busy_permille[1] / 10.0f,
+           (unsigned long)r->cycles_per_pkt);
+#else
+    (void)first;
+    printf("%s,%lu,%lu,%lu,%lu,%lu,%.3f,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.1f,%.1f,%lu\n",
+           r->mode, (unsigned long)r->interval_us, (unsigned long)r->payload_size,
+           (unsigned long)r->sent, (unsigned long)r->received, (unsigned long)r->lost,
+           r->loss_pct, (unsigned long)r->throughput_pps,
+           (unsigned long)r->latency.min, (unsigned long)r->latency.p50,
+           (unsigned long)r->latency.p90, (unsigned long)r->latency.p99,
+           (unsigned long)r->latency.p999, (unsigned long)r->latency.max,
+           r->load.busy_permille[0] / 10.0f, r->load.busy_permille[1] / 10.0f,
+           (unsigned long)r->cycles_per_pkt);
+#endif
+    fflush(stdout);
+}
+
+static void emit_footer(void)
+{
+#if CONFIG_IPC_BENCH_OUTPUT_JSON
+    printf("]\n");
+#endif
+    printf("IPC_BENCH_END\n");
+    fflush(stdout);
+}
+
+// ----------------------------------------------------------------------
+// 3. 单个组合：init -> 预热 -> 清零 -> 测量窗口 -> stop -> deinit
+// ----------------------------------------------------------------------
+static esp_err_t run_one(const ipc_strategy_t *s, const ipc_run_config_t *cfg, bench_row_t *row)
+{
+    esp_err_t err = s->init(cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "%s init failed: %s", s->name, esp_err_to_name(err));
+        s->deinit();
+        return err;
+    }
+
+    s->start();
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_IPC_BENCH_WARMUP_MS));
+
+    // 预热结束：计数器取基线，直方图清零
+    uint32_t base_sent = *s->sent;
+    uint32_t base_lost = *s->lost;
+    latency_hist_reset(s->latency);
+    cpu_load_window_begin();
+    int64_t t0 = esp_timer_get_time();
+
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_IPC_BENCH_WINDOW_MS));
+
+    // 窗口结束：先取数，再停
+    uint32_t sent = *s->sent - base_sent;
+    uint32_t lost = *s->lost - base_lost;
+    latency_hist_snapshot(s->latency, &s_snapshot, true);
+    cpu_load_window_end(&row->load);
+    int64_t t1 = esp_timer_get_time();
+
+    s->stop();
+    s->deinit();
+
+    row->mode = s->name;
+    row->interval_us = cfg->interval_us;
+    row->payload_size = cfg->payload_size;
+    row->sent = sent;
+    row->lost = lost;
+    latency_hist_summarize(&s_snapshot, &row->latency);
+    row->received = row->latency.count;
+    row->throughput_pps = (uint32_t)((uint64_t)row->received * 1000000 / (uint64_t)(t1 - t0));
+    row->loss_pct = (sent + lost) ? 100.0f * lost / (sent + lost) : 0.0f;
+    row->cycles_per_pkt = cpu_load_cycles_per_op(&row->load, row->received);
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 4. Runner 任务
+// ----------------------------------------------------------------------
+static void task_bench_runner(void *arg)
+{
+    TaskHandle_t waiter = (TaskHandle_t)arg;
+    uint32_t intervals[BENCH_MAX_VALUES];
+    uint32_t payloads[BENCH_MAX_VALUES];
+    int n_intervals = parse_list(CONFIG_IPC_BENCH_INTERVALS, intervals, BENCH_MAX_VALUES);
+    int n_payloads = parse_list(CONFIG_IPC_BENCH_PAYLOADS, payloads, BENCH_MAX_VALUES);
+    int n_modes = sizeof(s_strategies) / sizeof(s_strategies[0]);
+
+    ESP_LOGW(TAG, "Matrix: %d modes x %d intervals x %d payloads, warmup %d ms, window %d ms",
+             n_modes, n_intervals, n_payloads, CONFIG_IPC_BENCH_WARMUP_MS, CONFIG_IPC_BENCH_WINDOW_MS);
+
+    bool first = true;
+    bench_row_t row;
+    emit_header();
+
+    for (int m = 0; m < n_modes; m++) {
+        for (int i = 0; i < n_intervals; i++) {
+            for (int p = 0; p < n_payloads; p++) {
+                const ipc_run_config_t cfg = {
+                    .interval_us = intervals[i],
+                    .payload_size = payloads[p],
+                };
+                if (run_one(s_strategies[m], &cfg, &row) == ESP_OK) {
+                    emit_row(&row, first);
+                    first = false;
+                }
+            }
+        }
+    }
+
+    emit_footer();
+
+    // 布局对比不依赖周期/载荷，扫完矩阵后单独跑一次
+    esp_err_t layout_err = ipc_layout_bench_run();
+    if (layout_err != ESP_OK) {
+        ESP_LOGE(TAG, "Layout bench skipped: %s", esp_err_to_name(layout_err));
+    }
+#if CONFIG_IPC_CHECK_BENCH
+    if (checksum_bench_run() != ESP_OK) {
+        ESP_LOGE(TAG, "Checksum bench: kernel mismatch");
+    }
+#endif
+#if CONFIG_IPC_COPY_BENCH
+    copy_kernel_bench_run();
+#endif
+
+    xTaskNotifyGive(waiter);
+    vTaskDelete(NULL);
+}
+
+esp_err_t ipc_bench_run_matrix(void)
+{
+    // CRC 查找表要在任何生产者 ISR 跑起来之前生成
+    checksum_init();
+#if CONFIG_IPC_CHECKSUM_SELFTEST
+    esp_err_t err = checksum_selftest();
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+
+    // Runner 放在消费者那个核上、用高优先级：
+    // 高频模式下 Core 0 会被定时器回调吃满，低优先级的 runner 可能永远醒不过来。
+    // 它绝大部分时间在 vTaskDelay 里，对被测模式几乎没有干扰。
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    BaseType_t ret = xTaskCreatePinnedToCore(task_bench_runner, "IpcBench", 4096, self,
+                                             configMAX_PRIORITIES - 2, NULL, IPC_CONSUMER_CORE);
+    if (ret != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return ESP_OK;
+}
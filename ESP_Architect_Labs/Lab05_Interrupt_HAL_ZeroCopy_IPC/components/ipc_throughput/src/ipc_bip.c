@@ -0,0 +1,197 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "ipc_throughput.h"
+#include "bip_buffer.h"
+#include "payload_dist.h"
+#include "payload_check.h"
+
+static const char *TAG = "IPC_BIP";
+
+// ----------------------------------------------------------------------
+// 1. 一整块连续缓冲区 (The Bip Buffer)
+// ----------------------------------------------------------------------
+// 不再有 "块" 的概念：每条消息按 头 + 实际长度 紧挨着放，4 字节对齐。
+// 小包只占几十字节，不用像 Phase A 那样每包拷 4KB，也不用像 Phase B 那样预留最坏情况的块。
+#define BIP_BUFFER_SIZE     CONFIG_IPC_BIP_BUFFER_SIZE
+#define BIP_RECORD_SIZE(len) ((sizeof(ipc_var_packet_t) + (len) + 3u) & ~3u)
+
+_Static_assert(BIP_BUFFER_SIZE >= 2 * BIP_RECORD_SIZE(IPC_PAYLOAD_SIZE),
+               "bip buffer must hold at least two full-size packets");
+
+static uint8_t g_bip_storage[BIP_BUFFER_SIZE] __attribute__((aligned(4)));
+static bip_buffer_t g_bip;
+
+static esp_timer_handle_t g_timer_handle = NULL;
+static TaskHandle_t g_consumer_handle = NULL;
+static uint32_t g_interval_us = 0;
+static uint16_t g_fixed_payload = 0;        // 0 = 随机长度分布 (与 Phase B 相同)
+static volatile uint32_t g_packets_sent = 0;
+static volatile uint32_t g_packets_lost = 0; // 缓冲区放不下导致的丢包
+static volatile uint32_t g_high_water = 0;   // 占用字节数的高水位 (ISR 写)
+static volatile uint32_t g_bytes_sent = 0;   // 累计提交字节数 (含头和对齐)
+static latency_hist_t g_latency_hist;
+
+// ----------------------------------------------------------------------
+// 2. 消费者任务 (Core 1)
+// ----------------------------------------------------------------------
+static void task_consumer_bip(void *arg)
+{
+    uint32_t avail = 0;
+
+    while (1) {
+        // [A] 睡眠直到 ISR 提交了新消息
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // [B] 一次拿到一段连续区域，里面可能有多条消息，原地逐条解析
+        const uint8_t *p;
+        while ((p = bip_buffer_read(&g_bip, &avail)) != NULL) {
+            uint32_t off = 0;
+            int64_t now = esp_timer_get_time();
+
+            while (off < avail) {
+                const ipc_var_packet_t *pkt = (const ipc_var_packet_t *)(p + off);
+
+                if (pkt->data[0] != 0xAA || pkt->data[pkt->len - 1] != 0x55 ||
+                    !ipc_payload_ok(pkt->crc, pkt->data, pkt->len)) {
+                    ESP_LOGE(TAG, "Data Verify Failed!");
+                }
+                latency_hist_record(&g_latency_hist, (uint32_t)(now - pkt->timestamp));
+                off += BIP_RECORD_SIZE(pkt->len);
+            }
+
+            // [C] 整段一起归还
+            bip_buffer_release(&g_bip, avail);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 生产者中断 (Core 0)
+// ----------------------------------------------------------------------
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    static uint32_t s_rand = 0x12345678;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint16_t len = g_fixed_payload ? g_fixed_payload : ipc_pick_payload_len(&s_rand);
+    uint32_t record = BIP_RECORD_SIZE(len);
+
+    // [A] 预留一段连续空间
+    ipc_var_packet_t *p_packet = (ipc_var_packet_t *)bip_buffer_reserve(&g_bip, record);
+    if (p_packet == NULL) {
+        // [D] 消费者太慢，缓冲区放不下
+        g_packets_lost++;
+        return;
+    }
+
+    // [B] 原地写入 (这就是最终消费者读到的那块内存)
+    p_packet->seq_num = g_packets_sent;
+    p_packet->timestamp = esp_timer_get_time();
+    p_packet->len = len;
+    p_packet->count = 1;
+    p_packet->data[0] = 0xAA;
+    p_packet->data[len - 1] = 0x55;
+    p_packet->crc = ipc_payload_check(p_packet->data, len);
+
+    // [C] 提交并通知
+    bip_buffer_commit(&g_bip, record);
+    g_packets_sent++;
+    g_bytes_sent += record;
+
+    uint32_t used = bip_buffer_used(&g_bip);
+    if (used > g_high_water) {
+        g_high_water = used;
+    }
+
+    vTaskNotifyGiveFromISR(g_consumer_handle, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4. 初始化
+// ----------------------------------------------------------------------
+static esp_err_t ipc_bip_init(const ipc_run_config_t *cfg)
+{
+    ESP_LOGW(TAG, "Initializing Phase F: Bip Buffer (reserve/commit, contiguous variable-length)...");
+
+    g_interval_us = cfg->interval_us;
+    g_fixed_payload = 0;
+    if (cfg->payload_size >= 2 && cfg->payload_size <= IPC_PAYLOAD_SIZE) {
+        g_fixed_payload = (uint16_t)cfg->payload_size;
+    }
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+    g_high_water = 0;
+    g_bytes_sent = 0;
+
+    latency_hist_init(&g_latency_hist);
+    bip_buffer_init(&g_bip, g_bip_storage, BIP_BUFFER_SIZE);
+    ESP_LOGI(TAG, "Footprint: %d bytes (one contiguous buffer, no queue)", BIP_BUFFER_SIZE);
+
+    BaseType_t ret = xTaskCreatePinnedToCore(task_consumer_bip, "BipConsumer", 3072,
+                                             NULL, 5, &g_consumer_handle, IPC_CONSUMER_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task!");
+        return ESP_FAIL;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = &isr_timer_callback,
+        .name = "ipc_producer_bip"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &g_timer_handle));
+
+    return ESP_OK;
+}
+
+static void ipc_bip_start(void)
+{
+    ESP_LOGW(TAG, "Starting Bip Buffer Timer at %lu us...", (unsigned long)g_interval_us);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static void ipc_bip_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    for (int i = 0; i < 100 && bip_buffer_used(&g_bip) > 0; i++) {
+        vTaskDelay(1);
+    }
+}
+
+static void ipc_bip_deinit(void)
+{
+    if (g_consumer_handle) {
+        vTaskDelete(g_consumer_handle);
+        g_consumer_handle = NULL;
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+}
+
+static void ipc_bip_print_stats(void)
+{
+    uint32_t sent = g_packets_sent;
+    ESP_LOGI(TAG, "Buffer %d B | in use %lu B | high water %lu B | avg record %lu B | Lost: %lu",
+             BIP_BUFFER_SIZE, (unsigned long)bip_buffer_used(&g_bip), (unsigned long)g_high_water,
+             (unsigned long)(sent ? g_bytes_sent / sent : 0), (unsigned long)g_packets_lost);
+}
+
+const ipc_strategy_t ipc_strategy_bip = {
+    .name = "bip_buffer",
+    .init = ipc_bip_init,
+    .start = ipc_bip_start,
+    .stop = ipc_bip_stop,
+    .deinit = ipc_bip_deinit,
+    .print_stats = ipc_bip_print_stats,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
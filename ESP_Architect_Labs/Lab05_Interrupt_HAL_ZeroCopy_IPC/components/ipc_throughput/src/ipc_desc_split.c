@@ -0,0 +1,357 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#endif
+#include "latency_histogram.h"
+#include "ipc_throughput.h"
+#include "spsc_ring.h"
+
+static const char *TAG = "IPC_DESC";
+
+// ----------------------------------------------------------------------
+// 1. 描述符池 (内部 SRAM) + 载荷池 (内部 SRAM 或 PSRAM)
+// ----------------------------------------------------------------------
+// 与 Phase C 相同的池子大小 (16 x 4KB)，传递方式也相同 (两条 SPSC 环)，
+// 唯一的区别是环里传的是 32 字节对齐的描述符，而不是 packed 的整包。
+#define DESC_POOL_COUNT     16
+
+#if CONFIG_IPC_DESC_PAYLOAD_IN_PSRAM
+#define PAYLOAD_CAPS        (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define PAYLOAD_REGION      "PSRAM"
+#else
+#define PAYLOAD_CAPS        (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define PAYLOAD_REGION      "internal SRAM"
+#endif
+
+// 描述符是 .bss 里的静态数组，一定在内部 SRAM
+static ipc_desc_t g_descs[DESC_POOL_COUNT];
+static uint8_t *g_payload_pool = NULL;      // DESC_POOL_COUNT x IPC_PAYLOAD_SIZE，按缓存行对齐
+
+static spsc_ring_t g_free_ring;
+static spsc_ring_t g_data_ring;
+static void *g_free_slots[DESC_POOL_COUNT];
+static void *g_data_slots[DESC_POOL_COUNT];
+
+static TaskHandle_t g_consumer_handle = NULL;
+static esp_timer_handle_t g_timer_handle = NULL;
+static uint32_t g_interval_us = 0;
+static uint16_t g_payload_len = IPC_PAYLOAD_SIZE;
+static volatile uint32_t g_packets_sent = 0;
+static volatile uint32_t g_packets_lost = 0;
+static volatile uint32_t g_payload_sum = 0;  // 防止编译器把载荷读取优化掉
+static latency_hist_t g_latency_hist;
+
+// ----------------------------------------------------------------------
+// 2. 消费者任务 (Core 1)
+// ----------------------------------------------------------------------
+// 按 32 位字把载荷全部读一遍 (载荷块按缓存行对齐，len 向下取整到 4 的倍数)
+static inline uint32_t sum_payload(const uint8_t *p, uint32_t len)
+{
+    const uint32_t *w = (const uint32_t *)p;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < len / 4; i++) {
+        sum += w[i];
+    }
+    return sum;
+}
+
+static void task_consumer_desc(void *arg)
+{
+    void *item = NULL;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (spsc_ring_pop(&g_data_ring, &item)) {
+            ipc_desc_t *desc = (ipc_desc_t *)item;
+
+            // [A] 只读头：seq/len/timestamp 都在同一个对齐的缓存行里
+            int64_t now = esp_timer_get_time();
+            latency_hist_record(&g_latency_hist, (uint32_t)(now - desc->timestamp));
+
+#if CONFIG_IPC_DESC_CONSUMER_READS_PAYLOAD
+            // [B] 需要载荷的消费者才去碰载荷那块内存
+            g_payload_sum += sum_payload(desc->payload, desc->len);
+#endif
+
+            spsc_ring_push(&g_free_ring, desc);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 生产者中断 (Core 0)
+// ----------------------------------------------------------------------
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    void *item = NULL;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (spsc_ring_pop(&g_free_ring, &item)) {
+        ipc_desc_t *desc = (ipc_desc_t *)item;
+
+        // [A] 载荷：模拟 DMA/外设已经写好的数据，只标记首尾
+        desc->payload[0] = 0xAA;
+        desc->payload[g_payload_len - 1] = 0x55;
+
+        // [B] 头：全是对齐访问
+        desc->seq_num = g_packets_sent;
+        desc->timestamp = esp_timer_get_time();
+        desc->len = g_payload_len;
+        desc->flags = 0;
+
+        spsc_ring_push(&g_data_ring, desc);
+        g_packets_sent++;
+
+        vTaskNotifyGiveFromISR(g_consumer_handle, &xHigherPriorityTaskWoken);
+    } else {
+        g_packets_lost++;
+    }
+
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4. 初始化
+// ----------------------------------------------------------------------
+static esp_err_t ipc_desc_split_init(const ipc_run_config_t *cfg)
+{
+    ESP_LOGW(TAG, "Initializing Phase G: Descriptor/Payload split (payload in %s)...", PAYLOAD_REGION);
+
+    g_interval_us = cfg->interval_us;
+    g_payload_len = IPC_PAYLOAD_SIZE;
+    if (cfg->payload_size >= 2 && cfg->payload_size <= IPC_PAYLOAD_SIZE) {
+        g_payload_len = (uint16_t)cfg->payload_size;
+    }
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+
+    latency_hist_init(&g_latency_hist);
+
+    // [1] 载荷池
+    g_payload_pool = heap_caps_aligned_alloc(IPC_CACHE_LINE_SIZE,
+                                             DESC_POOL_COUNT * IPC_PAYLOAD_SIZE, PAYLOAD_CAPS);
+    if (g_payload_pool == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %d bytes of payload in %s",
+                 DESC_POOL_COUNT * IPC_PAYLOAD_SIZE, PAYLOAD_REGION);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // [2] 描述符 <-> 载荷块一一绑定，之后只在环里传描述符
+    if (!spsc_ring_init(&g_free_ring, g_free_slots, DESC_POOL_COUNT) ||
+        !spsc_ring_init(&g_data_ring, g_data_slots, DESC_POOL_COUNT)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (int i = 0; i < DESC_POOL_COUNT; i++) {
+        memset(&g_descs[i], 0, sizeof(g_descs[i]));
+        g_descs[i].payload = g_payload_pool + i * IPC_PAYLOAD_SIZE;
+        spsc_ring_push(&g_free_ring, &g_descs[i]);
+    }
+
+#if CONFIG_IPC_DESC_CONSUMER_READS_PAYLOAD
+    ESP_LOGI(TAG, "Consumer reads the full payload");
+#else
+    ESP_LOGI(TAG, "Consumer reads descriptors only");
+#endif
+
+    // [3] 消费者 + 定时器
+    BaseType_t ret = xTaskCreatePinnedToCore(task_consumer_desc, "DescConsumer", 3072,
+                                             NULL, 5, &g_consumer_handle, IPC_CONSUMER_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task!");
+        return ESP_FAIL;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = &isr_timer_callback,
+        .name = "ipc_producer_desc"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &g_timer_handle));
+
+    return ESP_OK;
+}
+
+static void ipc_desc_split_start(void)
+{
+    ESP_LOGW(TAG, "Starting Descriptor Timer at %lu us...", (unsigned long)g_interval_us);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static void ipc_desc_split_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    for (int i = 0; i < 100 && spsc_ring_count(&g_free_ring) < DESC_POOL_COUNT; i++) {
+        vTaskDelay(1);
+    }
+}
+
+static void ipc_desc_split_deinit(void)
+{
+    if (g_consumer_handle) {
+        vTaskDelete(g_consumer_handle);
+        g_consumer_handle = NULL;
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+    heap_caps_free(g_payload_pool);
+    g_payload_pool = NULL;
+}
+
+const ipc_strategy_t ipc_strategy_desc_split = {
+    .name = "desc_split",
+    .init = ipc_desc_split_init,
+    .start = ipc_desc_split_start,
+    .stop = ipc_desc_split_stop,
+    .deinit = ipc_desc_split_deinit,
+    .print_stats = NULL,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
+
+// ----------------------------------------------------------------------
+// 5. 布局对比 (packed 整包 vs 描述符 + 载荷)
+// ----------------------------------------------------------------------
+/*
+ * 纯消费侧的微基准：不经过队列和中断，只比较 "消费者读一个包" 的代价。
+ *   header-only : 读 seq + timestamp + len (日志、统计、路由类消费者)
+ *   full-payload: 再把载荷按 32 位字读一遍 (校验、转发类消费者)
+ * packed 布局的头在 offset 0，int64 时间戳在 offset 4 (非对齐)，头和载荷共享缓存行；
+ * 分离布局的头是一个对齐的 32 字节描述符，载荷在另一块内存里。
+ * 比的是芯片上的缓存行和周期数，linux 目标上直接返回 ESP_ERR_NOT_SUPPORTED。
+ */
+#if CONFIG_IDF_TARGET_LINUX
+
+esp_err_t ipc_layout_bench_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#else
+
+#define LAYOUT_ROUNDS       64
+
+typedef struct {
+    uint32_t header_cycles;         // 每包 cycles
+    uint32_t full_cycles;
+} layout_result_t;
+
+static void bench_packed(ipc_packet_t *pkts, layout_result_t *out)
+{
+    volatile uint32_t sink = 0;
+    uint32_t acc;
+
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    acc = 0;
+    for (int r = 0; r < LAYOUT_ROUNDS; r++) {
+        for (int i = 0; i < DESC_POOL_COUNT; i++) {
+            acc += pkts[i].seq_num + (uint32_t)pkts[i].timestamp;
+        }
+    }
+    sink += acc;
+    uint32_t t1 = esp_cpu_get_cycle_count();
+
+    acc = 0;
+    for (int r = 0; r < LAYOUT_ROUNDS; r++) {
+        for (int i = 0; i < DESC_POOL_COUNT; i++) {
+            acc += pkts[i].seq_num + (uint32_t)pkts[i].timestamp;
+            // data 在 offset 16 (seq + timestamp + crc)，包长 4112，数组里每个包的 data 都是 4 字节对齐，
+            // 所以和分离布局用同一个按字读的循环，差别只来自布局本身
+            acc += sum_payload(pkts[i].data, IPC_PAYLOAD_SIZE);
+        }
+    }
+    sink += acc;
+    uint32_t t2 = esp_cpu_get_cycle_count();
+    (void)sink;
+
+    out->header_cycles = (t1 - t0) / (LAYOUT_ROUNDS * DESC_POOL_COUNT);
+    out->full_cycles = (t2 - t1) / (LAYOUT_ROUNDS * DESC_POOL_COUNT);
+}
+
+static void bench_split(ipc_desc_t *descs, layout_result_t *out)
+{
+    volatile uint32_t sink = 0;
+    uint32_t acc;
+
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    acc = 0;
+    for (int r = 0; r < LAYOUT_ROUNDS; r++) {
+        for (int i = 0; i < DESC_POOL_COUNT; i++) {
+            acc += descs[i].seq_num + (uint32_t)descs[i].timestamp + descs[i].len;
+        }
+    }
+    sink += acc;
+    uint32_t t1 = esp_cpu_get_cycle_count();
+
+    acc = 0;
+    for (int r = 0; r < LAYOUT_ROUNDS; r++) {
+        for (int i = 0; i < DESC_POOL_COUNT; i++) {
+            acc += descs[i].seq_num + (uint32_t)descs[i].timestamp + descs[i].len;
+            acc += sum_payload(descs[i].payload, IPC_PAYLOAD_SIZE);
+        }
+    }
+    sink += acc;
+    uint32_t t2 = esp_cpu_get_cycle_count();
+    (void)sink;
+
+    out->header_cycles = (t1 - t0) / (LAYOUT_ROUNDS * DESC_POOL_COUNT);
+    out->full_cycles = (t2 - t1) / (LAYOUT_ROUNDS * DESC_POOL_COUNT);
+}
+
+static void print_layout(const char *name, const layout_result_t *r)
+{
+    uint32_t hz = (uint32_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000;
+    ESP_LOGI(TAG, "%-22s header-only %6lu cyc/pkt (%7lu pkt/s) | full-payload %7lu cyc/pkt (%6lu pkt/s)",
+             name, (unsigned long)r->header_cycles,
+             (unsigned long)(r->header_cycles ? hz / r->header_cycles : 0),
+             (unsigned long)r->full_cycles, (unsigned long)(r->full_cycles ? hz / r->full_cycles : 0));
+}
+
+// 会借用 g_descs，只能在 Phase G 没有运行时调用
+esp_err_t ipc_layout_bench_run(void)
+{
+    layout_result_t res;
+
+    // 一次只占一份 64KB，测完就释放
+    // [1] packed：整包在内部 SRAM (Phase A/C 的布局)
+    ipc_packet_t *pkts = heap_caps_malloc(DESC_POOL_COUNT * sizeof(ipc_packet_t),
+                                          MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (pkts == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(pkts, 0x11, DESC_POOL_COUNT * sizeof(ipc_packet_t));
+    bench_packed(pkts, &res);
+    heap_caps_free(pkts);
+    print_layout("packed ipc_packet_t", &res);
+
+    // [2] 分离：描述符在内部 SRAM，载荷按 Kconfig 放在内部 SRAM 或 PSRAM
+    uint8_t *payload = heap_caps_aligned_alloc(IPC_CACHE_LINE_SIZE,
+                                               DESC_POOL_COUNT * IPC_PAYLOAD_SIZE, PAYLOAD_CAPS);
+    if (payload == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(payload, 0x11, DESC_POOL_COUNT * IPC_PAYLOAD_SIZE);
+    for (int i = 0; i < DESC_POOL_COUNT; i++) {
+        g_descs[i].seq_num = i;
+        g_descs[i].len = IPC_PAYLOAD_SIZE;
+        g_descs[i].payload = payload + i * IPC_PAYLOAD_SIZE;
+    }
+    bench_split(g_descs, &res);
+    heap_caps_free(payload);
+    print_layout("desc + payload (" PAYLOAD_REGION ")", &res);
+
+    return ESP_OK;
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "slab_alloc.h"
+#include "ipc_throughput.h"
+#include "mpmc_queue.h"
+#include "payload_check.h"
+
+// 单模式固件只在选中 MPMC 时编进来；扫参模式要跑全部策略，也需要它
+#if CONFIG_IPC_MODE_MPMC || CONFIG_IPC_BENCH_MATRIX
+
+static const char *TAG = "IPC_MPMC";
+
+// ----------------------------------------------------------------------
+// 1. 配置与全局对象
+// ----------------------------------------------------------------------
+#define MPMC_PRODUCERS      CONFIG_IPC_MPMC_PRODUCERS
+#define MPMC_CONSUMERS      CONFIG_IPC_MPMC_CONSUMERS
+#define MPMC_DEFAULT_PAYLOAD 32         // 小包：header + 32B 落在 slab 的 64B 档位
+#define GLOBAL_QUEUE_SIZE   64          // 2 的幂，>= slab 默认总块数
+#define LOCAL_QUEUE_SIZE    16          // 每个消费者的本地队列
+
+// 共享队列：K 个定时器往里放，M 个消费者从里取
+static mpmc_queue_t g_global_queue;
+static mpmc_cell_t  g_global_cells[GLOBAL_QUEUE_SIZE];
+
+#if CONFIG_IPC_MPMC_WORK_STEALING
+// 本地队列：主人从共享队列批量搬进来，空闲的兄弟可以来偷
+// 主人和小偷会同时 pop，所以本地队列也用 MPMC
+static mpmc_queue_t g_local_queue[MPMC_CONSUMERS];
+static mpmc_cell_t  g_local_cells[MPMC_CONSUMERS][LOCAL_QUEUE_SIZE];
+#endif
+
+// 每个消费者的统计，各占一个缓存行，避免两个核互相踩
+typedef struct {
+    volatile uint32_t processed;    // 累计处理包数
+    volatile uint32_t busy_us;      // 累计处理耗时 (us)
+    volatile uint32_t steals;       // 累计从别人本地队列偷到的包数
+} __attribute__((aligned(IPC_CACHE_LINE_SIZE))) consumer_stats_t;
+
+static consumer_stats_t g_consumer_stats[MPMC_CONSUMERS];
+static TaskHandle_t g_consumer_handles[MPMC_CONSUMERS];
+
+static esp_timer_handle_t g_timer_handles[MPMC_PRODUCERS];
+static uint32_t g_interval_us = 0;
+static uint16_t g_payload_len = MPMC_DEFAULT_PAYLOAD;
+static volatile uint32_t g_packets_sent = 0;
+static volatile uint32_t g_packets_lost = 0; // 池空或共享队列满导致的丢包
+static latency_hist_t g_latency_hist;
+
+// ipc_mpmc_print_stats 用来算区间速率的上一次快照
+static int64_t  g_last_report_us = 0;
+static uint32_t g_last_processed[MPMC_CONSUMERS];
+static uint32_t g_last_busy_us[MPMC_CONSUMERS];
+
+// ----------------------------------------------------------------------
+// 2. 消费者任务 (M 个，交替绑定到 Core 0 / Core 1)
+// ----------------------------------------------------------------------
+#if CONFIG_IPC_MPMC_WORK_STEALING
+/*
+ * 取包顺序：自己的本地队列 -> 从共享队列批量搬一批 -> 去偷兄弟的本地队列
+ * 批量搬运把对共享队列 dequeue_pos 的争抢降到 1/B。
+ */
+static bool fetch_packet(int id, void **item)
+{
+    consumer_stats_t *st = &g_consumer_stats[id];
+
+    if (mpmc_queue_pop(&g_local_queue[id], item)) {
+        return true;
+    }
+
+    int got = 0;
+    void *extra;
+    while (got < CONFIG_IPC_MPMC_LOCAL_BATCH && mpmc_queue_pop(&g_global_queue, &extra)) {
+        if (got == 0) {
+            *item = extra;              // 第一个直接自己处理
+        } else if (!mpmc_queue_push(&g_local_queue[id], extra)) {
+            // 本地满了就放回去；刚取走的格子可能已被生产者占掉，放不回去就只能丢
+            if (!mpmc_queue_push(&g_global_queue, extra)) {
+                slab_free(extra);
+                __atomic_fetch_add(&g_packets_lost, 1, __ATOMIC_RELAXED);
+            }
+            break;
+        }
+        got++;
+    }
+    if (got > 0) {
+        return true;
+    }
+
+    for (int i = 1; i < MPMC_CONSUMERS; i++) {
+        int victim = (id + i) % MPMC_CONSUMERS;
+        if (mpmc_queue_pop(&g_local_queue[victim], item)) {
+            st->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+#else
+static bool fetch_packet(int id, void **item)
+{
+    return mpmc_queue_pop(&g_global_queue, item);
+}
+#endif
+
+static void task_consumer_mpmc(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    consumer_stats_t *st = &g_consumer_stats[id];
+    void *item = NULL;
+
+    while (1) {
+        if (!fetch_packet(id, &item)) {
+            // 什么都没取到：睡到生产者通知 (或者 1 tick 后再看一眼)
+            ulTaskNotifyTake(pdTRUE, 1);
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        ipc_var_packet_t *p_packet = (ipc_var_packet_t *)item;
+
+        latency_hist_record(&g_latency_hist, (uint32_t)(start - p_packet->timestamp));
+
+        if (p_packet->data[0] != 0xAA || p_packet->data[p_packet->len - 1] != 0x55 ||
+            !ipc_payload_ok(p_packet->crc, p_packet->data, p_packet->len)) {
+             ESP_LOGE(TAG, "Data Verify Failed!");
+        }
+
+        // 模拟每包的业务计算，单个消费者吃不消的时候才能看出多核扩展性
+        esp_rom_delay_us(CONFIG_IPC_MPMC_WORK_US);
+
+        slab_free(p_packet);
+
+        st->busy_us += (uint32_t)(esp_timer_get_time() - start);
+        st->processed++;
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 生产者 (K 个定时器，第 k 个周期为 基础周期 x (k+1))
+// ----------------------------------------------------------------------
+/*
+ * 注意：ESP_TIMER_TASK 派发方式下所有定时器回调都在同一个 esp_timer 任务里串行执行，
+ * 这里的 K 个生产者不会真正并发；但 MPMC 队列本身允许任意并发 push，
+ * 换成多个生产者任务也不用改队列。
+ */
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    static uint32_t s_next_consumer = 0;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ipc_var_packet_t *p_packet = slab_alloc(sizeof(ipc_var_packet_t) + g_payload_len);
+    if (p_packet == NULL) {
+        // 消费者 (另一个核) 放不回全局队列时也会累加，必须是原子 RMW
+        __atomic_fetch_add(&g_packets_lost, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    p_packet->seq_num = g_packets_sent;
+    p_packet->timestamp = esp_timer_get_time();
+    p_packet->len = g_payload_len;
+    p_packet->count = 1;
+    p_packet->data[0] = 0xAA;
+    p_packet->data[g_payload_len - 1] = 0x55;
+    p_packet->crc = ipc_payload_check(p_packet->data, g_payload_len);
+
+    if (!mpmc_queue_push(&g_global_queue, p_packet)) {
+        slab_free(p_packet);
+        __atomic_fetch_add(&g_packets_lost, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    g_packets_sent++;
+
+    // 轮流叫醒消费者；正在忙的消费者下次循环会自己去取，不依赖通知
+    TaskHandle_t target = g_consumer_handles[s_next_consumer];
+    s_next_consumer = (s_next_consumer + 1) % MPMC_CONSUMERS;
+    vTaskNotifyGiveFromISR(target, &xHigherPriorityTaskWoken);
+
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4. 初始化
+// ----------------------------------------------------------------------
+static esp_err_t ipc_mpmc_init(const ipc_run_config_t *cfg)
+{
+    ESP_LOGW(TAG, "Initializing Phase D: MPMC fan-in/fan-out (K=%d producers, M=%d consumers)...",
+             MPMC_PRODUCERS, MPMC_CONSUMERS);
+
+    g_interval_us = cfg->interval_us;
+    g_payload_len = MPMC_DEFAULT_PAYLOAD;
+    if (cfg->payload_size >= 2 && cfg->payload_size <= IPC_PAYLOAD_SIZE) {
+        g_payload_len = (uint16_t)cfg->payload_size;
+    }
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+    memset(g_last_processed, 0, sizeof(g_last_processed));
+    memset(g_last_busy_us, 0, sizeof(g_last_busy_us));
+
+    latency_hist_init(&g_latency_hist);
+    memset(g_consumer_stats, 0, sizeof(g_consumer_stats));
+
+    // [1] 内存池 + 队列
+    ESP_ERROR_CHECK(slab_init());
+    if (!mpmc_queue_init(&g_global_queue, g_global_cells, GLOBAL_QUEUE_SIZE)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+#if CONFIG_IPC_MPMC_WORK_STEALING
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        mpmc_queue_init(&g_local_queue[i], g_local_cells[i], LOCAL_QUEUE_SIZE);
+    }
+    ESP_LOGI(TAG, "Work stealing enabled, local batch = %d", CONFIG_IPC_MPMC_LOCAL_BATCH);
+#endif
+
+    // [2] M 个消费者，偶数号在 Core 0，奇数号在 Core 1
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "MpmcCons%d", i);
+        BaseType_t ret = xTaskCreatePinnedToCore(task_consumer_mpmc, name, 3072,
+                                                 (void *)(intptr_t)i, 5,
+                                                 &g_consumer_handles[i], i % portNUM_PROCESSORS);
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create consumer %d!", i);
+            return ESP_FAIL;
+        }
+    }
+
+    // [3] K 个定时器
+    for (int k = 0; k < MPMC_PRODUCERS; k++) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &isr_timer_callback,
+            .name = "ipc_producer_mpmc"
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &g_timer_handles[k]));
+    }
+
+    return ESP_OK;
+}
+
+static void ipc_mpmc_start(void)
+{
+    g_last_report_us = esp_timer_get_time();
+    for (int k = 0; k < MPMC_PRODUCERS; k++) {
+        ESP_LOGW(TAG, "Starting producer %d at %lu us...", k, (unsigned long)(g_interval_us * (k + 1)));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handles[k], g_interval_us * (k + 1)));
+    }
+}
+
+static uint32_t total_processed(void)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        total += g_consumer_stats[i].processed;
+    }
+    return total;
+}
+
+static void ipc_mpmc_stop(void)
+{
+    for (int k = 0; k < MPMC_PRODUCERS; k++) {
+        esp_timer_stop(g_timer_handles[k]);
+    }
+
+    // 发出去的包全部处理完 (各消费者都回到空闲等待) 才算停稳
+    for (int i = 0; i < 100 && total_processed() != g_packets_sent; i++) {
+        vTaskDelay(1);
+    }
+}
+
+static void ipc_mpmc_deinit(void)
+{
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        if (g_consumer_handles[i]) {
+            vTaskDelete(g_consumer_handles[i]);
+            g_consumer_handles[i] = NULL;
+        }
+    }
+    for (int k = 0; k < MPMC_PRODUCERS; k++) {
+        if (g_timer_handles[k]) {
+            esp_timer_delete(g_timer_handles[k]);
+            g_timer_handles[k] = NULL;
+        }
+    }
+}
+
+static void ipc_mpmc_print_stats(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t window_us = (uint32_t)(now - g_last_report_us);
+    if (window_us == 0) {
+        return;
+    }
+    g_last_report_us = now;
+
+    uint32_t total = 0;
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        uint32_t processed = g_consumer_stats[i].processed;
+        uint32_t busy_us = g_consumer_stats[i].busy_us;
+        uint32_t d_pkts = processed - g_last_processed[i];
+        uint32_t d_busy = busy_us - g_last_busy_us[i];
+        g_last_processed[i] = processed;
+        g_last_busy_us[i] = busy_us;
+        total += d_pkts;
+
+        // 利用率 = 处理包花的时间 / 窗口时长 (不含等待和取包)
+        ESP_LOGI(TAG, "  consumer %d (core %d): %lu pkt/s, util %.1f%%, steals %lu",
+                 i, i % portNUM_PROCESSORS,
+                 (unsigned long)((uint64_t)d_pkts * 1000000 / window_us),
+                 100.0f * d_busy / window_us,
+                 (unsigned long)g_consumer_stats[i].steals);
+    }
+    ESP_LOGI(TAG, "Aggregate: %lu pkt/s over %d consumer(s), Lost: %lu",
+             (unsigned long)((uint64_t)total * 1000000 / window_us), MPMC_CONSUMERS,
+             (unsigned long)g_packets_lost);
+}
+
+const ipc_strategy_t ipc_strategy_mpmc = {
+    .name = "mpmc",
+    .init = ipc_mpmc_init,
+    .start = ipc_mpmc_start,
+    .stop = ipc_mpmc_stop,
+    .deinit = ipc_mpmc_deinit,
+    .print_stats = ipc_mpmc_print_stats,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
+
+#endif // CONFIG_IPC_MODE_MPMC || CONFIG_IPC_BENCH_MATRIX
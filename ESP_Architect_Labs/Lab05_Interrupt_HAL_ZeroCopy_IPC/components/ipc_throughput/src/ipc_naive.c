@@ -1,9 +1,15 @@
 #include <string.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "latency_histogram.h"
+#include "event_trace.h"
+#include "payload_check.h"
+#include "copy_kernel.h"
 #include "ipc_throughput.h"
 
 static const char *TAG = "IPC_NAIVE";
@@ -11,11 +17,94 @@ static const char *TAG = "IPC_NAIVE";
 // 全局句柄
 static QueueHandle_t g_naive_queue_handle = NULL;
 static esp_timer_handle_t g_timer_handle = NULL;
+static TaskHandle_t g_consumer_handle = NULL;
+
+// 本次运行的参数
+static uint32_t g_interval_us = 0;
+static uint32_t g_payload_size = IPC_PAYLOAD_SIZE;  // 每包有效载荷
+static size_t   g_item_size = sizeof(ipc_packet_t); // 队列每次拷贝的字节数 = 头 + 载荷
 
 // 统计信息 (放在 IRAM 中以提高存取速度，非必需但符合嵌入式习惯)
 static volatile uint32_t g_packets_sent = 0;
 static volatile uint32_t g_packets_lost = 0; // 队列满导致发送失败
 
+// 每个包的端到端延迟都记进直方图
+static latency_hist_t g_latency_hist;
+
+#define NAIVE_QUEUE_DEPTH   10
+
+/*
+ * --------------------------------------------------------------------------
+ * 两次整包拷贝 (生产者 -> 中转存储 -> 消费者) 由谁来做
+ * --------------------------------------------------------------------------
+ * 默认 (IPC_NAIVE_COPY_QUEUE)：队列自己存包，xQueueSendFromISR / xQueueReceive
+ * 在临界区里各 memcpy 一次。
+ * 其他选项：包放在同样 10 个槽的暂存区里，用选定的拷贝内核在临界区外拷，
+ * 队列只传 1 字节槽号。拷贝次数和字节数不变，区别只在拷贝内核和临界区长度，
+ * 用来看 Phase A 的崩溃有多少是拷贝本身造成的。
+ */
+#if !CONFIG_IPC_NAIVE_COPY_QUEUE
+static ipc_packet_t g_slots[NAIVE_QUEUE_DEPTH] __attribute__((aligned(16)));
+static volatile uint32_t g_slots_written = 0;   // 只有 ISR 写
+static volatile uint32_t g_slots_released = 0;  // 只有消费者写
+static size_t g_copy_len = sizeof(ipc_packet_t); // g_item_size 向上取整到 16 (vec128 的粒度)
+
+#if CONFIG_IPC_NAIVE_COPY_VEC128
+#define STAGING_KERNEL_NAME "vec128"
+#elif CONFIG_IPC_NAIVE_COPY_WORD32
+#define STAGING_KERNEL_NAME "word32"
+#else
+#define STAGING_KERNEL_NAME "memcpy"
+#endif
+
+_Static_assert(sizeof(ipc_packet_t) % 16 == 0, "staging slots must stay 16-byte aligned");
+
+static inline void IRAM_ATTR staging_copy(void *dst, const void *src, size_t n)
+{
+#if CONFIG_IPC_NAIVE_COPY_VEC128
+    // esp_timer 回调默认在 esp_timer 任务里跑，可以用 PIE；改成 ISR 分发时不能选这个
+    copy_vec128(dst, src, n);
+#elif CONFIG_IPC_NAIVE_COPY_WORD32
+    copy_word32(dst, src, n);
+#else
+    memcpy(dst, src, n);
+#endif
+}
+#endif
+
+static inline BaseType_t IRAM_ATTR naive_send_from_isr(const ipc_packet_t *pkt, BaseType_t *woken)
+{
+#if CONFIG_IPC_NAIVE_COPY_QUEUE
+    return xQueueSendFromISR(g_naive_queue_handle, pkt, woken);
+#else
+    uint32_t written = g_slots_written;
+    if (written - __atomic_load_n(&g_slots_released, __ATOMIC_ACQUIRE) >= NAIVE_QUEUE_DEPTH) {
+        return pdFALSE;     // 槽全满，和队列满一样算丢包
+    }
+    uint8_t slot = written % NAIVE_QUEUE_DEPTH;
+    staging_copy(&g_slots[slot], pkt, g_copy_len);
+    g_slots_written = written + 1;
+    // 槽号数 == 槽数，槽有空位时索引队列一定有空位
+    return xQueueSendFromISR(g_naive_queue_handle, &slot, woken);
+#endif
+}
+
+static inline BaseType_t naive_receive(ipc_packet_t *pkt)
+{
+#if CONFIG_IPC_NAIVE_COPY_QUEUE
+    return xQueueReceive(g_naive_queue_handle, pkt, portMAX_DELAY);
+#else
+    uint8_t slot;
+    if (xQueueReceive(g_naive_queue_handle, &slot, portMAX_DELAY) != pdTRUE) {
+        return pdFALSE;
+    }
+    staging_copy(pkt, &g_slots[slot], g_copy_len);
+    // 拷完才释放槽，ISR 之后才能覆盖它
+    __atomic_store_n(&g_slots_released, g_slots_released + 1, __ATOMIC_RELEASE);
+    return pdTRUE;
+#endif
+}
+
 /*
  * --------------------------------------------------------------------------
  * Consumer Task (消费者任务) - 运行在 Core 1
@@ -25,31 +114,30 @@ static volatile uint32_t g_packets_lost = 0; // 队列满导致发送失败
 static void task_consumer_naive(void *arg)
 {
     // 在栈上分配接收缓存。
-    // 警告：这个结构体很大 (1036字节)，必须确保创建 Task 时分配了足够的栈空间！
-    ipc_packet_t recv_packet; 
+    // 警告：这个结构体很大 (16 字节头 + 4KB 载荷 = 4112 字节)，必须确保创建 Task 时分配了足够的栈空间！
+    ipc_packet_t recv_packet __attribute__((aligned(16)));
 
     while (1) {
         // 1. 阻塞等待数据
         // portMAX_DELAY 表示死等。
         // 当数据到达时，FreeRTOS 会把数据从队列内部存储区 memcpy 到 &recv_packet
-        if (xQueueReceive(g_naive_queue_handle, &recv_packet, portMAX_DELAY) == pdTRUE) {
+        // (暂存区模式下由拷贝内核从槽里拷出来)
+        if (naive_receive(&recv_packet) == pdTRUE) {
+            EVENT_TRACE(EVENT_TRACE_DEQUEUE, recv_packet.seq_num);
 
             esp_rom_delay_us(100);
             
             // 2. 模拟业务处理 (校验)
             // 这里的目的是产生一点点计算负载，防止编译器把代码优化没了
-            if (recv_packet.data[0] != 0xAA) {
+            if (recv_packet.data[0] != 0xAA ||
+                !ipc_payload_ok(recv_packet.crc, recv_packet.data, g_payload_size)) {
                  ESP_LOGE(TAG, "Data Corruption!");
             }
 
-            // 3. (可选) 打印调试信息，为了不刷屏，每 1000 个包打一次
-            if (recv_packet.seq_num % 1000 == 0) {
-                int64_t now = esp_timer_get_time();
-                // 计算延迟：当前时间 - 发送时间
-                int32_t latency = (int32_t)(now - recv_packet.timestamp);
-                ESP_LOGI(TAG, "Seq: %lu, Latency: %ld us, Lost: %lu", 
-                         recv_packet.seq_num, latency, g_packets_lost);
-            }
+            // 3. 记录延迟：当前时间 - 发送时间 (每个包都记，不再抽样)
+            int64_t now = esp_timer_get_time();
+            latency_hist_record(&g_latency_hist, (uint32_t)(now - recv_packet.timestamp));
+            EVENT_TRACE(EVENT_TRACE_RELEASE, recv_packet.seq_num);
         }
     }
 }
@@ -66,24 +154,28 @@ static void IRAM_ATTR isr_timer_callback(void *arg)
     // 1. 准备数据
     // 使用 static 避免炸掉 ISR 栈 (1KB 太大了)
     // 这一步模拟“硬件寄存器”里的数据准备好了
-    static ipc_packet_t tx_packet; 
+    static ipc_packet_t tx_packet __attribute__((aligned(16)));
+    EVENT_TRACE(EVENT_TRACE_ISR_ENTRY, g_packets_sent);
     
     tx_packet.seq_num = g_packets_sent;
     tx_packet.timestamp = esp_timer_get_time();
     // 简单填充一点数据
     tx_packet.data[0] = 0xAA;
-    tx_packet.data[IPC_PAYLOAD_SIZE - 1] = 0x55;
+    tx_packet.data[g_payload_size - 1] = 0x55;
+    tx_packet.crc = ipc_payload_check(tx_packet.data, g_payload_size);
 
     // 2. 高优先级唤醒标志
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
     // 3. 发送数据 (The Bottleneck!)
-    // 这里的 xQueueSendFromISR 会执行 memcpy(&queue_storage, &tx_packet, 1036);
+    // 这里的 xQueueSendFromISR 会执行 memcpy(&queue_storage, &tx_packet, g_item_size);
     // 这是我们在 Phase A 故意制造的 CPU 杀手。
-    if (xQueueSendFromISR(g_naive_queue_handle, &tx_packet, &xHigherPriorityTaskWoken) == pdTRUE) {
+    if (naive_send_from_isr(&tx_packet, &xHigherPriorityTaskWoken) == pdTRUE) {
+        EVENT_TRACE(EVENT_TRACE_ENQUEUE, tx_packet.seq_num);
         g_packets_sent++;
     } else {
         // 队列满了，说明 Consumer 没来得及取走，发生丢包
+        EVENT_TRACE(EVENT_TRACE_DROP, tx_packet.seq_num);
         g_packets_lost++;
     }
 
@@ -99,33 +191,60 @@ static void IRAM_ATTR isr_timer_callback(void *arg)
  * --------------------------------------------------------------------------
  */
 
-// 这些函数将在 ipc_throughput.c 的逻辑中被调用
-// 但为了简单，我们先在这里实现一个具体的初始化，之后再整合
+// 这些函数通过 ipc_strategy_naive 被 ipc_throughput.c / ipc_bench.c 调度
 
-esp_err_t ipc_naive_init(void)
+static esp_err_t ipc_naive_init(const ipc_run_config_t *cfg)
 {
     ESP_LOGW(TAG, "Initializing Phase A: Naive Copy Mode...");
 
+    g_interval_us = cfg->interval_us;
+    g_payload_size = cfg->payload_size;
+    if (g_payload_size == 0 || g_payload_size > IPC_PAYLOAD_SIZE) {
+        g_payload_size = IPC_PAYLOAD_SIZE;
+    }
+    g_item_size = offsetof(ipc_packet_t, data) + g_payload_size;
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+
     // 1. 创建队列
     // 深度: 10 (缓冲区能存10个包)
-    // Item Size: 1036 字节 (直接存结构体) -> 内存占用 ~10KB
-    g_naive_queue_handle = xQueueCreate(10, sizeof(ipc_packet_t));
+    // Item Size: 头 + 载荷 (默认 4112 字节，直接存结构体) -> 内存占用 ~40KB
+    latency_hist_init(&g_latency_hist);
+
+#if CONFIG_IPC_NAIVE_COPY_QUEUE
+    g_naive_queue_handle = xQueueCreate(NAIVE_QUEUE_DEPTH, g_item_size);
     if (g_naive_queue_handle == NULL) {
         ESP_LOGE(TAG, "Failed to create queue! Out of memory?");
         return ESP_ERR_NO_MEM;
     }
+    ESP_LOGI(TAG, "Footprint: %u bytes (queue storage %d x %u)",
+             (unsigned)(NAIVE_QUEUE_DEPTH * g_item_size), NAIVE_QUEUE_DEPTH, (unsigned)g_item_size);
+#else
+    // 暂存区模式：槽是静态的，队列只放 1 字节槽号
+    g_copy_len = (g_item_size + 15) & ~(size_t)15;
+    g_slots_written = 0;
+    g_slots_released = 0;
+    g_naive_queue_handle = xQueueCreate(NAIVE_QUEUE_DEPTH, sizeof(uint8_t));
+    if (g_naive_queue_handle == NULL) {
+        ESP_LOGE(TAG, "Failed to create queue! Out of memory?");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Staging copy kernel: %s, %u bytes per copy", STAGING_KERNEL_NAME, (unsigned)g_copy_len);
+    ESP_LOGI(TAG, "Footprint: %u bytes (staging slots %d x %u + index queue)",
+             (unsigned)sizeof(g_slots), NAIVE_QUEUE_DEPTH, (unsigned)sizeof(ipc_packet_t));
+#endif
 
     // 2. 创建消费者任务
     // 绑定到 Core 1，与 Timer 中断 (Core 0) 分离，制造跨核通信场景
-    // Stack Depth: 4096 字节 (因为我们在栈上放了 1KB 的变量，栈必须大)
+    // Stack Depth: 8192 字节 (因为我们在栈上放了 4KB 多的整包，栈必须大)
     BaseType_t ret = xTaskCreatePinnedToCore(
         task_consumer_naive,
         "NaiveConsumer",
         8192,           // Stack size
         NULL,           // Arg
         5,              // Priority (High)
-        NULL,           // Handle
-        1               // Core ID (1)
+        &g_consumer_handle, // Handle
+        IPC_CONSUMER_CORE   // Core ID (1)
     );
 
     if (ret != pdPASS) {
@@ -144,12 +263,51 @@ esp_err_t ipc_naive_init(void)
     return ESP_OK;
 }
 
-void ipc_naive_start(void)
+static void ipc_naive_start(void)
 {
-    // 读取 Kconfig 中的频率配置
-    int interval_us = CONFIG_IPC_TIMER_INTERVAL_US;
-    ESP_LOGW(TAG, "Starting Timer at %d us interval...", interval_us);
-    
+    ESP_LOGW(TAG, "Starting Timer at %lu us interval...", (unsigned long)g_interval_us);
+
     // 启动周期性定时器
-    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, interval_us));
-}
\ No newline at end of file
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static void ipc_naive_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    // 等消费者把队列里剩下的包处理完 (最多等 100 个 tick)
+    for (int i = 0; i < 100 && uxQueueMessagesWaiting(g_naive_queue_handle) > 0; i++) {
+        vTaskDelay(1);
+    }
+    // 最后一个包可能还在 esp_rom_delay_us 里，再给它一点时间
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+static void ipc_naive_deinit(void)
+{
+    // 消费者此时阻塞在空队列上，直接删除是安全的
+    if (g_consumer_handle) {
+        vTaskDelete(g_consumer_handle);
+        g_consumer_handle = NULL;
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+    if (g_naive_queue_handle) {
+        vQueueDelete(g_naive_queue_handle);
+        g_naive_queue_handle = NULL;
+    }
+}
+
+const ipc_strategy_t ipc_strategy_naive = {
+    .name = "naive_copy",
+    .init = ipc_naive_init,
+    .start = ipc_naive_start,
+    .stop = ipc_naive_stop,
+    .deinit = ipc_naive_deinit,
+    .print_stats = NULL,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "slab_alloc.h"
+#include "ipc_throughput.h"
+#include "pubsub.h"
+#include "payload_check.h"
+
+static const char *TAG = "IPC_PUBSUB";
+
+// ----------------------------------------------------------------------
+// 1. 订阅者配置
+// ----------------------------------------------------------------------
+// 同一个采样同时送给三个订阅者，模拟真实系统里的三类消费者：
+//   control: 实时控制环，最高优先级，不做额外工作，延迟直方图记在它身上
+//   logger : 本地日志，中等开销
+//   uplink : 网络上行，最慢 (默认每包 2ms)，用来证明它丢包不会拖累另外两个
+#define PUBSUB_DEFAULT_PAYLOAD  32      // 头 + 32B 落在 slab 的 64B 档位
+#define PUBSUB_QUEUE_DEPTH      CONFIG_IPC_PUBSUB_QUEUE_DEPTH
+#define PUBSUB_SUB_COUNT        3
+
+typedef struct {
+    const char *name;
+    UBaseType_t priority;
+    BaseType_t  core;
+    uint32_t    work_us;            // 每条消息模拟的处理耗时
+    bool        record_latency;
+} sub_config_t;
+
+static const sub_config_t s_sub_configs[PUBSUB_SUB_COUNT] = {
+    { "control", 6, IPC_CONSUMER_CORE, 0,                                true  },
+    { "logger",  4, 0,                 CONFIG_IPC_PUBSUB_LOGGER_WORK_US, false },
+    { "uplink",  3, IPC_CONSUMER_CORE, CONFIG_IPC_PUBSUB_UPLINK_WORK_US, false },
+};
+
+static pubsub_topic_t g_topic;
+static pubsub_subscriber_t g_subs[PUBSUB_SUB_COUNT];
+static void *g_sub_slots[PUBSUB_SUB_COUNT][PUBSUB_QUEUE_DEPTH];
+static TaskHandle_t g_sub_handles[PUBSUB_SUB_COUNT];
+
+static esp_timer_handle_t g_timer_handle = NULL;
+static uint32_t g_interval_us = 0;
+static uint16_t g_payload_len = PUBSUB_DEFAULT_PAYLOAD;
+static volatile uint32_t g_packets_sent = 0;
+static volatile uint32_t g_packets_lost = 0; // 池子耗尽，一个订阅者都没送到
+static latency_hist_t g_latency_hist;        // control 订阅者的端到端延迟
+
+// ----------------------------------------------------------------------
+// 2. 订阅者任务
+// ----------------------------------------------------------------------
+static void task_subscriber(void *arg)
+{
+    int idx = (int)(intptr_t)arg;
+    const sub_config_t *cfg = &s_sub_configs[idx];
+    pubsub_subscriber_t *sub = &g_subs[idx];
+    pubsub_msg_t *msg = NULL;
+
+    while (1) {
+        // [A] 睡眠直到发布者通知 (计数型通知，醒来后把自己的环掏空)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (pubsub_receive(sub, &msg)) {
+            // [B] 只读共享块：三个订阅者看的是同一块内存，谁都不能改它
+            if (msg->pkt.data[0] != 0xAA || msg->pkt.data[msg->pkt.len - 1] != 0x55 ||
+                !ipc_payload_ok(msg->pkt.crc, msg->pkt.data, msg->pkt.len)) {
+                ESP_LOGE(TAG, "%s: Data Verify Failed!", cfg->name);
+            }
+
+            if (cfg->record_latency) {
+                int64_t now = esp_timer_get_time();
+                latency_hist_record(&g_latency_hist, (uint32_t)(now - msg->pkt.timestamp));
+            }
+            if (cfg->work_us) {
+                esp_rom_delay_us(cfg->work_us);
+            }
+
+            // [C] 放掉自己的引用，最后一个订阅者负责把块还给 slab
+            pubsub_release(msg);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 发布者中断 (Core 0)
+// ----------------------------------------------------------------------
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // [A] 申请一块，只写一次
+    pubsub_msg_t *msg = pubsub_alloc(g_payload_len);
+    if (msg == NULL) {
+        g_packets_lost++;
+        return;
+    }
+
+    msg->pkt.seq_num = g_packets_sent;
+    msg->pkt.timestamp = esp_timer_get_time();
+    msg->pkt.data[0] = 0xAA;
+    msg->pkt.data[g_payload_len - 1] = 0x55;
+    msg->pkt.crc = ipc_payload_check(msg->pkt.data, g_payload_len);
+
+    // [B] 扇出：每个订阅者拿到同一个指针，环满的订阅者各自记 drop
+    pubsub_publish_from_isr(&g_topic, msg, &xHigherPriorityTaskWoken);
+    g_packets_sent++;
+
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4. 初始化
+// ----------------------------------------------------------------------
+static esp_err_t ipc_pubsub_init(const ipc_run_config_t *cfg)
+{
+    ESP_LOGW(TAG, "Initializing Phase E: Ref-counted Pub/Sub (%d subscribers, queue depth %d)...",
+             PUBSUB_SUB_COUNT, PUBSUB_QUEUE_DEPTH);
+
+    g_interval_us = cfg->interval_us;
+    g_payload_len = PUBSUB_DEFAULT_PAYLOAD;
+    if (cfg->payload_size >= 2 && cfg->payload_size <= IPC_PAYLOAD_SIZE) {
+        g_payload_len = (uint16_t)cfg->payload_size;
+    }
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+
+    latency_hist_init(&g_latency_hist);
+    ESP_ERROR_CHECK(slab_init());
+    pubsub_topic_init(&g_topic, "sensor");
+
+    // [1] 先建任务拿到句柄，再登记订阅 (发布者要用句柄通知它们)
+    for (int i = 0; i < PUBSUB_SUB_COUNT; i++) {
+        const sub_config_t *sc = &s_sub_configs[i];
+        BaseType_t ret = xTaskCreatePinnedToCore(task_subscriber, sc->name, 3072,
+                                                 (void *)(intptr_t)i, sc->priority,
+                                                 &g_sub_handles[i], sc->core);
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create subscriber %s!", sc->name);
+            return ESP_FAIL;
+        }
+
+        esp_err_t err = pubsub_subscribe(&g_topic, &g_subs[i], sc->name,
+                                         g_sub_slots[i], PUBSUB_QUEUE_DEPTH, g_sub_handles[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    // [2] 创建定时器
+    const esp_timer_create_args_t timer_args = {
+        .callback = &isr_timer_callback,
+        .name = "ipc_producer_pubsub"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &g_timer_handle));
+
+    return ESP_OK;
+}
+
+static void ipc_pubsub_start(void)
+{
+    ESP_LOGW(TAG, "Starting Pub/Sub Timer at %lu us...", (unsigned long)g_interval_us);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static bool all_drained(void)
+{
+    for (int i = 0; i < PUBSUB_SUB_COUNT; i++) {
+        if (spsc_ring_count(&g_subs[i].ring) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ipc_pubsub_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    // 每个订阅者的积压都掏空 (uplink 最慢，最多 depth x work_us)
+    for (int i = 0; i < 100 && !all_drained(); i++) {
+        vTaskDelay(1);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+static void ipc_pubsub_deinit(void)
+{
+    for (int i = 0; i < PUBSUB_SUB_COUNT; i++) {
+        if (g_sub_handles[i]) {
+            vTaskDelete(g_sub_handles[i]);
+            g_sub_handles[i] = NULL;
+        }
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+}
+
+static void ipc_pubsub_print_stats(void)
+{
+    ESP_LOGI(TAG, "Published: %lu, Pool exhausted: %lu",
+             (unsigned long)g_packets_sent, (unsigned long)g_packets_lost);
+    pubsub_print_stats(&g_topic);
+    slab_print_stats();
+}
+
+const ipc_strategy_t ipc_strategy_pubsub = {
+    .name = "pubsub",
+    .init = ipc_pubsub_init,
+    .start = ipc_pubsub_start,
+    .stop = ipc_pubsub_stop,
+    .deinit = ipc_pubsub_deinit,
+    .print_stats = ipc_pubsub_print_stats,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
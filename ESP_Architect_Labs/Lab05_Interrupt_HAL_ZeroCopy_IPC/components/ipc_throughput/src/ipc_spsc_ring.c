@@ -0,0 +1,193 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "latency_histogram.h"
+#include "event_trace.h"
+#include "ipc_throughput.h"
+#include "spsc_ring.h"
+#include "payload_check.h"
+
+static const char *TAG = "IPC_SPSC";
+
+// ----------------------------------------------------------------------
+// 1. 内存池 + 两条无锁环 (The Memory Pool & Rings)
+// ----------------------------------------------------------------------
+// 与 Phase B 相同的池子大小，方便直接对比。环的容量必须是 2 的幂。
+#define BUFFER_POOL_COUNT   16
+
+static ipc_packet_t g_memory_pool[BUFFER_POOL_COUNT];
+
+// Free 环: Consumer 归还 (push) -> ISR 申请 (pop)
+// Data 环: ISR 发送 (push)      -> Consumer 接收 (pop)
+// 两条环都是严格的 "一个写者 + 一个读者"，所以不需要锁
+static spsc_ring_t g_free_ring;
+static spsc_ring_t g_data_ring;
+static void *g_free_slots[BUFFER_POOL_COUNT];
+static void *g_data_slots[BUFFER_POOL_COUNT];
+
+static TaskHandle_t g_consumer_handle = NULL;
+static esp_timer_handle_t g_timer_handle = NULL;
+static uint32_t g_interval_us = 0;
+static volatile uint32_t g_packets_sent = 0;
+static volatile uint32_t g_packets_lost = 0; // 因无空闲块导致的丢包
+static latency_hist_t g_latency_hist;        // 每个包的端到端延迟
+
+// ----------------------------------------------------------------------
+// 2. 消费者任务 (Core 1)
+// ----------------------------------------------------------------------
+static void task_consumer_spsc(void *arg)
+{
+    void *item = NULL;
+
+    while (1) {
+        // [A] 睡眠直到 ISR 发来通知
+        // 通知是计数型的，ISR 连发多次也不会丢，醒来后一次性把环掏空即可
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // [B] 批量取指针 (纯原子操作，不进临界区)
+        while (spsc_ring_pop(&g_data_ring, &item)) {
+            ipc_packet_t *p_packet = (ipc_packet_t *)item;
+            EVENT_TRACE(EVENT_TRACE_DEQUEUE, p_packet->seq_num);
+
+            if (p_packet->data[0] != 0xAA ||
+                !ipc_payload_ok(p_packet->crc, p_packet->data, IPC_PAYLOAD_SIZE)) {
+                 ESP_LOGE(TAG, "Data Verify Failed!");
+            }
+
+            int64_t now = esp_timer_get_time();
+            latency_hist_record(&g_latency_hist, (uint32_t)(now - p_packet->timestamp));
+
+            // [C] 归还资源：Free 环容量 == 池大小，所以这里永远不会满
+            // (先记事件再归还，归还之后这块随时会被 ISR 改写)
+            EVENT_TRACE(EVENT_TRACE_RELEASE, p_packet->seq_num);
+            spsc_ring_push(&g_free_ring, p_packet);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 生产者中断 (Core 0)
+// ----------------------------------------------------------------------
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    void *item = NULL;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    EVENT_TRACE(EVENT_TRACE_ISR_ENTRY, g_packets_sent);
+
+    // [A] 从 Free 环申请空闲块
+    if (spsc_ring_pop(&g_free_ring, &item)) {
+        ipc_packet_t *p_packet = (ipc_packet_t *)item;
+
+        // [B] 写入数据
+        p_packet->seq_num = g_packets_sent;
+        p_packet->timestamp = esp_timer_get_time();
+        p_packet->data[0] = 0xAA;
+        p_packet->crc = ipc_payload_check(p_packet->data, IPC_PAYLOAD_SIZE);
+
+        // [C] 发布指针，再用任务通知叫醒消费者
+        // Data 环容量 == 池大小，能拿到空闲块就一定能放进去
+        spsc_ring_push(&g_data_ring, p_packet);
+        EVENT_TRACE(EVENT_TRACE_ENQUEUE, p_packet->seq_num);
+        g_packets_sent++;
+
+        vTaskNotifyGiveFromISR(g_consumer_handle, &xHigherPriorityTaskWoken);
+
+    } else {
+        // [D] 无空闲块 (Resource Starvation)
+        EVENT_TRACE(EVENT_TRACE_DROP, g_packets_sent);
+        g_packets_lost++;
+    }
+
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4. 初始化
+// ----------------------------------------------------------------------
+static esp_err_t ipc_spsc_ring_init(const ipc_run_config_t *cfg)
+{
+    ESP_LOGW(TAG, "Initializing Phase C: Lock-free SPSC Ring...");
+
+    // 固定 4KB 块，载荷大小不影响指针传递的开销，这里只用周期
+    g_interval_us = cfg->interval_us;
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+
+    latency_hist_init(&g_latency_hist);
+
+    // [1] 初始化两条环
+    if (!spsc_ring_init(&g_free_ring, g_free_slots, BUFFER_POOL_COUNT) ||
+        !spsc_ring_init(&g_data_ring, g_data_slots, BUFFER_POOL_COUNT)) {
+        ESP_LOGE(TAG, "Ring capacity must be a power of two");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // [2] 填充空闲环 (Seed the pool)
+    for (int i = 0; i < BUFFER_POOL_COUNT; i++) {
+        if (!spsc_ring_push(&g_free_ring, &g_memory_pool[i])) {
+            ESP_LOGE(TAG, "Failed to fill buffer pool");
+            return ESP_FAIL;
+        }
+    }
+
+    // [3] 创建任务 (Core 1)，必须在定时器之前拿到句柄，ISR 要通知它
+    BaseType_t ret = xTaskCreatePinnedToCore(task_consumer_spsc, "SpscConsumer", 4096,
+                                             NULL, 5, &g_consumer_handle, IPC_CONSUMER_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task!");
+        return ESP_FAIL;
+    }
+
+    // [4] 创建定时器
+    const esp_timer_create_args_t timer_args = {
+        .callback = &isr_timer_callback,
+        .name = "ipc_producer_spsc"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &g_timer_handle));
+
+    return ESP_OK;
+}
+
+static void ipc_spsc_ring_start(void)
+{
+    ESP_LOGW(TAG, "Starting SPSC Ring Timer at %lu us...", (unsigned long)g_interval_us);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static void ipc_spsc_ring_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    // 所有块都回到 Free 环，说明消费者已经处理完在途的包
+    for (int i = 0; i < 100 && spsc_ring_count(&g_free_ring) < BUFFER_POOL_COUNT; i++) {
+        vTaskDelay(1);
+    }
+}
+
+static void ipc_spsc_ring_deinit(void)
+{
+    // 消费者此时阻塞在 ulTaskNotifyTake 上
+    if (g_consumer_handle) {
+        vTaskDelete(g_consumer_handle);
+        g_consumer_handle = NULL;
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+}
+
+const ipc_strategy_t ipc_strategy_spsc_ring = {
+    .name = "spsc_ring",
+    .init = ipc_spsc_ring_init,
+    .start = ipc_spsc_ring_start,
+    .stop = ipc_spsc_ring_stop,
+    .deinit = ipc_spsc_ring_deinit,
+    .print_stats = NULL,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
@@ -1,9 +1,18 @@
 #include "sdkconfig.h" // 必须包含！否则读不到 CONFIG_ 宏
 #include "esp_log.h"
+#include "event_trace.h"
+#include "checksum.h"
+#include "copy_kernel.h"
+#include "cpu_load.h"
 #include "ipc_throughput.h"
 
 static const char *TAG = "IPC_MGR";
 
+// 当前运行的模式 + 周期打印延迟直方图的任务
+static const ipc_strategy_t *g_active = NULL;
+static latency_hist_reporter_handle_t g_reporter = NULL;
+static uint32_t g_load_base_sent = 0;   // 上一个 CPU 负载窗口开始时的发送计数
+
 esp_err_t ipc_test_init(void)
 {
     ESP_LOGI(TAG, "Initializing IPC Throughput Lab...");
@@ -11,31 +20,140 @@ esp_err_t ipc_test_init(void)
     // ----------------------------------------------------------------
     // 分支逻辑：根据 Kconfig 定义的宏来决定运行哪个模式
     // ----------------------------------------------------------------
-    
+
     #if defined(CONFIG_IPC_MODE_COPY)
         // 模式 A: 笨拙拷贝
         ESP_LOGW(TAG, "Mode Selected: Phase A (Naive Copy)");
         ESP_LOGW(TAG, "WARNING: High CPU usage expected due to memcpy(%d bytes)", IPC_PAYLOAD_SIZE);
-        return ipc_naive_init();
+        g_active = &ipc_strategy_naive;
 
     #elif defined(CONFIG_IPC_MODE_ZERO_COPY)
         // 模式 B: 零拷贝 (指针传递)
         ESP_LOGW(TAG, "Mode Selected: Phase B (Zero Copy)");
         ESP_LOGI(TAG, "Optimized: Passing 4-byte pointers instead of %d-byte data", IPC_PAYLOAD_SIZE);
-        return ipc_zero_copy_init();
+        g_active = &ipc_strategy_zero_copy;
+
+    #elif defined(CONFIG_IPC_MODE_SPSC_RING)
+        // 模式 C: 无锁 SPSC 环形队列 (指针传递 + 原子变量，不进临界区)
+        ESP_LOGW(TAG, "Mode Selected: Phase C (Lock-free SPSC Ring)");
+        ESP_LOGI(TAG, "Optimized: No queue critical section, wake consumer by task notification");
+        g_active = &ipc_strategy_spsc_ring;
+
+    #elif defined(CONFIG_IPC_MODE_MPMC)
+        // 模式 D: K 个生产者 -> 无锁 MPMC 队列 -> M 个消费者 (跨两个核)
+        ESP_LOGW(TAG, "Mode Selected: Phase D (MPMC fan-in/fan-out)");
+        g_active = &ipc_strategy_mpmc;
+
+    #elif defined(CONFIG_IPC_MODE_PUBSUB)
+        // 模式 E: 一次发布，多个订阅者共享同一块 (引用计数)
+        ESP_LOGW(TAG, "Mode Selected: Phase E (Ref-counted Pub/Sub)");
+        g_active = &ipc_strategy_pubsub;
+
+    #elif defined(CONFIG_IPC_MODE_BIP_BUFFER)
+        // 模式 F: 连续变长缓冲区，ISR 原地写，消费者原地读
+        ESP_LOGW(TAG, "Mode Selected: Phase F (Bip Buffer)");
+        g_active = &ipc_strategy_bip;
+
+    #elif defined(CONFIG_IPC_MODE_DESC_SPLIT)
+        // 模式 G: 对齐描述符 + 独立载荷块；先跑一遍布局对比
+        ESP_LOGW(TAG, "Mode Selected: Phase G (Descriptor / Payload split)");
+        // 对比只是附带的测量，缓冲申请不到就跳过，不影响后面的正式运行
+        esp_err_t layout_err = ipc_layout_bench_run();
+        if (layout_err != ESP_OK) {
+            ESP_LOGE(TAG, "Layout bench skipped: %s", esp_err_to_name(layout_err));
+        }
+        g_active = &ipc_strategy_desc_split;
 
     #else
         // 此时 menuconfig 里可能什么都没选 (很少见)
         ESP_LOGE(TAG, "No IPC mode selected in Kconfig!");
         return ESP_ERR_NOT_SUPPORTED;
     #endif
+
+    // 单次运行：周期和载荷都取 Kconfig / 模式默认值
+    const ipc_run_config_t cfg = {
+        .interval_us = CONFIG_IPC_TIMER_INTERVAL_US,
+        .payload_size = 0,
+    };
+
+    // 关闭 EVENT_TRACE_ENABLE 时是空函数
+    ESP_ERROR_CHECK(event_trace_init());
+
+    // CRC 查找表 (只在 IPC_CHECK_CRC32 时被用到，生成一次 ~8KB 很便宜)
+    checksum_init();
+#if CONFIG_IPC_CHECKSUM_SELFTEST
+    esp_err_t err = checksum_selftest();
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+#if CONFIG_IPC_CHECK_BENCH
+    // 基准只是附带的测量，内核与 ROM 对不上时报出来，IPC 测试照常跑
+    if (checksum_bench_run() != ESP_OK) {
+        ESP_LOGE(TAG, "Checksum bench: kernel mismatch");
+    }
+#endif
+#if CONFIG_IPC_COPY_BENCH
+    ESP_ERROR_CHECK(copy_kernel_bench_run());
+#endif
+    return g_active->init(&cfg);
 }
 
 void ipc_test_start(void)
 {
-    #if defined(CONFIG_IPC_MODE_COPY)
-        ipc_naive_start();
-    #elif defined(CONFIG_IPC_MODE_ZERO_COPY)
-        ipc_zero_copy_start();
-    #endif
-}
\ No newline at end of file
+    if (g_active == NULL) {
+        return;
+    }
+
+    // 周期打印 min/p50/p90/p99/p99.9/max + 区间丢包数
+    ESP_ERROR_CHECK(latency_hist_reporter_start(g_active->latency, g_active->name,
+                                                CONFIG_IPC_LATENCY_REPORT_PERIOD_MS,
+                                                g_active->lost, &g_reporter));
+    g_active->start();
+
+    // 第一个 CPU 负载窗口从这里开始，之后每次 print_stats 滚动一次
+    g_load_base_sent = *g_active->sent;
+    cpu_load_window_begin();
+}
+
+void ipc_test_print_stats(void)
+{
+    if (g_active == NULL) {
+        return;
+    }
+    if (g_active->print_stats) {
+        g_active->print_stats();
+    }
+
+    // 两次调用之间每个核的忙碌比例，以及平均每个包花掉多少 CPU 周期
+    // (生产者回调跑在 esp_timer 任务里，也算在忙碌时间内)
+    cpu_load_report_t load;
+    if (cpu_load_window_end(&load) == ESP_OK) {
+        uint32_t sent = *g_active->sent;
+        cpu_load_print(g_active->name, &load, sent - g_load_base_sent, "pkt");
+        g_load_base_sent = sent;
+        cpu_load_window_begin();
+    }
+}
+
+void ipc_test_dump_trace(void)
+{
+#if CONFIG_EVENT_TRACE_ENABLE
+    event_trace_dump();
+#else
+    ESP_LOGW(TAG, "Event trace disabled, enable EVENT_TRACE_ENABLE in menuconfig");
+#endif
+}
+
+void ipc_test_deinit(void)
+{
+    if (g_active == NULL) {
+        return;
+    }
+
+    g_active->stop();
+    latency_hist_reporter_stop(g_reporter);
+    g_reporter = NULL;
+    g_active->deinit();
+    g_active = NULL;
+}
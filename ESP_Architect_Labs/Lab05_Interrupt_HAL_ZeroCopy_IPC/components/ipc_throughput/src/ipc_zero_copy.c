@@ -3,88 +3,352 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "sdkconfig.h"
+#include "latency_histogram.h"
+#include "event_trace.h"
+#include "slab_alloc.h"
 #include "ipc_throughput.h"
+#include "payload_dist.h"
+#include "payload_check.h"
 
 static const char *TAG = "IPC_ZERO";
 
 // ----------------------------------------------------------------------
 // 1. 内存池定义 (The Memory Pool)
 // ----------------------------------------------------------------------
-// 定义缓冲池的数量。这决定了我们能容忍多大的突发流量 (Burst)。
-#define BUFFER_POOL_COUNT   16 
+// 不再静态分配 16 x 4KB 的固定块，而是交给 slab 分配器：
+// 64/256/1024/4096 多个档位，按 "头 + 实际载荷长度" 取最合适的块。
+// 空闲链表在 slab 内部 (无锁)，所以不再需要 Free 队列。
 
-// 静态分配 N 个 4KB 的块。这块内存在 .bss 段，系统启动时分配。
-static ipc_packet_t g_memory_pool[BUFFER_POOL_COUNT];
+// 最大档必须能装下 "头 + 满载荷"，否则满长度的包永远申请不到块
+_Static_assert(CONFIG_SLAB_CLASS3_SIZE >= sizeof(ipc_var_packet_t) + IPC_PAYLOAD_SIZE,
+               "SLAB_CLASS3_SIZE too small for a full ipc_var_packet_t");
 
-// 两个队列句柄
-static QueueHandle_t g_free_queue = NULL; // 存空闲块的指针
-static QueueHandle_t g_data_queue = NULL; // 存有数据块的指针
+// 数据队列：存有数据块的指针
+static QueueHandle_t g_data_queue = NULL;
 
 static esp_timer_handle_t g_timer_handle = NULL;
+static TaskHandle_t g_consumer_handle = NULL;
+static uint32_t g_interval_us = 0;
+static uint16_t g_fixed_payload = 0;        // 0 = 随机长度分布，否则每包固定长度
 static volatile uint32_t g_packets_sent = 0;
 static volatile uint32_t g_packets_lost = 0; // 因无空闲块导致的丢包
+static latency_hist_t g_latency_hist;        // 每个包的端到端延迟
+
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+// 背压：每个 tick 是一个固定长度的采样，按池子水位决定合并/抽稀因子
+#define BP_DEFAULT_SAMPLE_LEN   32
+#if CONFIG_IPC_BP_COALESCE
+#define BP_POLICY_NAME          "coalesce"
+#else
+#define BP_POLICY_NAME          "decimate"
+#endif
+static uint16_t g_bp_sample_len = BP_DEFAULT_SAMPLE_LEN;
+static uint32_t g_bp_max_factor = 1;            // min(Kconfig 上限, 4KB / 采样长度)
+static volatile uint32_t g_bp_factor = 1;       // 当前因子，1 = 全速
+static volatile uint32_t g_bp_escalations = 0;  // 因子翻倍次数
+static volatile uint32_t g_bp_relaxations = 0;  // 因子减半次数
+static volatile uint32_t g_samples_produced = 0;   // tick 数 = 采样数
+static volatile uint32_t g_samples_delivered = 0;  // 消费者收到的包的 count 之和
+static volatile uint32_t g_samples_decimated = 0;  // 抽稀主动跳过的采样
+// 以下只在 ISR 里读写
+static ipc_var_packet_t *g_bp_open = NULL;      // 合并中的包
+static uint32_t g_bp_open_target = 1;           // 这个包要攒的采样数
+static uint32_t g_bp_skip = 0;                  // 抽稀：本组还要跳过的采样数
+// print_stats 算区间速率用
+static int64_t  g_bp_last_report_us = 0;
+static uint32_t g_bp_last_packets = 0;
+static uint32_t g_bp_last_samples = 0;
+#endif
+
+#if CONFIG_IPC_ZERO_COPY_BATCHED
+// 批量模式：消费者不再阻塞在队列上，而是等 ISR 的任务通知 (g_consumer_handle)
+// 以下两个变量只在 ISR 里读写
+static uint32_t g_batch_pending = 0;     // 上次通知之后新入队的包数
+static int64_t  g_batch_first_ts = 0;    // 这一批里最早那个包的入队时间
+#endif
 
 // ----------------------------------------------------------------------
 // 2. 消费者任务 (Core 1)
 // ----------------------------------------------------------------------
+#if !CONFIG_IPC_ZERO_COPY_BATCHED
 static void task_consumer_zero_copy(void *arg)
 {
-    ipc_packet_t *p_packet = NULL; // 这是一个指针！不是巨大的结构体
+    ipc_var_packet_t *p_packet = NULL; // 这是一个指针！不是巨大的结构体
 
     while (1) {
         // [A] 从数据队列获取指针 (只搬运 4 字节)
         if (xQueueReceive(g_data_queue, &p_packet, portMAX_DELAY) == pdTRUE) {
+            EVENT_TRACE(EVENT_TRACE_DEQUEUE, p_packet->seq_num);
             
             // [B] 原地处理数据 (Zero Copy Access)
             // 直接通过指针访问内存，没有任何 memcpy 发生
-            if (p_packet->data[0] != 0xAA) {
+            if (p_packet->data[0] != 0xAA || p_packet->data[p_packet->len - 1] != 0x55 ||
+                !ipc_payload_ok(p_packet->crc, p_packet->data, p_packet->len)) {
                  ESP_LOGE(TAG, "Data Verify Failed!");
             }
 
-            // 模拟负载 (和 Phase A 保持一致，甚至可以更重)
-            // esp_rom_delay_us(100); 
+            // 模拟每包的处理负载 (背压演示时用它让消费者按 "包" 而不是按 "字节" 吃不消)
+#if CONFIG_IPC_ZERO_COPY_WORK_US > 0
+            esp_rom_delay_us(CONFIG_IPC_ZERO_COPY_WORK_US);
+#endif
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+            g_samples_delivered += p_packet->count;
+#endif
+
+            // 记录延迟 (每个包都记，尾部抖动才不会被抽样掩盖)
+            int64_t now = esp_timer_get_time();
+            latency_hist_record(&g_latency_hist, (uint32_t)(now - p_packet->timestamp));
+
+            // [C] 归还资源：还给 slab
+            EVENT_TRACE(EVENT_TRACE_RELEASE, p_packet->seq_num);
+            slab_free(p_packet);
+        }
+    }
+}
+
+#else
+// ----------------------------------------------------------------------
+// 2'. 批量消费者任务 (Core 1)
+// ----------------------------------------------------------------------
+// 一次唤醒处理一整批，把上下文切换次数从 "每包一次" 降到 "每 N 包一次"
+static void task_consumer_zero_copy_batched(void *arg)
+{
+    ipc_var_packet_t *batch[CONFIG_IPC_BATCH_MAX_PACKETS];
+
+    // 兜底超时：万一 ISR 停了，残留在队列里的包也不会永远等下去
+    TickType_t timeout = pdMS_TO_TICKS((CONFIG_IPC_BATCH_MAX_LATENCY_US + 999) / 1000);
+    if (timeout == 0) timeout = 1;
 
-            // 打印统计 (每 10000 包打一次，因为现在太快了)
-            if (p_packet->seq_num % 10000 == 0) {
-                int64_t now = esp_timer_get_time();
-                int32_t latency = (int32_t)(now - p_packet->timestamp);
-                ESP_LOGI(TAG, "Seq: %lu, Latency: %ld us, Lost: %lu", 
-                         p_packet->seq_num, latency, g_packets_lost);
+    uint32_t wakeups = 0;
+    uint32_t drained = 0;
+    int64_t window_start = esp_timer_get_time();
+
+    while (1) {
+        // [A] 等通知 (清零计数，多次 Give 合并成一次唤醒)
+        ulTaskNotifyTake(pdTRUE, timeout);
+        wakeups++;
+
+        int n;
+        do {
+            // [B] 一次最多取 N 个指针，不阻塞
+            n = 0;
+            while (n < CONFIG_IPC_BATCH_MAX_PACKETS &&
+                   xQueueReceive(g_data_queue, &batch[n], 0) == pdTRUE) {
+                n++;
             }
 
-            // [C] 归还资源：把指针扔回空闲队列
-            xQueueSend(g_free_queue, &p_packet, portMAX_DELAY);
+            // [C] 原地处理整批数据
+            int64_t now = esp_timer_get_time();
+            for (int i = 0; i < n; i++) {
+                EVENT_TRACE(EVENT_TRACE_DEQUEUE, batch[i]->seq_num);
+                if (batch[i]->data[0] != 0xAA || batch[i]->data[batch[i]->len - 1] != 0x55 ||
+                    !ipc_payload_ok(batch[i]->crc, batch[i]->data, batch[i]->len)) {
+                     ESP_LOGE(TAG, "Data Verify Failed!");
+                }
+                latency_hist_record(&g_latency_hist, (uint32_t)(now - batch[i]->timestamp));
+#if CONFIG_IPC_ZERO_COPY_WORK_US > 0
+                esp_rom_delay_us(CONFIG_IPC_ZERO_COPY_WORK_US);
+#endif
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+                g_samples_delivered += batch[i]->count;
+#endif
+            }
+
+            // [D] 整批归还给 slab
+            for (int i = 0; i < n; i++) {
+                EVENT_TRACE(EVENT_TRACE_RELEASE, batch[i]->seq_num);
+                slab_free(batch[i]);
+            }
+            drained += n;
+
+            // 取满 N 个说明队列里可能还有，继续掏，不再睡
+        } while (n == CONFIG_IPC_BATCH_MAX_PACKETS);
+
+        // [E] 每秒打印一次唤醒统计
+        int64_t now = esp_timer_get_time();
+        if (now - window_start >= 1000000) {
+            float seconds = (float)(now - window_start) / 1000000.0f;
+            ESP_LOGI(TAG, "Wakeups: %lu/s, Pkts/Wakeup: %.2f, Lost: %lu",
+                     (unsigned long)(wakeups / seconds),
+                     wakeups ? (float)drained / wakeups : 0.0f,
+                     (unsigned long)g_packets_lost);
+            wakeups = 0;
+            drained = 0;
+            window_start = now;
         }
     }
 }
+#endif
 
 // ----------------------------------------------------------------------
 // 3. 生产者中断 (Core 0)
 // ----------------------------------------------------------------------
-static void IRAM_ATTR isr_timer_callback(void *arg)
+// 把一个写好的包交给消费者 (仅仅发送 4 字节的地址)
+// 校验值在这里统一盖：背压合并的包要攒满才算写完
+static inline void IRAM_ATTR send_packet(ipc_var_packet_t *p_packet, BaseType_t *woken)
 {
-    ipc_packet_t *p_packet = NULL;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    p_packet->crc = ipc_payload_check(p_packet->data, p_packet->len);
+    xQueueSendFromISR(g_data_queue, &p_packet, woken);
+    EVENT_TRACE(EVENT_TRACE_ENQUEUE, p_packet->seq_num);
+    g_packets_sent++;
+
+#if CONFIG_IPC_ZERO_COPY_BATCHED
+    if (g_batch_pending++ == 0) {
+        g_batch_first_ts = p_packet->timestamp;
+    }
+#endif
+}
+
+#if !CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+// 每个 tick 一个包，池子空了就丢
+static inline void IRAM_ATTR produce(BaseType_t *woken)
+{
+    static uint32_t s_rand = 0x12345678;
+    uint16_t len = g_fixed_payload ? g_fixed_payload : ipc_pick_payload_len(&s_rand);
 
-    // [A] 尝试获取空闲块 (申请资源)
-    // 如果 Free 队列空了，说明 Consumer 处理太慢，所有 Buffer 都在忙
-    if (xQueueReceiveFromISR(g_free_queue, &p_packet, &xHigherPriorityTaskWoken) == pdTRUE) {
-        
-        // [B] 写入数据 (直接写内存)
-        p_packet->seq_num = g_packets_sent;
-        p_packet->timestamp = esp_timer_get_time();
-        p_packet->data[0] = 0xAA;
-        
-        // [C] 发送数据 (发送指针)
-        // 仅仅发送 4 字节的地址给消费者
-        xQueueSendFromISR(g_data_queue, &p_packet, &xHigherPriorityTaskWoken);
-        g_packets_sent++;
-
-    } else {
+    // [A] 按实际长度申请块 (申请资源)
+    // slab 返回 NULL 说明 Consumer 处理太慢，对应档位 (及更大档位) 都在忙
+    ipc_var_packet_t *p_packet = slab_alloc(sizeof(ipc_var_packet_t) + len);
+    if (p_packet == NULL) {
         // [D] 无空闲块 (Resource Starvation)
         // 这就是零拷贝模式下的丢包：不是队列满，而是内存池空了
+        EVENT_TRACE(EVENT_TRACE_DROP, g_packets_sent);
+        g_packets_lost++;
+        return;
+    }
+
+    // [B] 写入数据 (直接写内存)
+    p_packet->seq_num = g_packets_sent;
+    p_packet->timestamp = esp_timer_get_time();
+    p_packet->len = len;
+    p_packet->count = 1;
+    p_packet->data[0] = 0xAA;
+    p_packet->data[len - 1] = 0x55;
+
+    // [C] 发送数据 (发送指针)
+    send_packet(p_packet, woken);
+}
+
+#else
+// ----------------------------------------------------------------------
+// 3'. 背压：按池子水位在 "全速" 和 "合并/抽稀" 之间切换
+// ----------------------------------------------------------------------
+/*
+ * 因子 k 只在包边界上调整 (翻倍 / 减半)：
+ *   最佳档位占用 >= 高水位 -> k *= 2 (最大 g_bp_max_factor)
+ *   最佳档位占用 <= 低水位 -> k /= 2 (最小 1，即全速)
+ * 合并 (COALESCE): k 个采样依次写进同一个包，攒满才发，包数降为 1/k，数据一个不丢
+ * 抽稀 (DECIMATE): 发 1 个采样，接下来 k-1 个主动跳过，包里记下 count = k
+ */
+static inline uint32_t IRAM_ATTR bp_usage(uint32_t k)
+{
+    // 合并时包长随 k 变化，可能落在不同档位，所以看 "因子为 k 时的包" 所在档位
+#if CONFIG_IPC_BP_COALESCE
+    return slab_usage_pct(sizeof(ipc_var_packet_t) + k * g_bp_sample_len);
+#else
+    return slab_usage_pct(sizeof(ipc_var_packet_t) + g_bp_sample_len);
+#endif
+}
+
+static inline void IRAM_ATTR bp_adapt(void)
+{
+    uint32_t k = g_bp_factor;
+
+    if (k < g_bp_max_factor && bp_usage(k) >= CONFIG_IPC_BP_HIGH_WATERMARK_PCT) {
+        g_bp_factor = (k * 2 > g_bp_max_factor) ? g_bp_max_factor : k * 2;
+        g_bp_escalations++;
+    } else if (k > 1 && bp_usage(k / 2) <= CONFIG_IPC_BP_LOW_WATERMARK_PCT) {
+        // 降档前看的是降档后要用的那个档位：它已经排空才回到更高的包速率
+        g_bp_factor = k / 2;
+        g_bp_relaxations++;
+    }
+}
+
+static inline void IRAM_ATTR write_sample(uint8_t *dst, uint16_t len)
+{
+    // 每个采样首尾各一个校验字节，合并后整包的 data[0] / data[len-1] 依然成立
+    dst[0] = 0xAA;
+    dst[len - 1] = 0x55;
+}
+
+static inline void IRAM_ATTR produce(BaseType_t *woken)
+{
+    uint16_t len = g_bp_sample_len;
+    g_samples_produced++;
+
+#if CONFIG_IPC_BP_COALESCE
+    // [A] 包边界：先调整因子，再按 k 个采样的大小申请一个包
+    if (g_bp_open == NULL) {
+        bp_adapt();
+        g_bp_open_target = g_bp_factor;
+        g_bp_open = slab_alloc(sizeof(ipc_var_packet_t) + g_bp_open_target * len);
+        if (g_bp_open == NULL) {
+            g_packets_lost++;       // 这个采样丢了 (合并都救不回来，说明消费者彻底跟不上)
+            return;
+        }
+        g_bp_open->seq_num = g_packets_sent;
+        g_bp_open->timestamp = esp_timer_get_time();   // 最早那个采样的时间
+        g_bp_open->len = 0;
+        g_bp_open->count = 0;
+    }
+
+    // [B] 采样追加到包尾
+    write_sample(g_bp_open->data + g_bp_open->len, len);
+    g_bp_open->len += len;
+    g_bp_open->count++;
+
+    // [C] 攒满 k 个才发
+    if (g_bp_open->count >= g_bp_open_target) {
+        send_packet(g_bp_open, woken);
+        g_bp_open = NULL;
+    }
+
+#else
+    // [A] 这一组里剩下的采样主动跳过
+    if (g_bp_skip > 0) {
+        g_bp_skip--;
+        g_samples_decimated++;
+        return;
+    }
+
+    // [B] 组的第一个采样：调整因子，发出去，并登记它代表 k 个采样
+    bp_adapt();
+    uint32_t k = g_bp_factor;
+    ipc_var_packet_t *p_packet = slab_alloc(sizeof(ipc_var_packet_t) + len);
+    if (p_packet == NULL) {
         g_packets_lost++;
+        return;
     }
+    p_packet->seq_num = g_packets_sent;
+    p_packet->timestamp = esp_timer_get_time();
+    p_packet->len = len;
+    p_packet->count = (uint16_t)k;
+    write_sample(p_packet->data, len);
+    send_packet(p_packet, woken);
+    g_bp_skip = k - 1;
+#endif
+}
+#endif // CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+
+static void IRAM_ATTR isr_timer_callback(void *arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    EVENT_TRACE(EVENT_TRACE_ISR_ENTRY, g_packets_sent);
+
+    produce(&xHigherPriorityTaskWoken);
+
+#if CONFIG_IPC_ZERO_COPY_BATCHED
+    // [E] 攒够一批，或者最早的包等太久了，才叫醒消费者
+    // 丢包分支也要检查，否则池子被攒空时这一批永远凑不满
+    if (g_batch_pending >= CONFIG_IPC_BATCH_MAX_PACKETS ||
+        (g_batch_pending > 0 &&
+         esp_timer_get_time() - g_batch_first_ts >= CONFIG_IPC_BATCH_MAX_LATENCY_US)) {
+        g_batch_pending = 0;
+        vTaskNotifyGiveFromISR(g_consumer_handle, &xHigherPriorityTaskWoken);
+    }
+#endif
 
     if (xHigherPriorityTaskWoken) {
         portYIELD_FROM_ISR();
@@ -94,31 +358,70 @@ static void IRAM_ATTR isr_timer_callback(void *arg)
 // ----------------------------------------------------------------------
 // 4. 初始化
 // ----------------------------------------------------------------------
-esp_err_t ipc_zero_copy_init(void)
+static esp_err_t ipc_zero_copy_init(const ipc_run_config_t *cfg)
 {
     ESP_LOGW(TAG, "Initializing Phase B: Zero-Copy Mode (Pointer Passing)...");
 
-    // [1] 创建指针队列
-    // 关键点：Item Size 是 sizeof(ipc_packet_t*)，也就是 4 字节！
-    // 哪怕载荷有 100MB，这里也只传 4 字节。
-    g_free_queue = xQueueCreate(BUFFER_POOL_COUNT, sizeof(ipc_packet_t*));
-    g_data_queue = xQueueCreate(BUFFER_POOL_COUNT, sizeof(ipc_packet_t*));
-
-    if (g_free_queue == NULL || g_data_queue == NULL) return ESP_ERR_NO_MEM;
-
-    // [2] 填充空闲队列 (Seed the pool)
-    // 把静态数组里每个块的地址，都塞进 Free 队列
-    for (int i = 0; i < BUFFER_POOL_COUNT; i++) {
-        ipc_packet_t *ptr = &g_memory_pool[i];
-        if (xQueueSend(g_free_queue, &ptr, 0) != pdPASS) {
-            ESP_LOGE(TAG, "Failed to fill buffer pool");
-            return ESP_FAIL;
-        }
+    g_interval_us = cfg->interval_us;
+    g_fixed_payload = 0;
+    if (cfg->payload_size >= 2 && cfg->payload_size <= IPC_PAYLOAD_SIZE) {
+        g_fixed_payload = (uint16_t)cfg->payload_size;
+    }
+    g_packets_sent = 0;
+    g_packets_lost = 0;
+#if CONFIG_IPC_ZERO_COPY_BATCHED
+    g_batch_pending = 0;
+#endif
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+    g_bp_sample_len = g_fixed_payload ? g_fixed_payload : BP_DEFAULT_SAMPLE_LEN;
+    g_bp_max_factor = IPC_PAYLOAD_SIZE / g_bp_sample_len;
+    if (g_bp_max_factor > CONFIG_IPC_BP_MAX_FACTOR) {
+        g_bp_max_factor = CONFIG_IPC_BP_MAX_FACTOR;
     }
+    g_bp_factor = 1;
+    g_bp_escalations = 0;
+    g_bp_relaxations = 0;
+    g_samples_produced = 0;
+    g_samples_delivered = 0;
+    g_samples_decimated = 0;
+    g_bp_open = NULL;
+    g_bp_open_target = 1;
+    g_bp_skip = 0;
+    g_bp_last_packets = 0;
+    g_bp_last_samples = 0;
+#endif
+
+    latency_hist_init(&g_latency_hist);
+
+    // [1] 初始化 slab 内存池 (各档位的空闲链表)
+    ESP_ERROR_CHECK(slab_init());
+
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+    ESP_LOGI(TAG, "Backpressure (%s): sample %u B, watermarks %d%% / %d%%, max factor %lu",
+             BP_POLICY_NAME, g_bp_sample_len,
+             CONFIG_IPC_BP_HIGH_WATERMARK_PCT, CONFIG_IPC_BP_LOW_WATERMARK_PCT, (unsigned long)g_bp_max_factor);
+#endif
+
+    // [2] 创建指针队列
+    // 关键点：Item Size 是 sizeof(ipc_var_packet_t*)，也就是 4 字节！
+    // 哪怕载荷有 100MB，这里也只传 4 字节。
+    // 深度 = slab 总块数，能分配到块就一定能入队
+    g_data_queue = xQueueCreate(slab_total_blocks(), sizeof(ipc_var_packet_t*));
+
+    if (g_data_queue == NULL) return ESP_ERR_NO_MEM;
+    ESP_LOGI(TAG, "Footprint: %u bytes (slab %u + pointer queue %u)",
+             (unsigned)(slab_total_bytes() + slab_total_blocks() * sizeof(void *)),
+             (unsigned)slab_total_bytes(), (unsigned)(slab_total_blocks() * sizeof(void *)));
 
     // [3] 创建任务 (Core 1)
     // Stack 可以给小一点了，因为我们不在栈上放 4KB 数据了，只有指针
-    xTaskCreatePinnedToCore(task_consumer_zero_copy, "ZeroConsumer", 4096, NULL, 5, NULL, 1);
+#if CONFIG_IPC_ZERO_COPY_BATCHED
+    ESP_LOGI(TAG, "Batched drain: N=%d, max latency=%d us",
+             CONFIG_IPC_BATCH_MAX_PACKETS, CONFIG_IPC_BATCH_MAX_LATENCY_US);
+    xTaskCreatePinnedToCore(task_consumer_zero_copy_batched, "ZeroConsumer", 4096, NULL, 5, &g_consumer_handle, IPC_CONSUMER_CORE);
+#else
+    xTaskCreatePinnedToCore(task_consumer_zero_copy, "ZeroConsumer", 4096, NULL, 5, &g_consumer_handle, IPC_CONSUMER_CORE);
+#endif
 
     // [4] 启动定时器
     const esp_timer_create_args_t timer_args = {
@@ -130,9 +433,84 @@ esp_err_t ipc_zero_copy_init(void)
     return ESP_OK;
 }
 
-void ipc_zero_copy_start(void)
+static void ipc_zero_copy_start(void)
+{
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+    g_bp_last_report_us = esp_timer_get_time();
+#endif
+    ESP_LOGW(TAG, "Starting Zero-Copy Timer at %lu us...", (unsigned long)g_interval_us);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, g_interval_us));
+}
+
+static void ipc_zero_copy_stop(void)
+{
+    esp_timer_stop(g_timer_handle);
+
+    // 等消费者把在途的包都还给 slab (批量模式下最多再等一个超时周期)
+    for (int i = 0; i < 100 && uxQueueMessagesWaiting(g_data_queue) > 0; i++) {
+        vTaskDelay(1);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+static void ipc_zero_copy_deinit(void)
 {
-    int interval_us = CONFIG_IPC_TIMER_INTERVAL_US;
-    ESP_LOGW(TAG, "Starting Zero-Copy Timer at %d us...", interval_us);
-    ESP_ERROR_CHECK(esp_timer_start_periodic(g_timer_handle, interval_us));
-}
\ No newline at end of file
+    if (g_consumer_handle) {
+        vTaskDelete(g_consumer_handle);
+        g_consumer_handle = NULL;
+    }
+    if (g_timer_handle) {
+        esp_timer_delete(g_timer_handle);
+        g_timer_handle = NULL;
+    }
+    if (g_data_queue) {
+        vQueueDelete(g_data_queue);
+        g_data_queue = NULL;
+    }
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+    // 定时器已删除，合并到一半的包不会再有人发了
+    slab_free(g_bp_open);
+    g_bp_open = NULL;
+#endif
+}
+
+static void ipc_zero_copy_print_stats(void)
+{
+    // 每个档位的占用 / 高水位 / 耗尽次数，用来调 Kconfig 里的档位配置
+    slab_print_stats();
+
+#if CONFIG_IPC_ZERO_COPY_BACKPRESSURE
+    // 有效速率：包/s 是消费者实际被打扰的频率，采样/s 是数据实际到达的速率
+    int64_t now = esp_timer_get_time();
+    uint32_t window_us = (uint32_t)(now - g_bp_last_report_us);
+    if (window_us == 0) {
+        return;
+    }
+    uint32_t packets = g_packets_sent;
+    uint32_t samples = g_samples_delivered;
+    uint32_t pkt_rate = (uint32_t)((uint64_t)(packets - g_bp_last_packets) * 1000000 / window_us);
+    uint32_t sample_rate = (uint32_t)((uint64_t)(samples - g_bp_last_samples) * 1000000 / window_us);
+    g_bp_last_report_us = now;
+    g_bp_last_packets = packets;
+    g_bp_last_samples = samples;
+
+    ESP_LOGI(TAG, "Backpressure: factor %lu | up %lu / down %lu | %lu pkt/s, %lu samples/s | "
+             "produced %lu, delivered %lu, decimated %lu, Lost: %lu",
+             (unsigned long)g_bp_factor, (unsigned long)g_bp_escalations,
+             (unsigned long)g_bp_relaxations, (unsigned long)pkt_rate, (unsigned long)sample_rate,
+             (unsigned long)g_samples_produced, (unsigned long)samples,
+             (unsigned long)g_samples_decimated, (unsigned long)g_packets_lost);
+#endif
+}
+
+const ipc_strategy_t ipc_strategy_zero_copy = {
+    .name = "zero_copy",
+    .init = ipc_zero_copy_init,
+    .start = ipc_zero_copy_start,
+    .stop = ipc_zero_copy_stop,
+    .deinit = ipc_zero_copy_deinit,
+    .print_stats = ipc_zero_copy_print_stats,
+    .latency = &g_latency_hist,
+    .sent = &g_packets_sent,
+    .lost = &g_packets_lost,
+};
\ No newline at end of file
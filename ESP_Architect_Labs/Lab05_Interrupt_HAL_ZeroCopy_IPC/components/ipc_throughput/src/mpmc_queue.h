@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "ipc_throughput.h"
+
+/*
+ * --------------------------------------------------------------------------
+ * 多生产者 / 多消费者 有界无锁队列 (MPMC Queue, Vyukov 算法)
+ * --------------------------------------------------------------------------
+ * 只存放 void* 指针，容量必须是 2 的幂。
+ *
+ * 每个槽位带一个序号 seq：
+ *   seq == pos       -> 槽位空闲，位置 pos 的生产者可以写
+ *   seq == pos + 1   -> 槽位有数据，位置 pos 的消费者可以读
+ * 生产者/消费者先用 CAS 抢到一个位置，再独占地读写对应槽位，
+ * 所以任意多个核、任意多个任务同时 push/pop 都是安全的。
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+    void *data;
+} mpmc_cell_t;
+
+typedef struct {
+    _Atomic uint32_t enqueue_pos __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    _Atomic uint32_t dequeue_pos __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    mpmc_cell_t *cells __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    uint32_t mask;
+} mpmc_queue_t;
+
+/**
+ * @brief 初始化队列
+ * @param cells    外部提供的槽位数组 (capacity 个)
+ * @param capacity 必须是 2 的幂
+ */
+static inline bool mpmc_queue_init(mpmc_queue_t *q, mpmc_cell_t *cells, uint32_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        atomic_store_explicit(&cells[i].seq, i, memory_order_relaxed);
+        cells[i].data = NULL;
+    }
+    q->cells = cells;
+    q->mask = capacity - 1;
+    atomic_store_explicit(&q->enqueue_pos, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->dequeue_pos, 0, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 放入一个指针 (任意上下文，包括 ISR)
+ * @return false 表示队列已满
+ */
+FORCE_INLINE_ATTR bool mpmc_queue_push(mpmc_queue_t *q, void *item)
+{
+    uint32_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    mpmc_cell_t *cell;
+
+    while (1) {
+        cell = &q->cells[pos & q->mask];
+        uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            // 槽位空闲，抢这个位置
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 槽位里还是上一圈的数据：满了
+            return false;
+        } else {
+            // 被别的生产者抢先了，重新读位置
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->data = item;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 取出一个指针 (任意上下文，包括 ISR)
+ * @return false 表示队列为空
+ */
+FORCE_INLINE_ATTR bool mpmc_queue_pop(mpmc_queue_t *q, void **item)
+{
+    uint32_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    mpmc_cell_t *cell;
+
+    while (1) {
+        cell = &q->cells[pos & q->mask];
+        uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            // 槽位有数据，抢这个位置
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 生产者还没写到这里：空了
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    *item = cell->data;
+    // 把槽位交还给下一圈的生产者
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_attr.h"
+#include "sdkconfig.h"
+#include "checksum.h"
+#if CONFIG_IPC_CHECK_CRC32_ROM
+#include "esp_rom_crc.h"
+#endif
+
+/*
+ * 整包校验 (Kconfig: IPC_PAYLOAD_CHECK)
+ * 生产者写完载荷后 p->crc = ipc_payload_check(p->data, len)，
+ * 消费者用 ipc_payload_ok() 核对；只检查首尾标记字节时两者都编译成常量。
+ */
+#if CONFIG_IPC_CHECK_CRC32 || CONFIG_IPC_CHECK_CRC32_ROM || CONFIG_IPC_CHECK_FLETCHER64
+#define IPC_PAYLOAD_CHECKED     1
+#else
+#define IPC_PAYLOAD_CHECKED     0
+#endif
+
+static inline uint32_t IRAM_ATTR ipc_payload_check(const uint8_t *data, uint32_t len)
+{
+#if CONFIG_IPC_CHECK_CRC32
+    return checksum_crc32(0, data, len);
+#elif CONFIG_IPC_CHECK_CRC32_ROM
+    return esp_rom_crc32_le(0, data, len);
+#elif CONFIG_IPC_CHECK_FLETCHER64
+    return checksum_fold64(checksum_fletcher64(data, len));
+#else
+    (void)data;
+    (void)len;
+    return 0;
+#endif
+}
+
+static inline bool ipc_payload_ok(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+#if IPC_PAYLOAD_CHECKED
+    return ipc_payload_check(data, len) == crc;
+#else
+    (void)crc;
+    (void)data;
+    (void)len;
+    return true;
+#endif
+}
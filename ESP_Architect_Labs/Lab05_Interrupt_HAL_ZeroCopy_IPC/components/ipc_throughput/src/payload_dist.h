@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_attr.h"
+#include "ipc_throughput.h"
+
+/*
+ * 模拟真实传感器的载荷长度分布：绝大多数是几十字节的小包，
+ * 偶尔有中等包，极少数是满 4KB 的大包 (例如一帧波形)。
+ *   70%: 2 ~ 48 B   20%: 49 ~ 240 B   8%: 241 ~ 1000 B   2%: 1001 ~ 4096 B
+ *
+ * Zero Copy 和 Bip Buffer 用同一个分布，内存占用和吞吐才有可比性。
+ * state 是调用方自己的随机数状态 (非 0)，ISR 里调用，必须内联。
+ */
+FORCE_INLINE_ATTR uint16_t ipc_pick_payload_len(uint32_t *state)
+{
+    uint32_t s = *state;
+
+    // xorshift32，ISR 里够用且没有除法以外的开销
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    *state = s;
+
+    uint32_t bucket = s % 100;
+    uint32_t r = s >> 8;
+    if (bucket < 70) return 2 + r % 47;   // 至少 2 字节：首尾各一个校验字节
+    if (bucket < 90) return 49 + r % 192;
+    if (bucket < 98) return 241 + r % 760;
+    return 1001 + r % (IPC_PAYLOAD_SIZE - 1000);
+}
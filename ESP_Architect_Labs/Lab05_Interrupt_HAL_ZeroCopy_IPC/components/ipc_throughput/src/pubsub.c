@@ -0,0 +1,104 @@
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "slab_alloc.h"
+#include "pubsub.h"
+
+static const char *TAG = "PUBSUB";
+
+// ----------------------------------------------------------------------
+// 1. 订阅关系 (init 阶段建立)
+// ----------------------------------------------------------------------
+void pubsub_topic_init(pubsub_topic_t *topic, const char *name)
+{
+    topic->name = name;
+    topic->sub_count = 0;
+    for (int i = 0; i < PUBSUB_MAX_SUBSCRIBERS; i++) {
+        topic->subs[i] = NULL;
+    }
+}
+
+esp_err_t pubsub_subscribe(pubsub_topic_t *topic, pubsub_subscriber_t *sub, const char *name,
+                           void **slots, uint32_t depth, TaskHandle_t task)
+{
+    if (topic->sub_count >= PUBSUB_MAX_SUBSCRIBERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (!spsc_ring_init(&sub->ring, slots, depth)) {
+        ESP_LOGE(TAG, "%s: ring depth %lu is not a power of two", name, (unsigned long)depth);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    sub->task = task;
+    sub->name = name;
+    sub->delivered = 0;
+    sub->dropped = 0;
+    topic->subs[topic->sub_count++] = sub;
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 2. 申请 / 发布 / 释放
+// ----------------------------------------------------------------------
+// 引用计数 + 包头 + 满载荷必须落得进 slab 最大档，否则 4KB 的消息永远申请不到
+_Static_assert(sizeof(pubsub_msg_t) + IPC_PAYLOAD_SIZE <= CONFIG_SLAB_CLASS3_SIZE,
+               "SLAB_CLASS3_SIZE too small for a full pubsub_msg_t");
+
+pubsub_msg_t * IRAM_ATTR pubsub_alloc(uint16_t payload_len)
+{
+    pubsub_msg_t *msg = slab_alloc(sizeof(pubsub_msg_t) + payload_len);
+    if (msg != NULL) {
+        msg->pkt.len = payload_len;
+        msg->pkt.count = 1;
+    }
+    return msg;
+}
+
+void IRAM_ATTR pubsub_release(pubsub_msg_t *msg)
+{
+    // acq_rel: 最后一个释放者要看到其他订阅者对块的所有访问都已结束
+    if (__atomic_sub_fetch(&msg->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        slab_free(msg);
+    }
+}
+
+uint32_t IRAM_ATTR pubsub_publish_from_isr(pubsub_topic_t *topic, pubsub_msg_t *msg, BaseType_t *woken)
+{
+    uint32_t delivered = 0;
+
+    // [A] 先把引用一次性全部算上，再投递：
+    //     否则第一个订阅者可能在我们投递第二个之前就把计数减到 0 把块释放掉
+    __atomic_store_n(&msg->refcount, topic->sub_count + 1, __ATOMIC_RELAXED);
+
+    for (uint32_t i = 0; i < topic->sub_count; i++) {
+        pubsub_subscriber_t *sub = topic->subs[i];
+
+        // [B] 环里的 release-store 保证订阅者看到完整的包内容
+        if (spsc_ring_push(&sub->ring, msg)) {
+            sub->delivered++;
+            delivered++;
+            vTaskNotifyGiveFromISR(sub->task, woken);
+        } else {
+            // [C] 这个订阅者积压满了：只丢它的那份，替它释放引用
+            sub->dropped++;
+            pubsub_release(msg);
+        }
+    }
+
+    // [D] 放掉发布者自己的那份
+    pubsub_release(msg);
+    return delivered;
+}
+
+// ----------------------------------------------------------------------
+// 3. 统计
+// ----------------------------------------------------------------------
+void pubsub_print_stats(const pubsub_topic_t *topic)
+{
+    for (uint32_t i = 0; i < topic->sub_count; i++) {
+        pubsub_subscriber_t *sub = topic->subs[i];
+        ESP_LOGI(TAG, "[%s] %-8s delivered %lu | dropped %lu | backlog %lu/%lu",
+                 topic->name, sub->name, (unsigned long)sub->delivered, (unsigned long)sub->dropped,
+                 (unsigned long)spsc_ring_count(&sub->ring), (unsigned long)(sub->ring.mask + 1));
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "ipc_throughput.h"
+#include "spsc_ring.h"
+
+/*
+ * --------------------------------------------------------------------------
+ * 引用计数的零拷贝发布/订阅 (Pub/Sub on the slab pool)
+ * --------------------------------------------------------------------------
+ * 一个包发布一次，N 个订阅者拿到的是同一块内存的指针，谁都不拷贝：
+ *
+ *   ISR --publish--> topic --+--> [SPSC 环] --> logger
+ *                            +--> [SPSC 环] --> control
+ *                            +--> [SPSC 环] --> uplink
+ *
+ * 规则：
+ *   - 每个订阅者一条自己的 SPSC 环 (发布者是唯一写者，订阅者是唯一读者)
+ *   - 发布时 refcount = 订阅者数 + 1 (发布者自己持有一份，投递完再释放)
+ *   - 某个订阅者的环满了：只给它记一次 drop，并替它释放那份引用，
+ *     其他订阅者照常收到，慢订阅者拖不住快订阅者
+ *   - 最后一个 pubsub_release() 把块还给 slab
+ *
+ * 订阅关系只在发布开始前建立 (init 阶段)，运行期不增删，所以 topic 本身不需要锁。
+ */
+
+#define PUBSUB_MAX_SUBSCRIBERS  4
+
+/* 消息 = 引用计数 + 变长包，整块从 slab 申请 */
+typedef struct {
+    uint32_t refcount;              // 原子访问
+    ipc_var_packet_t pkt;
+} pubsub_msg_t;
+
+typedef struct {
+    spsc_ring_t ring;               // 发布者 -> 该订阅者
+    TaskHandle_t task;              // 有新消息时通知它
+    const char *name;
+    volatile uint32_t delivered;    // 成功放进环的消息数 (发布者写)
+    volatile uint32_t dropped;      // 环满被丢的消息数   (发布者写)
+} pubsub_subscriber_t;
+
+typedef struct {
+    const char *name;
+    uint32_t sub_count;
+    pubsub_subscriber_t *subs[PUBSUB_MAX_SUBSCRIBERS];
+} pubsub_topic_t;
+
+/**
+ * @brief 初始化一个 topic (没有订阅者)
+ */
+void pubsub_topic_init(pubsub_topic_t *topic, const char *name);
+
+/**
+ * @brief 注册订阅者，必须在第一次 publish 之前调用
+ * @param slots 订阅者环的存储区 (depth 个指针)
+ * @param depth 环容量，必须是 2 的幂；决定该订阅者最多能落后多少条
+ * @param task  收到消息时被 vTaskNotifyGiveFromISR 通知的任务
+ */
+esp_err_t pubsub_subscribe(pubsub_topic_t *topic, pubsub_subscriber_t *sub, const char *name,
+                           void **slots, uint32_t depth, TaskHandle_t task);
+
+/**
+ * @brief 从 slab 申请一条消息 (ISR 可用)，payload_len 为 pkt.data[] 的字节数
+ * @return NULL 表示池子耗尽
+ */
+pubsub_msg_t *pubsub_alloc(uint16_t payload_len);
+
+/**
+ * @brief 发布消息 (ISR 可用，每个 topic 只能有一个发布上下文)
+ * 调用后发布者不再拥有 msg，不能再访问它
+ * @return 实际投递到的订阅者数
+ */
+uint32_t pubsub_publish_from_isr(pubsub_topic_t *topic, pubsub_msg_t *msg, BaseType_t *woken);
+
+/**
+ * @brief 订阅者取一条消息，用完必须 pubsub_release()
+ */
+FORCE_INLINE_ATTR bool pubsub_receive(pubsub_subscriber_t *sub, pubsub_msg_t **msg)
+{
+    return spsc_ring_pop(&sub->ring, (void **)msg);
+}
+
+/**
+ * @brief 释放一份引用，最后一份把块还给 slab (任意上下文)
+ */
+void pubsub_release(pubsub_msg_t *msg);
+
+/**
+ * @brief 打印每个订阅者的投递/丢弃计数和当前积压
+ */
+void pubsub_print_stats(const pubsub_topic_t *topic);
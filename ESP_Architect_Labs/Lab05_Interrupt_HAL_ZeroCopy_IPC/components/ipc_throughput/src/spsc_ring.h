@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "ipc_throughput.h"
+
+/*
+ * --------------------------------------------------------------------------
+ * 单生产者 / 单消费者 无锁环形队列 (SPSC Ring)
+ * --------------------------------------------------------------------------
+ * 只存放 void* 指针，容量必须是 2 的幂。
+ *
+ * 规则：
+ *   - 只允许 "一个" 上下文调用 push (例如 ISR)
+ *   - 只允许 "一个" 上下文调用 pop  (例如 Consumer Task)
+ * 满足这两点就不需要任何锁，head/tail 各自只被一方写。
+ *
+ * head 和 tail 分别放在独立的缓存行里 (按 IPC_CACHE_LINE_SIZE 对齐)，
+ * 并各自缓存一份对方的索引，只有在 "看起来满/空" 时才去读对方那一行。
+ */
+typedef struct {
+    // ---- 生产者独占的缓存行 ----
+    _Atomic uint32_t head __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    uint32_t cached_tail;                 // 生产者眼中的 tail (可能是旧值)
+
+    // ---- 消费者独占的缓存行 ----
+    _Atomic uint32_t tail __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    uint32_t cached_head;                 // 消费者眼中的 head (可能是旧值)
+
+    // ---- 只读部分 (初始化后不再修改) ----
+    void   **slots __attribute__((aligned(IPC_CACHE_LINE_SIZE)));
+    uint32_t mask;                        // capacity - 1
+} spsc_ring_t;
+
+/**
+ * @brief 初始化环形队列
+ * @param slots    外部提供的存储区 (capacity 个指针)
+ * @param capacity 必须是 2 的幂
+ */
+static inline bool spsc_ring_init(spsc_ring_t *ring, void **slots, uint32_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+    ring->cached_tail = 0;
+    ring->cached_head = 0;
+    ring->slots = slots;
+    ring->mask = capacity - 1;
+    return true;
+}
+
+/**
+ * @brief 生产者：放入一个指针
+ * @return false 表示队列已满
+ *
+ * FORCE_INLINE: 会被 IRAM 里的 ISR 调用，必须内联，不能跳到 Flash 上执行
+ */
+FORCE_INLINE_ATTR bool spsc_ring_push(spsc_ring_t *ring, void *item)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head - ring->cached_tail > ring->mask) {
+        // 看起来满了，再去读一次消费者的真实进度
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head - ring->cached_tail > ring->mask) {
+            return false;
+        }
+    }
+
+    ring->slots[head & ring->mask] = item;
+
+    // release: 保证上面的 slot 写入先于 head 的更新被对方看到
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 消费者：取出一个指针
+ * @return false 表示队列为空
+ */
+FORCE_INLINE_ATTR bool spsc_ring_pop(spsc_ring_t *ring, void **item)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail == ring->cached_head) {
+        // 看起来空了，再去读一次生产者的真实进度
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail == ring->cached_head) {
+            return false;
+        }
+    }
+
+    *item = ring->slots[tail & ring->mask];
+
+    // release: 保证 slot 已经读完，生产者才能覆盖它
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 当前元素个数 (任意一方调用都可以，结果只是一个快照)
+ */
+static inline uint32_t spsc_ring_count(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
@@ -0,0 +1,143 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ipc_throughput.h"
+#include "spsc_ring.h"
+
+static const char *TAG = "SPSC_TEST";
+
+#define TEST_CAPACITY       8
+#define TEST_THREAD_ITEMS   200000
+
+#define CHECK(cond, what) do { if (!(cond)) { ESP_LOGE(TAG, "selftest: %s", what); return ESP_FAIL; } } while (0)
+
+static spsc_ring_t s_ring;
+static void *s_slots[TEST_CAPACITY];
+
+// ----------------------------------------------------------------------
+// 1. 单线程：空 / 满 / 顺序 / 索引回绕
+// ----------------------------------------------------------------------
+static esp_err_t test_full_empty(void)
+{
+    void *item = NULL;
+
+    CHECK(!spsc_ring_init(&s_ring, s_slots, 6), "non power-of-two capacity rejected");
+    CHECK(spsc_ring_init(&s_ring, s_slots, TEST_CAPACITY), "init");
+
+    // [A] 空环 pop 失败
+    CHECK(!spsc_ring_pop(&s_ring, &item), "pop on empty ring");
+    CHECK(spsc_ring_count(&s_ring) == 0, "count on empty ring");
+
+    // [B] 正好放满 capacity 个，第 capacity+1 个失败
+    for (uintptr_t i = 0; i < TEST_CAPACITY; i++) {
+        CHECK(spsc_ring_push(&s_ring, (void *)(i + 1)), "push until full");
+    }
+    CHECK(!spsc_ring_push(&s_ring, (void *)0xdead), "push on full ring");
+    CHECK(spsc_ring_count(&s_ring) == TEST_CAPACITY, "count on full ring");
+
+    // [C] 按放入顺序取出，取空之后又失败
+    for (uintptr_t i = 0; i < TEST_CAPACITY; i++) {
+        CHECK(spsc_ring_pop(&s_ring, &item) && item == (void *)(i + 1), "FIFO order");
+    }
+    CHECK(!spsc_ring_pop(&s_ring, &item), "pop after drain");
+    return ESP_OK;
+}
+
+static esp_err_t test_wraparound(void)
+{
+    void *item = NULL;
+
+    // [A] 槽位回绕：交替 push/pop 远超容量的次数，每次都只差一两个
+    spsc_ring_init(&s_ring, s_slots, TEST_CAPACITY);
+    for (uintptr_t i = 0; i < 10 * TEST_CAPACITY; i++) {
+        CHECK(spsc_ring_push(&s_ring, (void *)(2 * i + 1)), "push (slot wrap)");
+        CHECK(spsc_ring_push(&s_ring, (void *)(2 * i + 2)), "push (slot wrap)");
+        CHECK(spsc_ring_pop(&s_ring, &item) && item == (void *)(2 * i + 1), "order (slot wrap)");
+        CHECK(spsc_ring_pop(&s_ring, &item) && item == (void *)(2 * i + 2), "order (slot wrap)");
+    }
+
+    // [B] 32 位索引回绕：head/tail 从 UINT32_MAX 附近开始，满/空判断靠无符号差值
+    const uint32_t start = UINT32_MAX - TEST_CAPACITY / 2;
+    atomic_store(&s_ring.head, start);
+    atomic_store(&s_ring.tail, start);
+    s_ring.cached_tail = start;
+    s_ring.cached_head = start;
+
+    for (uintptr_t i = 0; i < TEST_CAPACITY; i++) {
+        CHECK(spsc_ring_push(&s_ring, (void *)(i + 1)), "push (index wrap)");
+    }
+    CHECK(!spsc_ring_push(&s_ring, (void *)0xdead), "full across index wrap");
+    CHECK(spsc_ring_count(&s_ring) == TEST_CAPACITY, "count across index wrap");
+    for (uintptr_t i = 0; i < TEST_CAPACITY; i++) {
+        CHECK(spsc_ring_pop(&s_ring, &item) && item == (void *)(i + 1), "order (index wrap)");
+    }
+    CHECK(!spsc_ring_pop(&s_ring, &item), "empty across index wrap");
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 2. 两个任务：生产者按 1, 2, 3 ... 推，消费者必须一个不少、按顺序收到
+// ----------------------------------------------------------------------
+static TaskHandle_t s_waiter = NULL;
+
+static void task_producer(void *arg)
+{
+    for (uintptr_t i = 1; i <= TEST_THREAD_ITEMS; i++) {
+        while (!spsc_ring_push(&s_ring, (void *)i)) {
+            taskYIELD();    // 满了让消费者跑 (单核目标上它们轮流跑)
+        }
+    }
+    xTaskNotifyGive(s_waiter);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t test_two_threads(void)
+{
+    void *item = NULL;
+    uintptr_t expected = 1;
+
+    spsc_ring_init(&s_ring, s_slots, TEST_CAPACITY);
+    s_waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    // 生产者放另一个核 (双核目标上真正并发)
+    if (xTaskCreatePinnedToCore(task_producer, "spsc_test_tx", 2048, NULL,
+                                uxTaskPriorityGet(NULL), NULL,
+                                portNUM_PROCESSORS > 1 ? !xPortGetCoreID() : 0) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 出错也照样收完：生产者推满了会一直等，半路返回它就永远退不出去
+    uint32_t errors = 0;
+    for (uintptr_t n = 0; n < TEST_THREAD_ITEMS; ) {
+        if (!spsc_ring_pop(&s_ring, &item)) {
+            taskYIELD();
+            continue;
+        }
+        if ((uintptr_t)item != expected && errors++ == 0) {
+            ESP_LOGE(TAG, "selftest: got %u, expected %u", (unsigned)(uintptr_t)item, (unsigned)expected);
+        }
+        expected = (uintptr_t)item + 1;
+        n++;
+    }
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    CHECK(errors == 0, "two-task order");
+    CHECK(!spsc_ring_pop(&s_ring, &item), "ring empty after producer finished");
+    return ESP_OK;
+}
+
+esp_err_t ipc_spsc_ring_selftest(void)
+{
+    esp_err_t err = test_full_empty();
+    if (err == ESP_OK) {
+        err = test_wraparound();
+    }
+    if (err == ESP_OK) {
+        err = test_two_threads();
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "SPSC ring selftest passed (%d items across two tasks)", TEST_THREAD_ITEMS);
+    }
+    return err;
+}
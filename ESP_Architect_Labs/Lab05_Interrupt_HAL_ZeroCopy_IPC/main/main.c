@@ -1,10 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "sdkconfig.h"
 #include "ipc_throughput.h" // 引用我们的组件
 
 void app_main(void)
 {
+#if CONFIG_IPC_SPSC_SELFTEST
+    ESP_ERROR_CHECK(ipc_spsc_ring_selftest());
+#endif
+
+#if CONFIG_IPC_BENCH_MATRIX
+    // 扫参模式：所有模式 x 周期 x 载荷在运行时跑一遍，不用每个配置重新烧录
+    ESP_ERROR_CHECK(ipc_bench_run_matrix());
+    ESP_LOGI("main", "Benchmark matrix finished");
+#if CONFIG_IDF_TARGET_LINUX
+    exit(0);    // 主机上跑 (CI)：扫完直接退出进程
+#endif
+    return;
+#endif
+
     // 1. 初始化 IPC 测试组件
     ESP_ERROR_CHECK(ipc_test_init());
 
@@ -15,9 +32,21 @@ void app_main(void)
     ipc_test_start();
 
     // 4. 主任务可以退场了，或者做个简单的监控
+    //    每 100ms 看一眼串口输入：在 monitor 里按 'd' 导出事件跟踪环
+    int ticks = 0;
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(5000));
-        // 这里只是为了让 main task 不退出，虽然 app_main 退出也没事
-        // 实际工作中通常由 watchdog 监控
+        vTaskDelay(pdMS_TO_TICKS(100));
+
+        int c = getchar();  // 默认 UART 控制台是非阻塞的，没有输入时返回 EOF
+        if (c == 'd' || c == 'D') {
+            ipc_test_dump_trace();
+        }
+
+        if (++ticks >= 50) {
+            ticks = 0;
+            // 顺便打印一下当前模式的资源统计 (内存池占用等)
+            // 实际工作中通常由 watchdog 监控
+            ipc_test_print_stats();
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/*
+ * 整包校验用的几个内核，都是 ISR 安全的 (IRAM 代码 + DRAM 查表)：
+ *
+ *   checksum_crc32_bytewise  每字节查一次表 (Sarwate)，参考实现 / 基准对照
+ *   checksum_crc32           slicing-by-8：每次吃 8 字节、8 张表并行查，结果与前者相同
+ *   checksum_fletcher64      按 32 位字累加的 Fletcher-64，不查表，比 CRC 便宜，检错能力稍弱
+ *
+ * CRC32 与 zlib crc32() / esp_rom_crc32_le() 兼容 (多项式 0xEDB88320，初值和结果都取反)，
+ * 可以把上一段的结果当 crc 传进去继续算。
+ */
+
+/**
+ * @brief 生成 CRC 查找表 (8 x 256 x 4 = 8KB，放 DRAM)，用 CRC 内核之前调用一次，重复调用无副作用
+ */
+void checksum_init(void);
+
+/**
+ * @brief 逐字节 CRC32
+ */
+uint32_t checksum_crc32_bytewise(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief slicing-by-8 CRC32
+ */
+uint32_t checksum_crc32(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief Fletcher-64 (32 位字，和对 2^32-1 取模)
+ * 末尾不足 4 字节的部分按补零的一个字处理。起始地址最好 4 字节对齐，否则逐字节拼字会慢很多。
+ * 返回 (sum2 << 32) | sum1
+ */
+uint64_t checksum_fletcher64(const void *buf, size_t len);
+
+/**
+ * @brief 把 64 位校验和折叠成 32 位，放进只有 32 位校验字段的包头
+ */
+static inline uint32_t checksum_fold64(uint64_t sum)
+{
+    return (uint32_t)sum ^ (uint32_t)(sum >> 32);
+}
+
+/**
+ * @brief 各内核在 64/256/1024/4096 字节上的 bytes/cycle，并核对 CRC 内核与 ROM 结果一致
+ * linux 目标上没有周期计数器，返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t checksum_bench_run(void);
+
+/**
+ * @brief 自检：slicing-by-8 CRC32 对照逐字节版本，Fletcher-64 对照按定义逐字取模的参考实现，
+ * 覆盖 0~7 字节的起点错位、随机长度 (最长 4KB) 和分段续算
+ */
+esp_err_t checksum_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+#include <string.h>
+#include <stdbool.h>
+#include "esp_attr.h"
+#include "checksum.h"
+
+// ----------------------------------------------------------------------
+// 1. CRC32 查找表
+// ----------------------------------------------------------------------
+// 反射多项式 (与 zlib / esp_rom_crc32_le 相同)
+#define CRC32_POLY      0xEDB88320u
+
+// s_crc_table[0] 是普通的逐字节表；s_crc_table[k][i] = 字节 i 后面再跟 k 个 0 字节的 CRC，
+// slicing-by-8 用它们把 8 个字节的贡献并行查出来再异或。
+// DRAM_ATTR: 生产者 ISR 会在 Flash Cache 关闭时也可能用到它
+static DRAM_ATTR uint32_t s_crc_table[8][256];
+static bool s_table_ready = false;
+
+void checksum_init(void)
+{
+    if (s_table_ready) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int b = 0; b < 8; b++) {
+            c = (c & 1) ? (c >> 1) ^ CRC32_POLY : (c >> 1);
+        }
+        s_crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = s_crc_table[0][i];
+        for (int k = 1; k < 8; k++) {
+            c = (c >> 8) ^ s_crc_table[0][c & 0xFF];
+            s_crc_table[k][i] = c;
+        }
+    }
+    s_table_ready = true;
+}
+
+// ----------------------------------------------------------------------
+// 2. CRC32 内核
+// ----------------------------------------------------------------------
+static inline uint32_t IRAM_ATTR crc32_bytes(uint32_t crc, const uint8_t *p, size_t len)
+{
+    while (len--) {
+        crc = s_crc_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+uint32_t IRAM_ATTR checksum_crc32_bytewise(uint32_t crc, const void *buf, size_t len)
+{
+    return ~crc32_bytes(~crc, (const uint8_t *)buf, len);
+}
+
+uint32_t IRAM_ATTR checksum_crc32(uint32_t crc, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    crc = ~crc;
+
+    // [A] 先逐字节走到 4 字节对齐，后面才能按字读 (Xtensa 非对齐字访问会异常)
+    size_t head = (4 - ((uintptr_t)p & 3)) & 3;
+    if (head > len) {
+        head = len;
+    }
+    crc = crc32_bytes(crc, p, head);
+    p += head;
+    len -= head;
+
+    // [B] 每次 8 字节：两次 32 位读 + 8 次查表 (小端：低字节在前)
+    const uint32_t *w = (const uint32_t *)p;
+    while (len >= 8) {
+        uint32_t one = *w++ ^ crc;
+        uint32_t two = *w++;
+        crc = s_crc_table[7][one & 0xFF] ^
+              s_crc_table[6][(one >> 8) & 0xFF] ^
+              s_crc_table[5][(one >> 16) & 0xFF] ^
+              s_crc_table[4][one >> 24] ^
+              s_crc_table[3][two & 0xFF] ^
+              s_crc_table[2][(two >> 8) & 0xFF] ^
+              s_crc_table[1][(two >> 16) & 0xFF] ^
+              s_crc_table[0][two >> 24];
+        len -= 8;
+    }
+
+    // [C] 剩下不足 8 字节逐字节收尾
+    crc = crc32_bytes(crc, (const uint8_t *)w, len);
+    return ~crc;
+}
+
+// ----------------------------------------------------------------------
+// 3. Fletcher-64
+// ----------------------------------------------------------------------
+// 两个和都对 2^32-1 取模。64 位累加器里先攒一批再折叠，省掉每个字一次取模：
+// 一批 B 个字之后 sum2 < B^2/2 * 2^32，B = 16384 时远小于 2^64。
+#define FLETCHER_BLOCK_WORDS    16384
+
+static inline uint64_t IRAM_ATTR fold32(uint64_t x)
+{
+    x = (x & 0xFFFFFFFFu) + (x >> 32);
+    return (x & 0xFFFFFFFFu) + (x >> 32);
+}
+
+// 完全约简到 [0, 2^32-1)。不用 % ：64 位取模会调用 libgcc 里 (可能在 Flash 上) 的 __umoddi3
+static inline uint64_t IRAM_ATTR mod32m1(uint64_t x)
+{
+    x = fold32(x);
+    while (x >= 0xFFFFFFFFu) {
+        x -= 0xFFFFFFFFu;
+    }
+    return x;
+}
+
+uint64_t IRAM_ATTR checksum_fletcher64(const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    uint64_t sum1 = 0;
+    uint64_t sum2 = 0;
+    size_t words = len / 4;
+    bool aligned = ((uintptr_t)p & 3) == 0;
+
+    while (words > 0) {
+        size_t n = words < FLETCHER_BLOCK_WORDS ? words : FLETCHER_BLOCK_WORDS;
+        words -= n;
+
+        if (aligned) {
+            const uint32_t *w = (const uint32_t *)p;
+            // 4 路展开：循环开销摊到 16 字节上
+            while (n >= 4) {
+                sum1 += w[0]; sum2 += sum1;
+                sum1 += w[1]; sum2 += sum1;
+                sum1 += w[2]; sum2 += sum1;
+                sum1 += w[3]; sum2 += sum1;
+                w += 4;
+                n -= 4;
+            }
+            while (n--) {
+                sum1 += *w++;
+                sum2 += sum1;
+            }
+            p = (const uint8_t *)w;
+        } else {
+            while (n--) {
+                uint32_t v;
+                memcpy(&v, p, 4);
+                p += 4;
+                sum1 += v;
+                sum2 += sum1;
+            }
+        }
+
+        sum1 = fold32(sum1);
+        sum2 = fold32(sum2);
+    }
+
+    // 末尾 1~3 字节补零当作一个字
+    size_t tail = len & 3;
+    if (tail) {
+        uint32_t v = 0;
+        memcpy(&v, p, tail);
+        sum1 += v;
+        sum2 += sum1;
+    }
+
+    sum1 = mod32m1(sum1);
+    sum2 = mod32m1(sum2);
+    return (sum2 << 32) | sum1;
+}
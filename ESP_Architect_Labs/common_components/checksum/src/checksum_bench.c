@@ -0,0 +1,103 @@
+#include "sdkconfig.h"
+
+// 要读周期计数器，和 ROM 对答案也只在芯片上有意义
+#if !CONFIG_IDF_TARGET_LINUX
+
+#include <stdio.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "checksum.h"
+
+static const char *TAG = "CHECKSUM";
+
+// ----------------------------------------------------------------------
+// 1. 被测内核
+// ----------------------------------------------------------------------
+#define BENCH_MAX_LEN   4096
+#define BENCH_REPEAT    16
+
+typedef uint32_t (*bench_kernel_t)(const uint8_t *buf, size_t len);
+
+static uint32_t k_crc32_bytewise(const uint8_t *buf, size_t len) { return checksum_crc32_bytewise(0, buf, len); }
+static uint32_t k_crc32_slice8(const uint8_t *buf, size_t len)   { return checksum_crc32(0, buf, len); }
+static uint32_t k_crc32_rom(const uint8_t *buf, size_t len)      { return esp_rom_crc32_le(0, buf, len); }
+static uint32_t k_fletcher64(const uint8_t *buf, size_t len)     { return checksum_fold64(checksum_fletcher64(buf, len)); }
+
+static const struct {
+    const char *name;
+    bench_kernel_t fn;
+} s_kernels[] = {
+    { "crc32_bytewise", k_crc32_bytewise },
+    { "crc32_slice8",   k_crc32_slice8 },
+    { "crc32_rom",      k_crc32_rom },
+    { "fletcher64",     k_fletcher64 },
+};
+
+static const uint32_t s_sizes[] = { 64, 256, 1024, 4096 };
+
+// 内部 SRAM 里的测试数据，和 IPC 包所在的内存一致
+static uint8_t s_buf[BENCH_MAX_LEN] __attribute__((aligned(4)));
+
+// ----------------------------------------------------------------------
+// 2. 基准
+// ----------------------------------------------------------------------
+esp_err_t checksum_bench_run(void)
+{
+    checksum_init();
+
+    uint32_t x = 0x12345678;
+    for (int i = 0; i < BENCH_MAX_LEN; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        s_buf[i] = (uint8_t)x;
+    }
+
+    // [A] 先对答案：三个 CRC 内核必须和 ROM 结果一致 (含非对齐起点和零头)
+    for (uint32_t off = 0; off < 4; off++) {
+        for (uint32_t len = 0; len <= 67; len++) {
+            uint32_t ref = esp_rom_crc32_le(0, s_buf + off, len);
+            if (checksum_crc32(0, s_buf + off, len) != ref ||
+                checksum_crc32_bytewise(0, s_buf + off, len) != ref) {
+                ESP_LOGE(TAG, "CRC32 mismatch vs ROM at offset %lu len %lu",
+                         (unsigned long)off, (unsigned long)len);
+                return ESP_FAIL;
+            }
+        }
+    }
+
+    // [B] 每个内核 x 每个长度：重复 BENCH_REPEAT 次取最好的一次 (排除被打断的样本)
+    printf("CHECKSUM_BENCH_BEGIN\n");
+    printf("kernel,bytes,cycles,bytes_per_cycle\n");
+    for (size_t k = 0; k < sizeof(s_kernels) / sizeof(s_kernels[0]); k++) {
+        for (size_t s = 0; s < sizeof(s_sizes) / sizeof(s_sizes[0]); s++) {
+            uint32_t len = s_sizes[s];
+            uint32_t best = UINT32_MAX;
+            volatile uint32_t sink = 0;
+
+            for (int r = 0; r < BENCH_REPEAT; r++) {
+                uint32_t t0 = esp_cpu_get_cycle_count();
+                sink ^= s_kernels[k].fn(s_buf, len);
+                uint32_t dt = esp_cpu_get_cycle_count() - t0;
+                if (dt < best) {
+                    best = dt;
+                }
+            }
+            (void)sink;
+            printf("%s,%lu,%lu,%.3f\n", s_kernels[k].name, (unsigned long)len, (unsigned long)best,
+                   best ? (float)len / best : 0.0f);
+        }
+    }
+    printf("CHECKSUM_BENCH_END\n");
+    return ESP_OK;
+}
+
+#else
+
+#include "checksum.h"
+
+esp_err_t checksum_bench_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // !CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,96 @@
+#include <string.h>
+#include "esp_log.h"
+#include "checksum.h"
+
+static const char *TAG = "CHECKSUM_TEST";
+
+#define TEST_MAX_LEN    4096
+#define TEST_MAX_OFFSET 8
+#define TEST_ROUNDS     512
+
+#define CHECK(cond, what, off, len) do { \
+        if (!(cond)) { \
+            ESP_LOGE(TAG, "selftest: %s at offset %u len %u", what, (unsigned)(off), (unsigned)(len)); \
+            return ESP_FAIL; \
+        } \
+    } while (0)
+
+// 多留 TEST_MAX_OFFSET 字节，起点可以在对齐地址之后任意错开
+static uint8_t s_buf[TEST_MAX_LEN + TEST_MAX_OFFSET] __attribute__((aligned(4)));
+
+// ----------------------------------------------------------------------
+// 1. 参考实现
+// ----------------------------------------------------------------------
+// 逐字按定义算：小端拼字，末尾不足 4 字节补零，每一步都直接取模
+static uint64_t fletcher64_reference(const uint8_t *p, size_t len)
+{
+    uint64_t sum1 = 0;
+    uint64_t sum2 = 0;
+
+    for (size_t i = 0; i < len; i += 4) {
+        uint32_t w = 0;
+        for (size_t b = 0; b < 4 && i + b < len; b++) {
+            w |= (uint32_t)p[i + b] << (8 * b);
+        }
+        sum1 = (sum1 + w) % 0xFFFFFFFFu;
+        sum2 = (sum2 + sum1) % 0xFFFFFFFFu;
+    }
+    return (sum2 << 32) | sum1;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// ----------------------------------------------------------------------
+// 2. 自检
+// ----------------------------------------------------------------------
+esp_err_t checksum_selftest(void)
+{
+    checksum_init();
+
+    uint32_t rng = 0x9E3779B9;
+    for (size_t i = 0; i < sizeof(s_buf); i++) {
+        s_buf[i] = (uint8_t)xorshift32(&rng);
+    }
+
+    // [A] 短长度逐个扫：覆盖对齐前奏、8 字节主循环、收尾的每一种组合
+    for (uint32_t off = 0; off < TEST_MAX_OFFSET; off++) {
+        for (uint32_t len = 0; len <= 67; len++) {
+            const uint8_t *p = s_buf + off;
+            CHECK(checksum_crc32(0, p, len) == checksum_crc32_bytewise(0, p, len),
+                  "crc32 != bytewise", off, len);
+            CHECK(checksum_fletcher64(p, len) == fletcher64_reference(p, len),
+                  "fletcher64 != reference", off, len);
+        }
+    }
+
+    // [B] 随机起点 + 随机长度 (直到 4KB)，另外在随机位置切成两段续算
+    for (int r = 0; r < TEST_ROUNDS; r++) {
+        uint32_t off = xorshift32(&rng) % TEST_MAX_OFFSET;
+        uint32_t len = xorshift32(&rng) % (TEST_MAX_LEN + 1);
+        uint32_t split = len ? xorshift32(&rng) % (len + 1) : 0;
+        const uint8_t *p = s_buf + off;
+
+        uint32_t ref = checksum_crc32_bytewise(0, p, len);
+        CHECK(checksum_crc32(0, p, len) == ref, "crc32 != bytewise", off, len);
+        CHECK(checksum_crc32(checksum_crc32(0, p, split), p + split, len - split) == ref,
+              "crc32 chained", off, len);
+        CHECK(checksum_fletcher64(p, len) == fletcher64_reference(p, len),
+              "fletcher64 != reference", off, len);
+    }
+
+    // [C] 全 0xFF：sum1/sum2 都会碰到 2^32-1，检查取模边界 (结果应落在 [0, 2^32-1))
+    memset(s_buf, 0xFF, sizeof(s_buf));
+    for (uint32_t len = 0; len <= TEST_MAX_LEN; len += 4) {
+        CHECK(checksum_fletcher64(s_buf, len) == fletcher64_reference(s_buf, len),
+              "fletcher64 all-ones", 0, len);
+    }
+
+    ESP_LOGI(TAG, "Checksum selftest passed (%d random rounds)", TEST_ROUNDS);
+    return ESP_OK;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+/*
+ * 几种拷贝内核，都要求调用方保证对齐 (用 copy_kernel_supported 检查)：
+ *
+ *   MEMCPY  newlib memcpy，基准线
+ *   WORD32  32 位字拷贝，8 路展开 (每圈 32 字节)；地址 4 字节对齐、长度 4 的倍数
+ *   VEC128  ESP32-S3 PIE 128 位向量读写 (每圈 64 字节)；地址 16 字节对齐、长度 16 的倍数，
+ *           只能在任务上下文用 (PIE 协处理器状态在中断里不保存)
+ *   DMA     esp_async_memcpy (GDMA)，CPU 只负责发起和等完成；两端都必须是 DMA 可达内存
+ */
+typedef enum {
+    COPY_KERNEL_MEMCPY = 0,
+    COPY_KERNEL_WORD32,
+    COPY_KERNEL_VEC128,
+    COPY_KERNEL_DMA,
+    COPY_KERNEL_COUNT,
+} copy_kernel_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/**
+ * @brief 内核名 (基准输出用)
+ */
+const char *copy_kernel_name(copy_kernel_t kernel);
+
+/**
+ * @brief 当前芯片上这个内核能否拷贝这对地址 / 长度 (目标芯片、对齐、内存区域)
+ */
+bool copy_kernel_supported(copy_kernel_t kernel, const void *dst, const void *src, size_t n);
+
+/**
+ * @brief 32 位字拷贝 (IRAM，ISR 安全)
+ */
+void copy_word32(void *dst, const void *src, size_t n);
+
+/**
+ * @brief 128 位向量拷贝 (仅 ESP32-S3，其他芯片退化为 copy_word32)
+ */
+void copy_vec128(void *dst, const void *src, size_t n);
+
+/**
+ * @brief 安装 async memcpy 驱动 (不支持的芯片返回 ESP_ERR_NOT_SUPPORTED)
+ */
+esp_err_t copy_dma_init(void);
+
+/**
+ * @brief 卸载 async memcpy 驱动
+ */
+void copy_dma_deinit(void);
+
+/**
+ * @brief 用 DMA 拷贝并忙等完成 (任务上下文)
+ * 忙等而不是阻塞在信号量上：测的是搬运本身，不想把调度延迟算进去
+ */
+esp_err_t copy_dma_sync(void *dst, const void *src, size_t n);
+
+/**
+ * @brief 按内核分发 (DMA 走 copy_dma_sync)
+ */
+esp_err_t copy_kernel_run(copy_kernel_t kernel, void *dst, const void *src, size_t n);
+
+/**
+ * @brief 每个内核 x 源/目的内存区域 (DRAM / IRAM / PSRAM) x 长度 的 bytes/cycle
+ * CSV 输出在 COPY_BENCH_BEGIN / COPY_BENCH_END 之间；不支持的组合不输出
+ * linux 目标上返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t copy_kernel_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,219 @@
+#include <string.h>
+#include "esp_attr.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_memory_utils.h"
+#include "soc/soc_caps.h"
+#endif
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+#include "esp_async_memcpy.h"
+#endif
+#include "copy_kernel.h"
+
+// DMA 访问 PSRAM 时地址和长度都要按这个对齐 (同时也是 S3 的 D-Cache 行大小上限)
+#define COPY_DMA_EXT_ALIGN  64
+
+// ----------------------------------------------------------------------
+// 1. CPU 内核
+// ----------------------------------------------------------------------
+/*
+ * 不让 GCC 把下面的循环识别成 "这就是 memcpy" 再替换回库函数调用，
+ * 否则测出来的还是 newlib 的 memcpy。
+ */
+#define NO_MEMCPY_IDIOM     __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+void IRAM_ATTR NO_MEMCPY_IDIOM copy_word32(void *dst, const void *src, size_t n)
+{
+    uint32_t *d = (uint32_t *)dst;
+    const uint32_t *s = (const uint32_t *)src;
+    size_t words = n / 4;
+
+    // 先把 8 个字全部读进寄存器再写：读和写分开排队，load-use 停顿能被后面的 load 盖住
+    while (words >= 8) {
+        uint32_t a = s[0], b = s[1], c = s[2], e = s[3];
+        uint32_t f = s[4], g = s[5], h = s[6], i = s[7];
+        d[0] = a; d[1] = b; d[2] = c; d[3] = e;
+        d[4] = f; d[5] = g; d[6] = h; d[7] = i;
+        s += 8;
+        d += 8;
+        words -= 8;
+    }
+    while (words--) {
+        *d++ = *s++;
+    }
+}
+
+void IRAM_ATTR copy_vec128(void *dst, const void *src, size_t n)
+{
+#if CONFIG_IDF_TARGET_ESP32S3
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t blocks = n / 64;
+
+    // 每圈 4 x 128 位读 + 4 x 128 位写，指针由 .ip 后缀自增。
+    // 不用 loop 零开销循环指令：调用方所在的循环可能已经占用了 LBEG/LEND
+    if (blocks > 0) {
+        __asm__ volatile (
+            "1:\n"
+            "ee.vld.128.ip q0, %1, 16\n"
+            "ee.vld.128.ip q1, %1, 16\n"
+            "ee.vld.128.ip q2, %1, 16\n"
+            "ee.vld.128.ip q3, %1, 16\n"
+            "ee.vst.128.ip q0, %0, 16\n"
+            "ee.vst.128.ip q1, %0, 16\n"
+            "ee.vst.128.ip q2, %0, 16\n"
+            "ee.vst.128.ip q3, %0, 16\n"
+            "addi %2, %2, -1\n"
+            "bnez %2, 1b\n"
+            : "+r"(d), "+r"(s), "+r"(blocks)
+            :
+            : "memory");
+    }
+
+    // 不足 64 字节的尾巴 (16 的倍数) 交给字拷贝
+    copy_word32(d, s, n & 63);
+#else
+    copy_word32(dst, src, n);
+#endif
+}
+
+// ----------------------------------------------------------------------
+// 2. DMA (async memcpy)
+// ----------------------------------------------------------------------
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+static async_memcpy_handle_t s_dma = NULL;
+static volatile bool s_dma_done = false;
+
+static bool IRAM_ATTR dma_done_cb(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *arg)
+{
+    s_dma_done = true;
+    return false;
+}
+
+esp_err_t copy_dma_init(void)
+{
+    if (s_dma != NULL) {
+        return ESP_OK;
+    }
+    async_memcpy_config_t cfg = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    cfg.backlog = 4;
+    cfg.sram_trans_align = 4;
+    cfg.psram_trans_align = COPY_DMA_EXT_ALIGN;
+    return esp_async_memcpy_install(&cfg, &s_dma);
+}
+
+void copy_dma_deinit(void)
+{
+    if (s_dma != NULL) {
+        esp_async_memcpy_uninstall(s_dma);
+        s_dma = NULL;
+    }
+}
+
+esp_err_t copy_dma_sync(void *dst, const void *src, size_t n)
+{
+    if (s_dma == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_dma_done = false;
+    esp_err_t err = esp_async_memcpy(s_dma, dst, (void *)src, n, dma_done_cb, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+    while (!s_dma_done) {
+        // 忙等：完成回调在中断里置位
+    }
+    return ESP_OK;
+}
+
+#else
+esp_err_t copy_dma_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void copy_dma_deinit(void)
+{
+}
+
+esp_err_t copy_dma_sync(void *dst, const void *src, size_t n)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
+
+// ----------------------------------------------------------------------
+// 3. 能力检查 / 分发
+// ----------------------------------------------------------------------
+static const char *const s_names[COPY_KERNEL_COUNT] = {
+    [COPY_KERNEL_MEMCPY] = "memcpy",
+    [COPY_KERNEL_WORD32] = "word32",
+    [COPY_KERNEL_VEC128] = "vec128",
+    [COPY_KERNEL_DMA]    = "dma",
+};
+
+const char *copy_kernel_name(copy_kernel_t kernel)
+{
+    return kernel < COPY_KERNEL_COUNT ? s_names[kernel] : "?";
+}
+
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+static bool dma_reachable(const void *p, size_t n)
+{
+    if (esp_ptr_external_ram(p)) {
+        return esp_ptr_dma_ext_capable(p) && (((uintptr_t)p | n) & (COPY_DMA_EXT_ALIGN - 1)) == 0;
+    }
+    return esp_ptr_dma_capable(p);
+}
+#endif
+
+bool copy_kernel_supported(copy_kernel_t kernel, const void *dst, const void *src, size_t n)
+{
+    uintptr_t bits = (uintptr_t)dst | (uintptr_t)src | n;
+#if CONFIG_IDF_TARGET_LINUX
+    bool touches_iram = false;      // 主机上只有普通内存
+#else
+    // IRAM 只能按 32 位访问 (ESP32 上字节访问会触发 LoadStoreError)，PIE 的 128 位读写也不行
+    bool touches_iram = esp_ptr_in_iram(dst) || esp_ptr_in_iram(src);
+#endif
+
+    switch (kernel) {
+    case COPY_KERNEL_MEMCPY:
+        return !touches_iram;
+    case COPY_KERNEL_WORD32:
+        return (bits & 3) == 0;
+    case COPY_KERNEL_VEC128:
+#if CONFIG_IDF_TARGET_ESP32S3
+        return (bits & 15) == 0 && !touches_iram;
+#else
+        return false;
+#endif
+    case COPY_KERNEL_DMA:
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+        return (bits & 3) == 0 && dma_reachable(dst, n) && dma_reachable(src, n);
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+esp_err_t copy_kernel_run(copy_kernel_t kernel, void *dst, const void *src, size_t n)
+{
+    switch (kernel) {
+    case COPY_KERNEL_MEMCPY:
+        memcpy(dst, src, n);
+        return ESP_OK;
+    case COPY_KERNEL_WORD32:
+        copy_word32(dst, src, n);
+        return ESP_OK;
+    case COPY_KERNEL_VEC128:
+        copy_vec128(dst, src, n);
+        return ESP_OK;
+    case COPY_KERNEL_DMA:
+        return copy_dma_sync(dst, src, n);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
@@ -0,0 +1,160 @@
+#include "sdkconfig.h"
+
+// 周期计数器和 DRAM / IRAM / PSRAM 区域只在芯片上有
+#if !CONFIG_IDF_TARGET_LINUX
+
+#include <stdio.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "copy_kernel.h"
+
+static const char *TAG = "COPY_BENCH";
+
+// ----------------------------------------------------------------------
+// 1. 参数
+// ----------------------------------------------------------------------
+#define BENCH_MAX_LEN   4096
+#define BENCH_ALIGN     64          // 满足所有内核 (含 PSRAM DMA) 的对齐要求
+#define BENCH_REPEAT    16
+
+static const uint32_t s_sizes[] = { 64, 512, 4096 };
+
+typedef struct {
+    const char *name;
+    uint32_t caps;
+} bench_region_t;
+
+static const bench_region_t s_regions[] = {
+    { "dram",  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | MALLOC_CAP_DMA },
+    { "iram",  MALLOC_CAP_EXEC | MALLOC_CAP_32BIT },     // 开了内存保护时分配不到，跳过
+#if CONFIG_SPIRAM
+    { "psram", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT },
+#endif
+};
+
+#define REGION_COUNT    (sizeof(s_regions) / sizeof(s_regions[0]))
+
+// ----------------------------------------------------------------------
+// 2. 工具 (全部按字访问，IRAM 里的缓冲区也能用)
+// ----------------------------------------------------------------------
+static void fill_words(uint32_t *p, size_t n, uint32_t seed)
+{
+    for (size_t i = 0; i < n / 4; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        p[i] = seed;
+    }
+}
+
+static bool equal_words(const uint32_t *a, const uint32_t *b, size_t n)
+{
+    for (size_t i = 0; i < n / 4; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 重复 BENCH_REPEAT 次取最好的一次 (排除被中断打断的样本)；失败返回 0
+static uint32_t time_copy(copy_kernel_t k, void *dst, const void *src, size_t n)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        uint32_t t0 = esp_cpu_get_cycle_count();
+        if (copy_kernel_run(k, dst, src, n) != ESP_OK) {
+            return 0;
+        }
+        uint32_t dt = esp_cpu_get_cycle_count() - t0;
+        if (dt < best) {
+            best = dt;
+        }
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------
+// 3. 基准
+// ----------------------------------------------------------------------
+esp_err_t copy_kernel_bench_run(void)
+{
+    void *bufs[REGION_COUNT][2] = { 0 };    // 每个区域一块源、一块目的
+    bool dma_ok = (copy_dma_init() == ESP_OK);
+
+    for (size_t r = 0; r < REGION_COUNT; r++) {
+        bufs[r][0] = heap_caps_aligned_alloc(BENCH_ALIGN, BENCH_MAX_LEN, s_regions[r].caps);
+        bufs[r][1] = heap_caps_aligned_alloc(BENCH_ALIGN, BENCH_MAX_LEN, s_regions[r].caps);
+        if (bufs[r][0] == NULL || bufs[r][1] == NULL) {
+            ESP_LOGW(TAG, "region %s: allocation failed, skipped", s_regions[r].name);
+            heap_caps_free(bufs[r][0]);
+            heap_caps_free(bufs[r][1]);
+            bufs[r][0] = bufs[r][1] = NULL;
+        }
+    }
+
+    printf("COPY_BENCH_BEGIN\n");
+    printf("kernel,src,dst,bytes,cycles,bytes_per_cycle\n");
+
+    for (int k = 0; k < COPY_KERNEL_COUNT; k++) {
+        if (k == COPY_KERNEL_DMA && !dma_ok) {
+            continue;
+        }
+        for (size_t rs = 0; rs < REGION_COUNT; rs++) {
+            for (size_t rd = 0; rd < REGION_COUNT; rd++) {
+                void *src = bufs[rs][0];
+                void *dst = bufs[rd][1];
+                if (src == NULL || dst == NULL) {
+                    continue;
+                }
+
+                for (size_t s = 0; s < sizeof(s_sizes) / sizeof(s_sizes[0]); s++) {
+                    uint32_t len = s_sizes[s];
+                    if (!copy_kernel_supported(k, dst, src, len)) {
+                        continue;
+                    }
+
+                    fill_words(src, len, len + k);
+                    fill_words(dst, len, 0);
+                    uint32_t cycles = time_copy(k, dst, src, len);
+                    if (cycles == 0) {
+                        continue;
+                    }
+
+                    // DMA 写 PSRAM 绕过 Cache，CPU 读到的可能是旧行，不做比对
+                    bool check = !(k == COPY_KERNEL_DMA && esp_ptr_external_ram(dst));
+                    if (check && !equal_words(dst, src, len)) {
+                        ESP_LOGE(TAG, "%s %s->%s %lu B: data mismatch",
+                                 copy_kernel_name(k), s_regions[rs].name, s_regions[rd].name, (unsigned long)len);
+                        continue;
+                    }
+
+                    printf("%s,%s,%s,%lu,%lu,%.3f\n", copy_kernel_name(k),
+                           s_regions[rs].name, s_regions[rd].name, (unsigned long)len, (unsigned long)cycles,
+                           (float)len / cycles);
+                }
+            }
+        }
+    }
+
+    printf("COPY_BENCH_END\n");
+
+    for (size_t r = 0; r < REGION_COUNT; r++) {
+        heap_caps_free(bufs[r][0]);
+        heap_caps_free(bufs[r][1]);
+    }
+    copy_dma_deinit();
+    return ESP_OK;
+}
+
+#else
+
+#include "copy_kernel.h"
+
+esp_err_t copy_kernel_bench_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // !CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+#define CPU_LOAD_MAX_CORES  2
+#define CPU_LOAD_TOP_TASKS_MAX  8       // 报告里最多带几个任务 (CPU_LOAD_TOP_TASKS 的上限)
+#define CPU_LOAD_TASK_NAME_LEN  16
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+/* 窗口内占比最高的一个任务 */
+typedef struct {
+    char     name[CPU_LOAD_TASK_NAME_LEN];
+    int8_t   core;                                  // 绑定的核，-1 = 不绑核 / 拿不到
+    uint16_t permille;                              // 占窗口的千分比
+} cpu_load_task_t;
+
+/* 一个测量窗口的结果 */
+typedef struct {
+    uint32_t window_us;                             // 窗口长度 (esp_timer)
+    uint32_t busy_permille[CPU_LOAD_MAX_CORES];     // 每个核的忙碌千分比 (非 idle 任务的时间)
+    uint64_t busy_cycles;                           // 所有核忙碌周期之和 (按默认主频换算)
+    uint32_t top_count;                             // top[] 里有效的个数
+    cpu_load_task_t top[CPU_LOAD_TOP_TASKS_MAX];    // 占比从高到低，最多 CONFIG_CPU_LOAD_TOP_TASKS 个
+} cpu_load_report_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/*
+ * 用法：
+ *   cpu_load_window_begin();
+ *   ... 跑负载 ...
+ *   cpu_load_window_end(&r);
+ *   cpu_load_print("zero_copy", &r, packets, "pkt");   // 顺便算出 cycles/pkt
+ *
+ * 同一时间只能有一个窗口 (内部只有一份快照)；结果全在报告里，存下来以后再打印也可以。
+ * 关闭 CPU_LOAD_MONITOR 时 begin/end 返回 ESP_ERR_NOT_SUPPORTED，print 什么也不做。
+ */
+
+/**
+ * @brief 开始一个窗口：记录所有任务的运行时间计数
+ */
+esp_err_t cpu_load_window_begin(void);
+
+/**
+ * @brief 结束窗口：算出每个核的忙碌比例和占比最高的几个任务
+ */
+esp_err_t cpu_load_window_end(cpu_load_report_t *out);
+
+/**
+ * @brief 打印报告里每个核的忙碌比例、占比最高的几个任务
+ * @param ops     窗口内完成的操作数 (包数 / 加法次数)，> 0 时额外打印每次操作的周期数
+ * @param op_name 操作的单位名，例如 "pkt"、"op"
+ */
+void cpu_load_print(const char *label, const cpu_load_report_t *r, uint32_t ops, const char *op_name);
+
+/**
+ * @brief 每次操作的忙碌周期 (ops 为 0 时返回 0)
+ */
+static inline uint32_t cpu_load_cycles_per_op(const cpu_load_report_t *r, uint32_t ops)
+{
+    return ops ? (uint32_t)(r->busy_cycles / ops) : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "cpu_load.h"
+
+static const char *TAG = "CPU_LOAD";
+
+#if CONFIG_CPU_LOAD_MONITOR
+
+// ----------------------------------------------------------------------
+// 1. 快照
+// ----------------------------------------------------------------------
+#define MAX_TASKS   CONFIG_CPU_LOAD_MAX_TASKS
+#define CORES       ((portNUM_PROCESSORS < CPU_LOAD_MAX_CORES) ? portNUM_PROCESSORS : CPU_LOAD_MAX_CORES)
+#define TOP_TASKS   ((CONFIG_CPU_LOAD_TOP_TASKS < CPU_LOAD_TOP_TASKS_MAX) ? CONFIG_CPU_LOAD_TOP_TASKS : CPU_LOAD_TOP_TASKS_MAX)
+
+typedef struct {
+    TaskStatus_t tasks[MAX_TASKS];
+    UBaseType_t  count;
+    uint32_t     total;         // 运行时间计数器当前值 (与任务计数同一单位)
+    int64_t      us;            // esp_timer 时间，用来换算周期
+} load_snapshot_t;
+
+// 忙碌时间换算成周期用的主频；linux 目标没有这个配置，按 1 MHz 算 (cyc/op 即每次操作的忙碌微秒数)
+#ifdef CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define CPU_MHZ     CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#else
+#define CPU_MHZ     1
+#endif
+
+// FreeRTOS 10.4 (IDF 5.0/5.1) 还没有这个宏，计数器固定是 32 位
+#ifndef configRUN_TIME_COUNTER_TYPE
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+#endif
+
+static load_snapshot_t s_begin;
+static load_snapshot_t s_end;
+static bool s_open = false;
+
+static void take_snapshot(load_snapshot_t *snap)
+{
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    snap->count = uxTaskGetSystemState(snap->tasks, MAX_TASKS, &total);
+    snap->total = (uint32_t)total;
+    snap->us = esp_timer_get_time();
+}
+
+// 任务不在快照里 (窗口中途创建 / 超出 MAX_TASKS) 时返回 0
+static uint32_t runtime_of(const load_snapshot_t *snap, TaskHandle_t handle)
+{
+    for (UBaseType_t i = 0; i < snap->count; i++) {
+        if (snap->tasks[i].xHandle == handle) {
+            return (uint32_t)snap->tasks[i].ulRunTimeCounter;
+        }
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// 2. 窗口
+// ----------------------------------------------------------------------
+esp_err_t cpu_load_window_begin(void)
+{
+    take_snapshot(&s_begin);
+    if (s_begin.count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, raise CPU_LOAD_MAX_TASKS", MAX_TASKS);
+        return ESP_ERR_NO_MEM;
+    }
+    s_open = true;
+    return ESP_OK;
+}
+
+esp_err_t cpu_load_window_end(cpu_load_report_t *out)
+{
+    if (!s_open) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    take_snapshot(&s_end);
+    s_open = false;
+    if (s_end.count == 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(out, 0, sizeof(*out));
+    uint32_t window = s_end.total - s_begin.total;
+    out->window_us = (uint32_t)(s_end.us - s_begin.us);
+    if (window == 0) {
+        return ESP_OK;
+    }
+
+    // 核的忙碌时间 = 窗口 - 该核 idle 任务跑的时间
+    for (int c = 0; c < CORES; c++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(c);
+        uint32_t idle_run = runtime_of(&s_end, idle) - runtime_of(&s_begin, idle);
+        if (idle_run > window) {
+            idle_run = window;
+        }
+        uint32_t busy = window - idle_run;
+        out->busy_permille[c] = (uint32_t)((uint64_t)busy * 1000 / window);
+        out->busy_cycles += (uint64_t)busy * out->window_us / window * CPU_MHZ;
+    }
+
+    // 占比最高的几个任务 (每次选出剩下里最大的，N 很小，不用排序整个数组)
+    bool used[MAX_TASKS] = { 0 };
+    for (int n = 0; n < TOP_TASKS; n++) {
+        int best = -1;
+        uint32_t best_run = 0;
+        for (UBaseType_t i = 0; i < s_end.count; i++) {
+            uint32_t run = (uint32_t)s_end.tasks[i].ulRunTimeCounter - runtime_of(&s_begin, s_end.tasks[i].xHandle);
+            if (!used[i] && run > best_run) {
+                best = i;
+                best_run = run;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        used[best] = true;
+
+        const TaskStatus_t *t = &s_end.tasks[best];
+        cpu_load_task_t *top = &out->top[out->top_count++];
+        snprintf(top->name, sizeof(top->name), "%s", t->pcTaskName);
+#if configTASKLIST_INCLUDE_COREID
+        top->core = (t->xCoreID == tskNO_AFFINITY) ? -1 : (int8_t)t->xCoreID;
+#else
+        top->core = -1;
+#endif
+        top->permille = (uint16_t)((uint64_t)best_run * 1000 / window);
+    }
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 3. 打印
+// ----------------------------------------------------------------------
+void cpu_load_print(const char *label, const cpu_load_report_t *r, uint32_t ops, const char *op_name)
+{
+    char line[128];
+    int len = snprintf(line, sizeof(line), "[%s] %lu ms |", label, (unsigned long)(r->window_us / 1000));
+    for (int c = 0; c < CORES && len < (int)sizeof(line); c++) {
+        len += snprintf(line + len, sizeof(line) - len, " core%d %lu.%lu%% |",
+                        c, (unsigned long)(r->busy_permille[c] / 10),
+                        (unsigned long)(r->busy_permille[c] % 10));
+    }
+    if (ops > 0 && len < (int)sizeof(line)) {
+        snprintf(line + len, sizeof(line) - len, " %lu cyc/%s",
+                 (unsigned long)cpu_load_cycles_per_op(r, ops), op_name);
+    }
+    ESP_LOGI(TAG, "%s", line);
+
+    for (uint32_t n = 0; n < r->top_count && n < CPU_LOAD_TOP_TASKS_MAX; n++) {
+        const cpu_load_task_t *t = &r->top[n];
+#if configTASKLIST_INCLUDE_COREID
+        ESP_LOGI(TAG, "    %-16s core %2d  %3lu.%lu%%", t->name, t->core,
+                 (unsigned long)(t->permille / 10), (unsigned long)(t->permille % 10));
+#else
+        ESP_LOGI(TAG, "    %-16s %3lu.%lu%%", t->name,
+                 (unsigned long)(t->permille / 10), (unsigned long)(t->permille % 10));
+#endif
+    }
+}
+
+#else
+
+esp_err_t cpu_load_window_begin(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cpu_load_window_end(cpu_load_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void cpu_load_print(const char *label, const cpu_load_report_t *r, uint32_t ops, const char *op_name)
+{
+    (void)TAG;
+}
+
+#endif // CONFIG_CPU_LOAD_MONITOR
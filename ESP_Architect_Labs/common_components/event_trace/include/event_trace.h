@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+/*
+ * 每个核一条固定大小的二进制环，记录 (CPU 周期计数, 事件号, 参数)。
+ * 只在本核上写本核的环，槽位用原子自增领取，所以任务和打断它的 ISR 同时记录也不会冲突；
+ * 环满后覆盖最旧的记录 (飞行记录仪模式)。
+ *
+ * 事件号的含义由使用方决定，下面是 IPC 流水线用到的几个阶段，
+ * 主机端转换脚本 tools/trace_to_chrome.py 认识它们并拼成时间片。
+ */
+typedef enum {
+    EVENT_TRACE_ISR_ENTRY = 1,  // 生产者 ISR 开始
+    EVENT_TRACE_ENQUEUE   = 2,  // 包交给传输层 (队列 / 环)
+    EVENT_TRACE_DEQUEUE   = 3,  // 消费者拿到包
+    EVENT_TRACE_RELEASE   = 4,  // 消费者处理完，包/块被归还
+    EVENT_TRACE_DROP      = 5,  // 生产者丢包
+    EVENT_TRACE_USER      = 16, // 16 以上留给调用方自定义
+} event_trace_id_t;
+
+/* 一条记录 12 字节，dump 时按小端原样输出 */
+typedef struct {
+    uint32_t cycles;            // esp_cpu_get_cycle_count()，每个核各自的计数器
+    uint32_t arg;               // 通常是包序号，用来把不同阶段串起来
+    uint16_t event;             // event_trace_id_t
+    uint16_t reserved;
+} event_trace_record_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+#if CONFIG_EVENT_TRACE_ENABLE
+
+/**
+ * @brief 清空所有核的环，并记录每个核的 (周期计数, esp_timer 时间) 校准点
+ * 各核的周期计数器互不同步，主机端靠校准点把它们对齐到同一条时间轴
+ */
+esp_err_t event_trace_init(void);
+
+/**
+ * @brief 记录一个事件 (ISR 安全，IRAM，无锁)
+ */
+void event_trace_record(uint16_t event, uint32_t arg);
+
+/**
+ * @brief 暂停记录，把所有核的环以文本行 (十六进制) 打印到控制台，然后恢复记录
+ * 输出夹在 EVENT_TRACE_BEGIN / EVENT_TRACE_END 之间，可以和普通日志混在一起，
+ * 用 tools/trace_to_chrome.py 从串口日志里提取。
+ * 打印前在每个核上重新取一个校准点，所以周期计数器回绕多少圈都不影响换算；
+ * 只要求同一个核上相邻两条记录 (以及最新一条到 dump) 的间隔不到半圈 (240MHz 下约 8.9 s)
+ */
+void event_trace_dump(void);
+
+#define EVENT_TRACE(event, arg)     event_trace_record((event), (arg))
+
+#else
+
+// 关闭时所有记录点编译为空，参数也不会被求值
+static inline esp_err_t event_trace_init(void) { return ESP_OK; }
+static inline void event_trace_dump(void) { }
+#define EVENT_TRACE(event, arg)     do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
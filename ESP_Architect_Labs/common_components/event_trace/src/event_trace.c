@@ -0,0 +1,169 @@
+#include "sdkconfig.h"
+
+#if CONFIG_EVENT_TRACE_ENABLE
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#if !CONFIG_FREERTOS_UNICORE
+#include "esp_ipc.h"
+#endif
+#include "event_trace.h"
+
+static const char *TAG = "TRACE";
+
+// ----------------------------------------------------------------------
+// 1. 每个核一条环
+// ----------------------------------------------------------------------
+#define TRACE_DEPTH         CONFIG_EVENT_TRACE_DEPTH
+#define TRACE_MASK          (TRACE_DEPTH - 1)
+#define TRACE_LINE_RECORDS  16          // dump 时每行输出的记录数
+
+_Static_assert((TRACE_DEPTH & (TRACE_DEPTH - 1)) == 0, "EVENT_TRACE_DEPTH must be a power of two");
+_Static_assert(sizeof(event_trace_record_t) == 12, "trace record layout is shared with the host converter");
+
+typedef struct {
+    uint32_t head;                      // 原子访问，只增不减，& MASK 得到槽位
+    event_trace_record_t records[TRACE_DEPTH];
+} __attribute__((aligned(32))) trace_ring_t;
+
+// 校准点：同一个核上背靠背读的周期计数和 esp_timer 时间。
+// 32 位周期计数器 240MHz 下约 17.9 s 回绕一次，所以每次导出时都重新取一次，
+// 主机端以它为锚从最新的记录往回展开，不依赖初始化时的那一个点。
+typedef struct {
+    uint32_t cycles;
+    int64_t  us;
+} trace_cal_t;
+
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+static trace_cal_t  s_cal[portNUM_PROCESSORS];
+static volatile bool s_paused = false;
+
+// ----------------------------------------------------------------------
+// 2. 初始化 + 校准
+// ----------------------------------------------------------------------
+static void calibrate_this_core(void *arg)
+{
+    trace_cal_t *cal = (trace_cal_t *)arg;
+    cal->cycles = esp_cpu_get_cycle_count();
+    cal->us = esp_timer_get_time();
+}
+
+static esp_err_t calibrate_all(void)
+{
+    // 每个核的周期计数器是独立的，必须在各自的核上读
+#if CONFIG_FREERTOS_UNICORE
+    calibrate_this_core(&s_cal[0]);
+#else
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        esp_err_t err = esp_ipc_call_blocking(c, calibrate_this_core, &s_cal[c]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+#endif
+    return ESP_OK;
+}
+
+esp_err_t event_trace_init(void)
+{
+    s_paused = true;
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        __atomic_store_n(&s_rings[c].head, 0, __ATOMIC_RELAXED);
+    }
+
+    esp_err_t err = calibrate_all();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    s_paused = false;
+    ESP_LOGI(TAG, "Event trace ready: %d records x %d cores (%u bytes)",
+             TRACE_DEPTH, portNUM_PROCESSORS, (unsigned)sizeof(s_rings));
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------
+// 3. 记录
+// ----------------------------------------------------------------------
+void IRAM_ATTR event_trace_record(uint16_t event, uint32_t arg)
+{
+    if (s_paused) {
+        return;
+    }
+
+    // 先读周期再领槽位：领槽位之后被打断的话，打断者的记录会排在前面但时间更晚，
+    // 主机端按周期排序即可，不影响正确性。
+    // 未绑核的任务在这两步之间被迁移时，记录会落到另一个核的环里 (极少见)。
+    uint32_t cycles = esp_cpu_get_cycle_count();
+    trace_ring_t *ring = &s_rings[esp_cpu_get_core_id()];
+    uint32_t idx = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & TRACE_MASK;
+
+    event_trace_record_t *rec = &ring->records[idx];
+    rec->cycles = cycles;
+    rec->arg = arg;
+    rec->event = event;
+    rec->reserved = 0;
+}
+
+// ----------------------------------------------------------------------
+// 4. 导出 (串口文本行)
+// ----------------------------------------------------------------------
+static void dump_ring(int core)
+{
+    trace_ring_t *ring = &s_rings[core];
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t count = head < TRACE_DEPTH ? head : TRACE_DEPTH;
+    uint32_t start = head - count;      // 最旧的一条
+
+    for (uint32_t i = 0; i < count; i += TRACE_LINE_RECORDS) {
+        uint32_t n = count - i < TRACE_LINE_RECORDS ? count - i : TRACE_LINE_RECORDS;
+        printf("EVENT_TRACE_DATA core=%d ", core);
+        for (uint32_t k = 0; k < n; k++) {
+            const uint8_t *b = (const uint8_t *)&ring->records[(start + i + k) & TRACE_MASK];
+            for (int j = 0; j < (int)sizeof(event_trace_record_t); j++) {
+                printf("%02x", b[j]);
+            }
+        }
+        printf("\n");
+    }
+    if (head > TRACE_DEPTH) {
+        ESP_LOGW(TAG, "core %d: %lu older records were overwritten", core, (unsigned long)(head - TRACE_DEPTH));
+    }
+}
+
+void event_trace_dump(void)
+{
+    s_paused = true;
+    // 给另一个核上正在写的那一条留一点时间
+    esp_rom_delay_us(10);
+
+    // 新的校准点一定晚于环里所有记录；取不到就沿用上一次的 (init 时的)
+    if (calibrate_all() != ESP_OK) {
+        ESP_LOGW(TAG, "re-calibration failed, timestamps may be off by whole counter wraps");
+    }
+
+    printf("EVENT_TRACE_BEGIN cores=%d depth=%d cpu_mhz=%d\n",
+           portNUM_PROCESSORS, TRACE_DEPTH, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        printf("EVENT_TRACE_CAL core=%d cycles=%lu us=%lld\n",
+               c, (unsigned long)s_cal[c].cycles, (long long)s_cal[c].us);
+    }
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        dump_ring(c);
+    }
+    printf("EVENT_TRACE_END\n");
+    fflush(stdout);
+
+    // 导出后清空，下一次 dump 只包含新的事件
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        __atomic_store_n(&s_rings[c].head, 0, __ATOMIC_RELAXED);
+    }
+    s_paused = false;
+}
+
+#endif // CONFIG_EVENT_TRACE_ENABLE
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+把 event_trace_dump() 打到串口上的记录转换成 Chrome Trace Event JSON，
+用 chrome://tracing 或 https://ui.perfetto.dev 打开。
+
+用法:
+    idf.py monitor | tee log.txt      # 运行一段时间后在 monitor 里按 'd'
+    python3 trace_to_chrome.py log.txt -o trace.json
+
+日志里可以有多次 dump，默认只转换最后一次 (--all 转换全部)。
+只依赖 Python 3 标准库。
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+EV_ISR_ENTRY = 1
+EV_ENQUEUE = 2
+EV_DEQUEUE = 3
+EV_RELEASE = 4
+EV_DROP = 5
+
+EVENT_NAMES = {
+    EV_ISR_ENTRY: "isr_entry",
+    EV_ENQUEUE: "enqueue",
+    EV_DEQUEUE: "dequeue",
+    EV_RELEASE: "release",
+    EV_DROP: "drop",
+}
+
+RECORD = struct.Struct("<IIHH")  # 与 event_trace_record_t 一致: cycles, arg, event, reserved
+
+RE_BEGIN = re.compile(r"EVENT_TRACE_BEGIN cores=(\d+) depth=(\d+) cpu_mhz=(\d+)")
+RE_CAL = re.compile(r"EVENT_TRACE_CAL core=(\d+) cycles=(\d+) us=(-?\d+)")
+RE_DATA = re.compile(r"EVENT_TRACE_DATA core=(\d+) ([0-9a-fA-F]+)")
+RE_END = re.compile(r"EVENT_TRACE_END")
+
+
+# ----------------------------------------------------------------------
+# 1. 从日志里提取 dump
+# ----------------------------------------------------------------------
+def parse_dumps(lines):
+    """返回 dump 列表，每个 dump 是 dict(mhz, cal{core: (cycles, us)}, records{core: [...]})"""
+    dumps = []
+    cur = None
+    for line in lines:
+        m = RE_BEGIN.search(line)
+        if m:
+            cur = {"mhz": int(m.group(3)), "cal": {}, "records": {}}
+            continue
+        if cur is None:
+            continue
+        m = RE_CAL.search(line)
+        if m:
+            cur["cal"][int(m.group(1))] = (int(m.group(2)), int(m.group(3)))
+            continue
+        m = RE_DATA.search(line)
+        if m:
+            core = int(m.group(1))
+            blob = bytes.fromhex(m.group(2)[: len(m.group(2)) // 2 * 2])
+            recs = cur["records"].setdefault(core, [])
+            for off in range(0, len(blob) - RECORD.size + 1, RECORD.size):
+                cycles, arg, event, _ = RECORD.unpack_from(blob, off)
+                recs.append((cycles, arg, event))
+            continue
+        if RE_END.search(line):
+            dumps.append(cur)
+            cur = None
+    return dumps
+
+
+# ----------------------------------------------------------------------
+# 2. 周期计数 -> 统一时间轴 (us)
+# ----------------------------------------------------------------------
+def signed32(x):
+    """32 位差值按有符号解释 (-2^31 .. 2^31-1)"""
+    x &= 0xFFFFFFFF
+    return x - (1 << 32) if x >= 0x80000000 else x
+
+
+def to_timeline(dump):
+    """每个核的 32 位周期计数以 dump 时的校准点为锚，从最新一条往回展开，再换算到 esp_timer 时间
+
+    校准点是 event_trace_dump() 当场取的，所以计数器在窗口里回绕几圈都没关系；
+    只要求同一个核上相邻两条记录、以及最新一条到 dump 的间隔不到半圈 (240MHz 下约 8.9 s)。
+    记录按领槽位顺序输出，ISR 打断任务时相邻两条的周期可能稍微倒退，有符号差值正好能处理。
+    """
+    mhz = dump["mhz"]
+    events = []
+    for core, recs in dump["records"].items():
+        if not recs:
+            continue
+        cal_cycles, cal_us = dump["cal"].get(core, (recs[-1][0], 0))
+        offset = signed32(recs[-1][0] - cal_cycles)    # 相对校准点的周期数，通常是负的
+        for i in range(len(recs) - 1, -1, -1):
+            cycles, arg, event = recs[i]
+            if i < len(recs) - 1:
+                offset -= signed32(recs[i + 1][0] - cycles)
+            events.append((cal_us + offset / mhz, core, event, arg))
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+# ----------------------------------------------------------------------
+# 3. 拼成 Chrome trace 事件
+# ----------------------------------------------------------------------
+def to_chrome(events, pid=0):
+    out = []
+    isr_open = {}      # (core, seq) -> ts
+    consume_open = {}  # (core, seq) -> ts
+
+    for ts, core, event, arg in events:
+        if event == EV_ISR_ENTRY:
+            isr_open[core] = ts
+        elif event == EV_ENQUEUE:
+            start = isr_open.pop(core, None)
+            if start is not None:
+                out.append({"name": "isr", "ph": "X", "pid": pid, "tid": core,
+                            "ts": start, "dur": max(ts - start, 0.001), "args": {"seq": arg}})
+            out.append({"name": "queue", "cat": "ipc", "ph": "b", "id": arg,
+                        "pid": pid, "tid": core, "ts": ts})
+        elif event == EV_DEQUEUE:
+            out.append({"name": "queue", "cat": "ipc", "ph": "e", "id": arg,
+                        "pid": pid, "tid": core, "ts": ts})
+            consume_open[(core, arg)] = ts
+        elif event == EV_RELEASE:
+            start = consume_open.pop((core, arg), None)
+            if start is not None:
+                out.append({"name": "consume", "ph": "X", "pid": pid, "tid": core,
+                            "ts": start, "dur": max(ts - start, 0.001), "args": {"seq": arg}})
+            else:
+                out.append({"name": "release", "ph": "i", "s": "t", "pid": pid, "tid": core,
+                            "ts": ts, "args": {"seq": arg}})
+        elif event == EV_DROP:
+            isr_open.pop(core, None)
+            out.append({"name": "drop", "ph": "i", "s": "t", "pid": pid, "tid": core,
+                        "ts": ts, "args": {"seq": arg}})
+        else:
+            out.append({"name": EVENT_NAMES.get(event, "event_%d" % event), "ph": "i", "s": "t",
+                        "pid": pid, "tid": core, "ts": ts, "args": {"arg": arg}})
+
+    cores = sorted({e[1] for e in events})
+    for core in cores:
+        out.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": core,
+                    "args": {"name": "core %d" % core}})
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert EVENT_TRACE dumps to Chrome trace JSON")
+    ap.add_argument("log", help="serial log file ('-' for stdin)")
+    ap.add_argument("-o", "--output", default="trace.json")
+    ap.add_argument("--all", action="store_true", help="convert every dump in the log, not just the last")
+    args = ap.parse_args()
+
+    f = sys.stdin if args.log == "-" else open(args.log, errors="replace")
+    with f:
+        dumps = parse_dumps(f)
+    if not dumps:
+        sys.exit("no EVENT_TRACE_BEGIN ... EVENT_TRACE_END block found")
+
+    selected = dumps if args.all else dumps[-1:]
+    trace = []
+    for i, dump in enumerate(selected):
+        trace.extend(to_chrome(to_timeline(dump), pid=i))
+
+    with open(args.output, "w") as out:
+        json.dump({"traceEvents": trace, "displayTimeUnit": "ns"}, out)
+
+    n = sum(len(r) for d in selected for r in d["records"].values())
+    print("%d records from %d dump(s) -> %s" % (n, len(selected), args.output))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+// HDR 风格分桶：按 log2 分成若干 "段"，每段再线性切成 16 个子桶
+//   [0, 16)           : 每个值一个桶 (精确)
+//   [2^k, 2^(k+1))    : 16 个等宽子桶，相对误差 <= 1/16 (6.25%)
+// 覆盖完整的 uint32_t 范围，总共 464 个桶 (~1.8KB)，内存固定不随样本增长
+#define LAT_HIST_SUB_BUCKET_BITS    4
+#define LAT_HIST_SUB_BUCKETS        (1u << LAT_HIST_SUB_BUCKET_BITS)
+#define LAT_HIST_BUCKET_COUNT       (LAT_HIST_SUB_BUCKETS + (32 - LAT_HIST_SUB_BUCKET_BITS) * LAT_HIST_SUB_BUCKETS)
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+/*
+ * 直方图本体。所有字段只通过原子操作修改，
+ * 所以 ISR 和任务 (甚至两个核) 可以同时往同一个直方图里记录。
+ */
+typedef struct {
+    uint32_t counts[LAT_HIST_BUCKET_COUNT];
+    uint32_t min;
+    uint32_t max;
+} latency_hist_t;
+
+/* 一个统计区间的汇总结果 (单位与记录时一致，通常是 us 或 cycles) */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+} latency_hist_summary_t;
+
+/* 周期打印任务的句柄 */
+typedef struct latency_hist_reporter *latency_hist_reporter_handle_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/**
+ * @brief 清空直方图 (也可以直接用零初始化的 static 变量，再调一次本函数设置 min)
+ */
+void latency_hist_init(latency_hist_t *hist);
+
+/**
+ * @brief 记录一个样本
+ * ISR 安全，放在 IRAM，无锁，O(1)
+ */
+void latency_hist_record(latency_hist_t *hist, uint32_t value);
+
+/**
+ * @brief 把当前内容拷贝到 out，可选同时清零 (清零与拷贝是逐桶原子交换，不会丢样本)
+ */
+void latency_hist_snapshot(latency_hist_t *hist, latency_hist_t *out, bool reset);
+
+/**
+ * @brief 清零 (等价于 snapshot 后丢弃结果)
+ */
+void latency_hist_reset(latency_hist_t *hist);
+
+/**
+ * @brief 计算百分位 (0.0 ~ 100.0)，返回该桶的上界 (不超过 max)
+ * 只应对 snapshot 出来的副本调用
+ */
+uint32_t latency_hist_percentile(const latency_hist_t *snap, float percentile);
+
+/**
+ * @brief 从副本计算 min/p50/p90/p99/p99.9/max
+ */
+void latency_hist_summarize(const latency_hist_t *snap, latency_hist_summary_t *out);
+
+/**
+ * @brief 打印一行汇总
+ * @param unit 单位后缀，例如 "us" 或 "cyc"
+ * @param lost 本区间的丢包数 (不关心时传 0)
+ */
+void latency_hist_print(const char *name, const latency_hist_summary_t *summary,
+                        const char *unit, uint32_t lost);
+
+/**
+ * @brief 启动一个低优先级任务，每 period_ms 打印一次并清零
+ * @param lost_counter 可选，指向模块里的丢包计数器，打印的是区间增量
+ * @param out_handle   可选，用于之后停止打印任务
+ * @return ESP_ERR_NO_MEM 快照缓冲、信号量或上下文分配失败；ESP_FAIL 任务创建失败
+ */
+esp_err_t latency_hist_reporter_start(latency_hist_t *hist, const char *name, uint32_t period_ms,
+                                      const volatile uint32_t *lost_counter,
+                                      latency_hist_reporter_handle_t *out_handle);
+
+/**
+ * @brief 停止并释放打印任务
+ * 阻塞到打印任务真正退出；等的是句柄自己的信号量，不会消耗调用方的任务通知
+ */
+void latency_hist_reporter_stop(latency_hist_reporter_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
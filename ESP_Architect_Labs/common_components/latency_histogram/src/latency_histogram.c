@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "latency_histogram.h"
+
+static const char *TAG = "LAT_HIST";
+
+struct latency_hist_reporter {
+    latency_hist_t *hist;
+    const char *name;
+    uint32_t period_ms;
+    const volatile uint32_t *lost_counter;
+    volatile bool running;
+    TaskHandle_t task;
+    SemaphoreHandle_t done;       // 打印任务退出前 give，stop 等它 (不占调用方的通知值)
+    latency_hist_t *snap;         // 快照缓冲，start 里分配，stop 里释放
+};
+
+// ----------------------------------------------------------------------
+// 1. 桶索引计算
+// ----------------------------------------------------------------------
+/*
+ * value < 16       : idx = value
+ * value >= 16      : e = floor(log2(value)) (>= 4)
+ *                    sub = value 最高位之后的 4 位
+ *                    idx = 16 + (e - 4) * 16 + sub
+ */
+static inline uint32_t IRAM_ATTR bucket_index(uint32_t value)
+{
+    if (value < LAT_HIST_SUB_BUCKETS) {
+        return value;
+    }
+    uint32_t e = 31 - __builtin_clz(value);
+    uint32_t shift = e - LAT_HIST_SUB_BUCKET_BITS;
+    uint32_t sub = (value >> shift) & (LAT_HIST_SUB_BUCKETS - 1);
+    return LAT_HIST_SUB_BUCKETS + shift * LAT_HIST_SUB_BUCKETS + sub;
+}
+
+// 桶 idx 能表示的最大值 (HDR 的 "highest equivalent value")
+static uint32_t bucket_upper(uint32_t idx)
+{
+    if (idx < LAT_HIST_SUB_BUCKETS) {
+        return idx;
+    }
+    uint32_t shift = (idx - LAT_HIST_SUB_BUCKETS) / LAT_HIST_SUB_BUCKETS;
+    uint32_t sub = (idx - LAT_HIST_SUB_BUCKETS) % LAT_HIST_SUB_BUCKETS;
+    uint64_t lower = (uint64_t)(LAT_HIST_SUB_BUCKETS + sub) << shift;
+    uint64_t upper = lower + ((uint64_t)1 << shift) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+// ----------------------------------------------------------------------
+// 2. 记录 / 清零 / 快照
+// ----------------------------------------------------------------------
+void latency_hist_init(latency_hist_t *hist)
+{
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->min = UINT32_MAX;
+    hist->max = 0;
+}
+
+void IRAM_ATTR latency_hist_record(latency_hist_t *hist, uint32_t value)
+{
+    __atomic_fetch_add(&hist->counts[bucket_index(value)], 1, __ATOMIC_RELAXED);
+
+    // min / max 用 CAS 更新，只有在真的刷新极值时才会循环
+    uint32_t cur = __atomic_load_n(&hist->min, __ATOMIC_RELAXED);
+    while (value < cur &&
+           !__atomic_compare_exchange_n(&hist->min, &cur, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    cur = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while (value > cur &&
+           !__atomic_compare_exchange_n(&hist->max, &cur, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void latency_hist_snapshot(latency_hist_t *hist, latency_hist_t *out, bool reset)
+{
+    if (reset) {
+        // 逐桶原子交换：拷贝和清零之间进来的样本会留在下一个区间，不会丢
+        for (uint32_t i = 0; i < LAT_HIST_BUCKET_COUNT; i++) {
+            out->counts[i] = __atomic_exchange_n(&hist->counts[i], 0, __ATOMIC_RELAXED);
+        }
+        out->min = __atomic_exchange_n(&hist->min, UINT32_MAX, __ATOMIC_RELAXED);
+        out->max = __atomic_exchange_n(&hist->max, 0, __ATOMIC_RELAXED);
+    } else {
+        for (uint32_t i = 0; i < LAT_HIST_BUCKET_COUNT; i++) {
+            out->counts[i] = __atomic_load_n(&hist->counts[i], __ATOMIC_RELAXED);
+        }
+        out->min = __atomic_load_n(&hist->min, __ATOMIC_RELAXED);
+        out->max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    }
+}
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    for (uint32_t i = 0; i < LAT_HIST_BUCKET_COUNT; i++) {
+        __atomic_store_n(&hist->counts[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&hist->min, UINT32_MAX, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->max, 0, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------------------------
+// 3. 百分位
+// ----------------------------------------------------------------------
+static uint32_t total_count(const latency_hist_t *snap)
+{
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < LAT_HIST_BUCKET_COUNT; i++) {
+        total += snap->counts[i];
+    }
+    return total;
+}
+
+static uint32_t percentile_of(const latency_hist_t *snap, uint32_t total, float percentile)
+{
+    if (total == 0) {
+        return 0;
+    }
+
+    // 第 rank 个样本 (1-based) 落在哪个桶
+    uint64_t rank = (uint64_t)((double)total * percentile / 100.0 + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LAT_HIST_BUCKET_COUNT; i++) {
+        seen += snap->counts[i];
+        if (seen >= rank) {
+            uint32_t v = bucket_upper(i);
+            // 桶上界可能超出真实极值，夹一下让输出更直观
+            if (v > snap->max) v = snap->max;
+            if (v < snap->min) v = snap->min;
+            return v;
+        }
+    }
+    return snap->max;
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *snap, float percentile)
+{
+    return percentile_of(snap, total_count(snap), percentile);
+}
+
+void latency_hist_summarize(const latency_hist_t *snap, latency_hist_summary_t *out)
+{
+    uint32_t total = total_count(snap);
+
+    out->count = total;
+    out->min   = total ? snap->min : 0;
+    out->p50   = percentile_of(snap, total, 50.0f);
+    out->p90   = percentile_of(snap, total, 90.0f);
+    out->p99   = percentile_of(snap, total, 99.0f);
+    out->p999  = percentile_of(snap, total, 99.9f);
+    out->max   = total ? snap->max : 0;
+}
+
+void latency_hist_print(const char *name, const latency_hist_summary_t *s,
+                        const char *unit, uint32_t lost)
+{
+    ESP_LOGI(TAG, "[%s] n=%lu min=%lu p50=%lu p90=%lu p99=%lu p99.9=%lu max=%lu (%s) Lost: %lu",
+             name, (unsigned long)s->count, (unsigned long)s->min, (unsigned long)s->p50,
+             (unsigned long)s->p90, (unsigned long)s->p99, (unsigned long)s->p999,
+             (unsigned long)s->max, unit, (unsigned long)lost);
+}
+
+// ----------------------------------------------------------------------
+// 4. 周期打印任务
+// ----------------------------------------------------------------------
+static void task_reporter(void *arg)
+{
+    struct latency_hist_reporter *ctx = (struct latency_hist_reporter *)arg;
+
+    latency_hist_t *snap = ctx->snap;
+    latency_hist_summary_t summary;
+    uint32_t last_lost = ctx->lost_counter ? *ctx->lost_counter : 0;
+
+    while (ctx->running) {
+        // 用通知当延时，stop 的时候可以立即叫醒
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ctx->period_ms));
+        if (!ctx->running) break;
+
+        latency_hist_snapshot(ctx->hist, snap, true);
+        latency_hist_summarize(snap, &summary);
+
+        uint32_t lost = 0;
+        if (ctx->lost_counter) {
+            uint32_t now_lost = *ctx->lost_counter;
+            lost = now_lost - last_lost;
+            last_lost = now_lost;
+        }
+        latency_hist_print(ctx->name, &summary, "us", lost);
+    }
+
+    // ctx 由 stop 的调用者释放，give 之后不能再碰它
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t latency_hist_reporter_start(latency_hist_t *hist, const char *name, uint32_t period_ms,
+                                      const volatile uint32_t *lost_counter,
+                                      latency_hist_reporter_handle_t *out_handle)
+{
+    if (hist == NULL || name == NULL || period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct latency_hist_reporter *ctx = calloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->hist = hist;
+    ctx->name = name;
+    ctx->period_ms = period_ms;
+    ctx->lost_counter = lost_counter;
+    ctx->running = true;
+
+    // 快照有 ~1.8KB，放堆上，别撑爆任务栈；在这里分配，任务里就不会出现
+    // "分配失败提前退出、stop 永远等不到通知" 的情况
+    ctx->snap = malloc(sizeof(latency_hist_t));
+    ctx->done = xSemaphoreCreateBinary();
+    if (ctx->snap == NULL || ctx->done == NULL) {
+        if (ctx->done) {
+            vSemaphoreDelete(ctx->done);
+        }
+        free(ctx->snap);
+        free(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 优先级 1：只打印，不能抢被测任务的 CPU
+    if (xTaskCreate(task_reporter, "LatReporter", 3072, ctx, 1, &ctx->task) != pdPASS) {
+        vSemaphoreDelete(ctx->done);
+        free(ctx->snap);
+        free(ctx);
+        return ESP_FAIL;
+    }
+
+    if (out_handle) {
+        *out_handle = ctx;
+    }
+    return ESP_OK;
+}
+
+void latency_hist_reporter_stop(latency_hist_reporter_handle_t handle)
+{
+    if (handle == NULL) {
+        return;
+    }
+
+    handle->running = false;
+    xTaskNotifyGive(handle->task);
+
+    // 等打印任务真正退出再释放上下文。用自己的信号量而不是调用方的任务通知：
+    // 调用方身上已经挂着的通知会让这里提前返回，任务还在用 ctx 时就被释放了
+    xSemaphoreTake(handle->done, portMAX_DELAY);
+    vSemaphoreDelete(handle->done);
+    free(handle->snap);
+    free(handle);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+#define SHARDED_COUNTER_MAX_CORES   2
+#define SHARDED_COUNTER_SLOT_ALIGN  CONFIG_SHARDED_COUNTER_SLOT_ALIGN
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+/*
+ * 每个核一个槽，各占一整行：加法只写本核的槽，两个核之间没有共享的写。
+ * 读的时候再把所有槽加起来 (懒汇总)。
+ *
+ * 可以直接定义成零初始化的 static 变量使用，不需要 init。
+ */
+typedef struct {
+    struct {
+        uint32_t value;
+    } __attribute__((aligned(SHARDED_COUNTER_SLOT_ALIGN))) slot[SHARDED_COUNTER_MAX_CORES];
+
+    // 周期快照 (可选)：读者只读这两个字，完全不碰各核的槽
+    uint32_t snap_seq;              // 奇数 = 正在更新
+    uint32_t snap_value;
+    int64_t  snap_us;               // 拍快照时的 esp_timer 时间
+    void    *snap_timer;            // esp_timer_handle_t
+} sharded_counter_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/**
+ * @brief 加 n (ISR / 任务都可以调用，内联，无锁)
+ *
+ * 只对本核的槽做原子加：槽不会被另一个核写，所以原子指令从不冲突；
+ * 原子性只是为了防同一个核上的中断打断读改写，以及任务恰好在取核号之后被迁移到另一个核。
+ */
+static inline void sharded_counter_add(sharded_counter_t *c, uint32_t n)
+{
+    __atomic_fetch_add(&c->slot[esp_cpu_get_core_id()].value, n, __ATOMIC_RELAXED);
+}
+
+static inline void sharded_counter_inc(sharded_counter_t *c)
+{
+    sharded_counter_add(c, 1);
+}
+
+/**
+ * @brief 所有槽之和 (32 位回绕)。与并发的加法之间没有同步：读到的是某一时刻附近的值
+ */
+uint32_t sharded_counter_read(const sharded_counter_t *c);
+
+/**
+ * @brief 单个核的槽 (看负载是否均衡)
+ */
+uint32_t sharded_counter_read_core(const sharded_counter_t *c, int core);
+
+/**
+ * @brief 所有槽清零。只有在没有并发加法时结果才精确
+ */
+void sharded_counter_reset(sharded_counter_t *c);
+
+/**
+ * @brief 启动周期快照：每 period_ms 用 esp_timer 汇总一次，之后读快照不再扫描所有槽
+ */
+esp_err_t sharded_counter_snapshot_start(sharded_counter_t *c, uint32_t period_ms);
+
+/**
+ * @brief 停止并删除快照定时器
+ */
+void sharded_counter_snapshot_stop(sharded_counter_t *c);
+
+/**
+ * @brief 最近一次快照的值
+ * @param taken_us 可选，返回拍快照时的 esp_timer 时间 (还没有快照时为 0)
+ */
+uint32_t sharded_counter_snapshot(const sharded_counter_t *c, int64_t *taken_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+#include <string.h>
+#include "esp_timer.h"
+#include "sharded_counter.h"
+
+_Static_assert((SHARDED_COUNTER_SLOT_ALIGN & (SHARDED_COUNTER_SLOT_ALIGN - 1)) == 0,
+               "SHARDED_COUNTER_SLOT_ALIGN must be a power of 2");
+
+// ----------------------------------------------------------------------
+// 1. 懒汇总
+// ----------------------------------------------------------------------
+uint32_t sharded_counter_read(const sharded_counter_t *c)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < SHARDED_COUNTER_MAX_CORES; i++) {
+        sum += __atomic_load_n(&c->slot[i].value, __ATOMIC_RELAXED);
+    }
+    return sum;
+}
+
+uint32_t sharded_counter_read_core(const sharded_counter_t *c, int core)
+{
+    if (core < 0 || core >= SHARDED_COUNTER_MAX_CORES) {
+        return 0;
+    }
+    return __atomic_load_n(&c->slot[core].value, __ATOMIC_RELAXED);
+}
+
+void sharded_counter_reset(sharded_counter_t *c)
+{
+    for (int i = 0; i < SHARDED_COUNTER_MAX_CORES; i++) {
+        __atomic_store_n(&c->slot[i].value, 0, __ATOMIC_RELAXED);
+    }
+}
+
+// ----------------------------------------------------------------------
+// 2. 周期快照
+// ----------------------------------------------------------------------
+// 快照只有定时器任务一个写者：序号变奇数 -> 写值和时间 -> 序号变偶数，
+// 读者看到序号变了就重读 (64 位时间戳在 32 位核上不是一次写完的)
+static void snapshot_cb(void *arg)
+{
+    sharded_counter_t *c = (sharded_counter_t *)arg;
+    uint32_t value = sharded_counter_read(c);
+    int64_t now = esp_timer_get_time();
+
+    __atomic_store_n(&c->snap_seq, c->snap_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    c->snap_value = value;
+    c->snap_us = now;
+    __atomic_store_n(&c->snap_seq, c->snap_seq + 1, __ATOMIC_RELEASE);
+}
+
+esp_err_t sharded_counter_snapshot_start(sharded_counter_t *c, uint32_t period_ms)
+{
+    if (c->snap_timer != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const esp_timer_create_args_t args = {
+        .callback = snapshot_cb,
+        .arg = c,
+        .name = "shard_snap",
+    };
+    esp_timer_handle_t timer;
+    esp_err_t err = esp_timer_create(&args, &timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    snapshot_cb(c);     // 先拍一次，start 之后马上就有可读的快照
+    err = esp_timer_start_periodic(timer, (uint64_t)period_ms * 1000);
+    if (err != ESP_OK) {
+        esp_timer_delete(timer);
+        return err;
+    }
+    c->snap_timer = timer;
+    return ESP_OK;
+}
+
+void sharded_counter_snapshot_stop(sharded_counter_t *c)
+{
+    if (c->snap_timer == NULL) {
+        return;
+    }
+    esp_timer_stop((esp_timer_handle_t)c->snap_timer);
+    esp_timer_delete((esp_timer_handle_t)c->snap_timer);
+    c->snap_timer = NULL;
+}
+
+uint32_t sharded_counter_snapshot(const sharded_counter_t *c, int64_t *taken_us)
+{
+    uint32_t seq, value;
+    int64_t us;
+
+    do {
+        while ((seq = __atomic_load_n(&c->snap_seq, __ATOMIC_ACQUIRE)) & 1) {
+        }
+        value = c->snap_value;
+        us = c->snap_us;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&c->snap_seq, __ATOMIC_RELAXED) != seq);
+
+    if (taken_us) {
+        *taken_us = us;
+    }
+    return value;
+}
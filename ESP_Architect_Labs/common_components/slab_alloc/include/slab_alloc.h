@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+// 固定 4 个尺寸档位，大小和数量在 menuconfig 里配置 (默认 64/256/1024/4128)
+#define SLAB_CLASS_COUNT    4
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t block_size;    // 每块字节数
+    uint32_t block_count;   // 总块数
+    uint32_t in_use;        // 当前已分配
+    uint32_t high_water;    // 历史最高占用
+    uint32_t exhausted;     // 作为最佳档位却已空的次数
+    uint32_t fallbacks;     // 因为更小档位耗尽而从本档位借出的次数
+} slab_class_stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/**
+ * @brief 初始化所有档位的空闲链表 (只需调用一次，重复调用会把所有块收回)
+ */
+esp_err_t slab_init(void);
+
+/**
+ * @brief 分配至少 size 字节的块
+ * ISR 安全，无锁 (CAS)，O(1)。失败返回 NULL。
+ */
+void *slab_alloc(size_t size);
+
+/**
+ * @brief 归还一个由 slab_alloc 得到的块
+ * ISR 安全，无锁 (CAS)，O(1)。传入 NULL 无副作用。
+ */
+void slab_free(void *ptr);
+
+/**
+ * @brief 返回块所属档位的容量 (字节)，非本分配器的指针返回 0
+ */
+size_t slab_block_size(const void *ptr);
+
+/**
+ * @brief 申请 size 字节时会用到的那个档位 (最佳档位) 当前的占用百分比 0~100
+ * ISR 安全，用来做背压的水位判断。没有档位装得下时返回 100。
+ */
+uint32_t slab_usage_pct(size_t size);
+
+/**
+ * @brief 读取某个档位的统计
+ */
+void slab_get_stats(uint32_t cls, slab_class_stats_t *out);
+
+/**
+ * @brief 所有档位的块总数 / 总占用内存 (字节)
+ */
+uint32_t slab_total_blocks(void);
+size_t slab_total_bytes(void);
+
+/**
+ * @brief 打印每个档位的统计
+ */
+void slab_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,260 @@
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "slab_alloc.h"
+
+static const char *TAG = "SLAB";
+
+// ----------------------------------------------------------------------
+// 1. 每个档位的静态存储
+// ----------------------------------------------------------------------
+// 块按 8 字节对齐 (里面会放 int64_t 时间戳)
+#define SLAB_DECLARE_STORAGE(n)                                                         \
+    _Static_assert(CONFIG_SLAB_CLASS##n##_SIZE % 8 == 0, "slab block size must be a multiple of 8"); \
+    static uint8_t  s_mem##n[CONFIG_SLAB_CLASS##n##_SIZE * CONFIG_SLAB_CLASS##n##_COUNT + 1] \
+        __attribute__((aligned(8)));                                                    \
+    static uint16_t s_next##n[CONFIG_SLAB_CLASS##n##_COUNT + 1]
+
+// "+1" 只是为了允许某个档位数量配置成 0 (C 不允许零长数组)
+SLAB_DECLARE_STORAGE(0);
+SLAB_DECLARE_STORAGE(1);
+SLAB_DECLARE_STORAGE(2);
+SLAB_DECLARE_STORAGE(3);
+
+_Static_assert(CONFIG_SLAB_CLASS0_SIZE < CONFIG_SLAB_CLASS1_SIZE &&
+               CONFIG_SLAB_CLASS1_SIZE < CONFIG_SLAB_CLASS2_SIZE &&
+               CONFIG_SLAB_CLASS2_SIZE < CONFIG_SLAB_CLASS3_SIZE,
+               "slab classes must be sorted by size");
+
+// ----------------------------------------------------------------------
+// 2. 档位描述符
+// ----------------------------------------------------------------------
+// 空闲链表头 = (tag << 16) | index，index 为 SLAB_NIL 表示空。
+// 每次修改 tag + 1，防止 CAS 的 ABA 问题 (块被拿走又还回来，head 值却没变)。
+#define SLAB_NIL    0xFFFFu
+
+typedef struct {
+    uint8_t  *mem;
+    uint16_t *next;             // next[i] = 链表中 i 的下一块
+    uint32_t  block_size;
+    uint32_t  block_count;
+
+    uint32_t  head;             // 原子访问
+    uint32_t  in_use;           // 原子访问
+    uint32_t  high_water;       // 原子访问
+    uint32_t  exhausted;        // 原子访问
+    uint32_t  fallbacks;        // 原子访问
+} slab_class_t;
+
+#define SLAB_CLASS_INIT(n) {                        \
+    .mem = s_mem##n,                                \
+    .next = s_next##n,                              \
+    .block_size = CONFIG_SLAB_CLASS##n##_SIZE,      \
+    .block_count = CONFIG_SLAB_CLASS##n##_COUNT,    \
+    .head = SLAB_NIL,                               \
+}
+
+// DRAM_ATTR: ISR 里会访问这个表
+static DRAM_ATTR slab_class_t s_classes[SLAB_CLASS_COUNT] = {
+    SLAB_CLASS_INIT(0),
+    SLAB_CLASS_INIT(1),
+    SLAB_CLASS_INIT(2),
+    SLAB_CLASS_INIT(3),
+};
+
+// ----------------------------------------------------------------------
+// 3. 无锁空闲链表 (Treiber stack，基于下标)
+// ----------------------------------------------------------------------
+static inline uint32_t IRAM_ATTR freelist_pop(slab_class_t *cls)
+{
+    uint32_t head = __atomic_load_n(&cls->head, __ATOMIC_ACQUIRE);
+    uint32_t next_head;
+
+    do {
+        uint32_t idx = head & 0xFFFF;
+        if (idx == SLAB_NIL) {
+            return SLAB_NIL;
+        }
+        next_head = ((head & 0xFFFF0000u) + 0x10000u) | cls->next[idx];
+    } while (!__atomic_compare_exchange_n(&cls->head, &head, next_head, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return head & 0xFFFF;
+}
+
+static inline void IRAM_ATTR freelist_push(slab_class_t *cls, uint32_t idx)
+{
+    uint32_t head = __atomic_load_n(&cls->head, __ATOMIC_ACQUIRE);
+    uint32_t next_head;
+
+    do {
+        cls->next[idx] = (uint16_t)(head & 0xFFFF);
+        next_head = ((head & 0xFFFF0000u) + 0x10000u) | idx;
+    } while (!__atomic_compare_exchange_n(&cls->head, &head, next_head, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+// ----------------------------------------------------------------------
+// 4. 分配 / 释放
+// ----------------------------------------------------------------------
+esp_err_t slab_init(void)
+{
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        slab_class_t *cls = &s_classes[c];
+
+        // 把 0..count-1 串成链表：0 -> 1 -> ... -> count-1 -> NIL
+        for (uint32_t i = 0; i < cls->block_count; i++) {
+            cls->next[i] = (i + 1 < cls->block_count) ? (uint16_t)(i + 1) : SLAB_NIL;
+        }
+        __atomic_store_n(&cls->head, cls->block_count ? 0 : SLAB_NIL, __ATOMIC_RELEASE);
+        __atomic_store_n(&cls->in_use, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&cls->high_water, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&cls->exhausted, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&cls->fallbacks, 0, __ATOMIC_RELAXED);
+    }
+
+    ESP_LOGI(TAG, "Slab pools ready: %u blocks, %u bytes",
+             (unsigned)slab_total_blocks(), (unsigned)slab_total_bytes());
+    return ESP_OK;
+}
+
+static inline void IRAM_ATTR note_alloc(slab_class_t *cls)
+{
+    uint32_t used = __atomic_add_fetch(&cls->in_use, 1, __ATOMIC_RELAXED);
+    uint32_t hw = __atomic_load_n(&cls->high_water, __ATOMIC_RELAXED);
+    while (used > hw &&
+           !__atomic_compare_exchange_n(&cls->high_water, &hw, used, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void * IRAM_ATTR slab_alloc(size_t size)
+{
+    // [A] 找最小能装下的档位 (只有 4 档，线性扫描就是 O(1))
+    int best = 0;
+    while (best < SLAB_CLASS_COUNT && s_classes[best].block_size < size) {
+        best++;
+    }
+    if (best == SLAB_CLASS_COUNT) {
+        return NULL;
+    }
+
+    // [B] 从最佳档位开始取，取不到就记一次耗尽，再 (可选) 往大档位借
+    for (int c = best; c < SLAB_CLASS_COUNT; c++) {
+        slab_class_t *cls = &s_classes[c];
+        uint32_t idx = freelist_pop(cls);
+        if (idx != SLAB_NIL) {
+            note_alloc(cls);
+            if (c != best) {
+                __atomic_add_fetch(&cls->fallbacks, 1, __ATOMIC_RELAXED);
+            }
+            return cls->mem + idx * cls->block_size;
+        }
+        if (c == best) {
+            __atomic_add_fetch(&cls->exhausted, 1, __ATOMIC_RELAXED);
+        }
+#if !CONFIG_SLAB_FALLBACK_TO_LARGER
+        break;
+#endif
+    }
+    return NULL;
+}
+
+static inline int IRAM_ATTR class_of(const void *ptr)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        const slab_class_t *cls = &s_classes[c];
+        if (p >= cls->mem && p < cls->mem + cls->block_size * cls->block_count) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+void IRAM_ATTR slab_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    int c = class_of(ptr);
+    if (c < 0) {
+        // 不是本分配器的指针，直接忽略 (ISR 里不能打日志)
+        return;
+    }
+
+    slab_class_t *cls = &s_classes[c];
+    uint32_t idx = (uint32_t)((uint8_t *)ptr - cls->mem) / cls->block_size;
+    freelist_push(cls, idx);
+    __atomic_sub_fetch(&cls->in_use, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t IRAM_ATTR slab_usage_pct(size_t size)
+{
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        const slab_class_t *cls = &s_classes[c];
+        if (cls->block_size >= size) {
+            if (cls->block_count == 0) {
+                return 100;
+            }
+            return __atomic_load_n(&cls->in_use, __ATOMIC_RELAXED) * 100 / cls->block_count;
+        }
+    }
+    return 100;
+}
+
+size_t slab_block_size(const void *ptr)
+{
+    int c = class_of(ptr);
+    return c < 0 ? 0 : s_classes[c].block_size;
+}
+
+// ----------------------------------------------------------------------
+// 5. 统计
+// ----------------------------------------------------------------------
+void slab_get_stats(uint32_t cls_id, slab_class_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (cls_id >= SLAB_CLASS_COUNT) {
+        return;
+    }
+
+    const slab_class_t *cls = &s_classes[cls_id];
+    out->block_size  = cls->block_size;
+    out->block_count = cls->block_count;
+    out->in_use      = __atomic_load_n(&cls->in_use, __ATOMIC_RELAXED);
+    out->high_water  = __atomic_load_n(&cls->high_water, __ATOMIC_RELAXED);
+    out->exhausted   = __atomic_load_n(&cls->exhausted, __ATOMIC_RELAXED);
+    out->fallbacks   = __atomic_load_n(&cls->fallbacks, __ATOMIC_RELAXED);
+}
+
+uint32_t slab_total_blocks(void)
+{
+    uint32_t total = 0;
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        total += s_classes[c].block_count;
+    }
+    return total;
+}
+
+size_t slab_total_bytes(void)
+{
+    size_t total = 0;
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        total += (size_t)s_classes[c].block_size * s_classes[c].block_count;
+    }
+    return total;
+}
+
+void slab_print_stats(void)
+{
+    slab_class_stats_t st;
+    for (uint32_t c = 0; c < SLAB_CLASS_COUNT; c++) {
+        slab_get_stats(c, &st);
+        ESP_LOGI(TAG, "class %lu: %5lu B x %3lu | in use %3lu | high water %3lu | exhausted %lu | fallbacks %lu",
+                 (unsigned long)c, (unsigned long)st.block_size, (unsigned long)st.block_count,
+                 (unsigned long)st.in_use, (unsigned long)st.high_water, (unsigned long)st.exhausted,
+                 (unsigned long)st.fallbacks);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+#define SMP_HARNESS_CORES   2       // 每个核一个 worker
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+/*
+ * 翻转语义的自旋屏障：最后一个到达的人把全局 sense 翻过来，其余人在自己的核上自旋等它翻转。
+ * 每个参与者自己保存一份 local_sense (初值 0)，同一个屏障可以连续反复使用。
+ */
+typedef struct {
+    uint32_t count __attribute__((aligned(32)));    // 本轮还没到的人数
+    uint32_t sense __attribute__((aligned(32)));    // 最后一个人翻转它来放行
+    uint32_t parties;
+} smp_barrier_t;
+
+/*
+ * 一个测试用例。每轮迭代：
+ *   runner: setup() -> 叫醒 worker
+ *   worker (每个核): 屏障 (周期对齐地同时起跑) -> body() -> 屏障 (等两边都做完) -> 报告
+ *   runner: 等两个 worker 都报告 -> verify()
+ * 前 warmup 轮不计入结果，测量开始前调用一次 reset()。
+ */
+typedef struct {
+    const char *name;
+    void (*setup)(void *ctx);                   // 每轮之前，在调用者任务里 (可为 NULL)
+    uint32_t (*body)(int core, void *ctx);      // 每个核跑一轮，返回完成的操作数
+    bool (*verify)(void *ctx);                  // 每轮之后，返回 false 记一次失败 (可为 NULL)
+    void (*reset)(void *ctx);                   // 预热结束、第一轮测量之前 (可为 NULL)
+    void *ctx;
+    uint32_t warmup;                            // 预热轮数
+    uint32_t iterations;                        // 测量轮数 (>= 1)
+} smp_harness_case_t;
+
+/*
+ * 测量结果。cycles/op = 本轮墙上时间 (两个核都到达结束屏障为止) / 两个核的总操作数。
+ * 周期计数是 32 位的：一轮不能超过 2^32 个周期 (240MHz 下约 17 秒)。
+ */
+typedef struct {
+    uint32_t iterations;
+    uint32_t failures;                          // verify 返回 false 的测量轮数
+    float    mean;                              // cycles/op
+    float    stddev;
+    float    min;
+    float    max;
+    uint64_t core_ops[SMP_HARNESS_CORES];       // 测量轮里每个核完成的操作数之和
+    uint64_t core_cycles[SMP_HARNESS_CORES];    // 每个核从起跑到做完 body 的周期数之和
+} smp_harness_result_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+void smp_barrier_init(smp_barrier_t *b, uint32_t parties);
+
+/**
+ * @brief 等所有参与者到达 (自旋，不让出 CPU)
+ * @param local_sense 调用者私有的 sense，初值 0
+ */
+void smp_barrier_wait(smp_barrier_t *b, uint32_t *local_sense);
+
+/**
+ * @brief 跑一个用例：每个核建一个 worker，warmup + iterations 轮，结束后删除 worker
+ * 调用者阻塞等待 (不能在 worker 绑定的核上以更高优先级忙等)。
+ */
+esp_err_t smp_harness_run(const smp_harness_case_t *c, smp_harness_result_t *out);
+
+/**
+ * @brief 打印一行：name  mean ± stddev  [min, max] cyc/op  (n 轮, 失败 k 轮)
+ */
+void smp_harness_print(const char *name, const smp_harness_result_t *r);
+
+#ifdef __cplusplus
+}
+#endif
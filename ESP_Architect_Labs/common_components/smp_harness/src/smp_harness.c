@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "smp_harness.h"
+
+static const char *TAG = "SMP_HARNESS";
+
+// ----------------------------------------------------------------------
+// 1. 屏障
+// ----------------------------------------------------------------------
+void smp_barrier_init(smp_barrier_t *b, uint32_t parties)
+{
+    b->count = parties;
+    b->sense = 0;
+    b->parties = parties;
+}
+
+void smp_barrier_wait(smp_barrier_t *b, uint32_t *local_sense)
+{
+    uint32_t s = !*local_sense;
+    *local_sense = s;
+
+    if (__atomic_sub_fetch(&b->count, 1, __ATOMIC_ACQ_REL) == 0) {
+        // 最后一个到：先把计数复位给下一轮，再翻转放行
+        __atomic_store_n(&b->count, b->parties, __ATOMIC_RELAXED);
+        __atomic_store_n(&b->sense, s, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&b->sense, __ATOMIC_ACQUIRE) != s) {
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 2. Worker
+// ----------------------------------------------------------------------
+typedef struct {
+    uint32_t ops;
+    uint32_t body_cycles;       // 起跑 -> body 做完
+    uint32_t wall_cycles;       // 起跑 -> 两个核都做完
+} __attribute__((aligned(32))) iter_report_t;
+
+static const smp_harness_case_t *s_case = NULL;
+static uint32_t s_rounds = 0;
+static smp_barrier_t s_barrier;
+static iter_report_t s_report[SMP_HARNESS_CORES];
+static TaskHandle_t s_workers[SMP_HARNESS_CORES];
+static SemaphoreHandle_t s_done = NULL;
+
+static void harness_worker(void *arg)
+{
+    int core = (int)(intptr_t)arg;
+    uint32_t sense = 0;
+
+    for (uint32_t it = 0; it < s_rounds; it++) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 两个核被通知叫醒的时刻差几个 us，在屏障里对齐到几十个周期以内
+        smp_barrier_wait(&s_barrier, &sense);
+        uint32_t t0 = esp_cpu_get_cycle_count();
+        uint32_t ops = s_case->body(core, s_case->ctx);
+        uint32_t t1 = esp_cpu_get_cycle_count();
+        smp_barrier_wait(&s_barrier, &sense);
+        uint32_t t2 = esp_cpu_get_cycle_count();
+
+        // 每个核的周期计数器互不相干，只在本核内做差
+        s_report[core].ops = ops;
+        s_report[core].body_cycles = t1 - t0;
+        s_report[core].wall_cycles = t2 - t0;
+        xSemaphoreGive(s_done);
+    }
+
+    vTaskDelete(NULL);
+}
+
+// ----------------------------------------------------------------------
+// 3. Runner
+// ----------------------------------------------------------------------
+esp_err_t smp_harness_run(const smp_harness_case_t *c, smp_harness_result_t *out)
+{
+    if (c == NULL || c->body == NULL || c->iterations == 0 || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_done == NULL) {
+        s_done = xSemaphoreCreateCounting(SMP_HARNESS_CORES, 0);
+        if (s_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_case = c;
+    s_rounds = c->warmup + c->iterations;
+    smp_barrier_init(&s_barrier, SMP_HARNESS_CORES);
+    memset(out, 0, sizeof(*out));
+
+    for (int i = 0; i < SMP_HARNESS_CORES; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Harness%d", i);
+        if (xTaskCreatePinnedToCore(harness_worker, name, CONFIG_SMP_HARNESS_STACK_SIZE, (void *)(intptr_t)i,
+                                    CONFIG_SMP_HARNESS_TASK_PRIORITY, &s_workers[i], i) != pdPASS) {
+            // 已建好的 worker 还阻塞在第一次通知上，直接删掉
+            for (int k = 0; k < i; k++) {
+                vTaskDelete(s_workers[k]);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Welford 在线算均值/方差
+    double mean = 0, m2 = 0;
+    float lo = INFINITY, hi = 0;
+
+    for (uint32_t it = 0; it < s_rounds; it++) {
+        if (it == c->warmup && c->reset) {
+            c->reset(c->ctx);
+        }
+        if (c->setup) {
+            c->setup(c->ctx);
+        }
+
+        for (int i = 0; i < SMP_HARNESS_CORES; i++) {
+            xTaskNotifyGive(s_workers[i]);
+        }
+        for (int i = 0; i < SMP_HARNESS_CORES; i++) {
+            xSemaphoreTake(s_done, portMAX_DELAY);
+        }
+
+        bool ok = c->verify ? c->verify(c->ctx) : true;
+        if (it < c->warmup) {
+            continue;
+        }
+
+        uint32_t ops = 0;
+        uint32_t wall = 0;
+        for (int i = 0; i < SMP_HARNESS_CORES; i++) {
+            ops += s_report[i].ops;
+            if (s_report[i].wall_cycles > wall) {
+                wall = s_report[i].wall_cycles;
+            }
+            out->core_ops[i] += s_report[i].ops;
+            out->core_cycles[i] += s_report[i].body_cycles;
+        }
+        if (!ok) {
+            out->failures++;
+        }
+
+        float cpo = ops ? (float)wall / ops : 0.0f;
+        out->iterations++;
+        double delta = cpo - mean;
+        mean += delta / out->iterations;
+        m2 += delta * (cpo - mean);
+        if (cpo < lo) {
+            lo = cpo;
+        }
+        if (cpo > hi) {
+            hi = cpo;
+        }
+    }
+
+    out->mean = (float)mean;
+    out->stddev = out->iterations > 1 ? (float)sqrt(m2 / (out->iterations - 1)) : 0.0f;
+    out->min = lo;
+    out->max = hi;
+
+    // 两个核的 idle 任务在整个用例里几乎抢不到 CPU：返回前让它们喂一次狗、回收刚删掉的 worker，
+    // 连续跑多个用例 (扫参) 时也不会把下一个用例的前几轮算进回收的开销
+    vTaskDelay(pdMS_TO_TICKS(10));
+    return ESP_OK;
+}
+
+void smp_harness_print(const char *name, const smp_harness_result_t *r)
+{
+    ESP_LOGI(TAG, "%-14s %10.1f +- %-8.1f [%.1f, %.1f] cyc/op  (%lu runs, %lu failed)",
+             name, r->mean, r->stddev, r->min, r->max,
+             (unsigned long)r->iterations, (unsigned long)r->failures);
+}
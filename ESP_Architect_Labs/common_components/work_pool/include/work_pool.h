@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------------------------------------------------
+ * Configuration & Constants
+ * -------------------------------------------------------------------------- */
+#define WORK_POOL_MAX_WORKERS   2       // 每个核一个常驻 worker
+
+/* --------------------------------------------------------------------------
+ * Data Structures
+ * -------------------------------------------------------------------------- */
+typedef void (*work_pool_fn_t)(void *arg);
+
+/*
+ * 一组任务：submit 时 +1，任务跑完 -1，work_pool_wait 等它归零。
+ * 放在调用者的栈上或静态区都可以，必须活到 wait 返回。
+ * 由之后要 wait 的那个任务 init (记下要通知谁)。
+ */
+typedef struct {
+    uint32_t pending;
+    TaskHandle_t waiter;
+} work_pool_group_t;
+
+/*
+ * 一个任务。由调用者提供存储 (池子本身不分配内存)，必须活到任务跑完。
+ */
+typedef struct {
+    work_pool_fn_t fn;
+    void *arg;
+    work_pool_group_t *group;
+} work_pool_job_t;
+
+/* 每个 worker 的统计 (只由该 worker 自己写) */
+typedef struct {
+    uint32_t executed;      // 跑完的任务数
+    uint32_t local;         // 从自己的 deque 取到的
+    uint32_t injected;      // 从注入队列 (池外提交) 取到的
+    uint32_t stolen;        // 从另一个 worker 的 deque 偷到的
+    uint32_t steal_fails;   // 看到有活但 CAS 输给了别人
+    uint32_t inline_runs;   // deque 满了，submit 时直接就地执行的
+    uint32_t sleeps;        // 没活干进入阻塞的次数
+} work_pool_stats_t;
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * -------------------------------------------------------------------------- */
+/**
+ * @brief 每个核建一个常驻 worker (绑核)，重复调用无副作用
+ */
+esp_err_t work_pool_init(void);
+
+/**
+ * @brief 停止并删除所有 worker。调用前所有任务组必须已经 wait 完
+ */
+void work_pool_deinit(void);
+
+/**
+ * @brief 清零任务组，并把当前任务登记为等待者
+ * 同时清掉该任务在 work_pool 专用通知槽 (索引 1) 上残留的通知，默认槽 (0) 不受影响
+ */
+void work_pool_group_init(work_pool_group_t *group);
+
+/**
+ * @brief 提交一个任务
+ *
+ * 在任务里调用 (fork-join 式拆分)：压进当前 worker 自己的 deque，无锁；
+ * 空闲的另一个 worker 会从 deque 的另一端偷走。
+ * 在池外调用：进注入队列 (满了就阻塞等待)。
+ *
+ * @param job   任务存储，由调用者提供
+ * @param group 可为 NULL (不需要等待时)
+ */
+esp_err_t work_pool_submit(work_pool_job_t *job, work_pool_fn_t fn, void *arg, work_pool_group_t *group);
+
+/**
+ * @brief 等任务组里所有任务跑完
+ *
+ * 在 worker 里调用时不会阻塞，而是边等边帮忙执行任务 (否则两个 worker 都在等时会死锁)。
+ * 在池外调用时阻塞，等的是调用任务在 work_pool 专用通知槽 (索引 1) 上的通知，默认槽 (0) 不受影响。
+ */
+void work_pool_wait(work_pool_group_t *group);
+
+/**
+ * @brief worker 的数量 (= 核数)
+ */
+int work_pool_worker_count(void);
+
+/**
+ * @brief 读取 / 清零 worker 统计
+ */
+void work_pool_get_stats(int worker, work_pool_stats_t *out);
+void work_pool_reset_stats(void);
+
+/**
+ * @brief 细粒度任务基准：单核循环 vs 池 (注入队列平铺提交 / 任务内二分拆分)
+ * 结果以 CSV 打印在 WORK_POOL_BENCH_BEGIN / WORK_POOL_BENCH_END 之间。
+ * 调用者不能是 worker，且要在 work_pool_init 之后调用。
+ */
+esp_err_t work_pool_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "work_pool.h"
+
+static const char *TAG = "WORK_POOL";
+
+#define DEQUE_SIZE      CONFIG_WORK_POOL_DEQUE_SIZE
+#define DEQUE_MASK      (DEQUE_SIZE - 1)
+#define CACHE_LINE      32
+
+_Static_assert((DEQUE_SIZE & DEQUE_MASK) == 0, "WORK_POOL_DEQUE_SIZE must be a power of 2");
+
+// 任务组完成的通知走专用槽，和调用者自己用的默认槽 (0) 分开：
+// 晚到的通知只会落在这里，group_init 时清掉，不会叫醒调用者别处的 ulTaskNotifyTake
+#define GROUP_NOTIFY_INDEX  1
+
+_Static_assert(configTASK_NOTIFICATION_ARRAY_ENTRIES > GROUP_NOTIFY_INDEX,
+               "work_pool needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2");
+
+// ----------------------------------------------------------------------
+// 1. Chase-Lev deque (固定容量，不扩容)
+// ----------------------------------------------------------------------
+/*
+ * 主人在 bottom 一端 push/pop (LIFO，刚拆出来的任务还热)，
+ * 小偷在 top 一端 steal (FIFO，偷走的是最早拆出来的、通常也是最大的一块)。
+ * 只有 deque 里剩最后一个任务时主人和小偷才需要用 CAS 抢 top。
+ * top/bottom 用有符号数：pop 时 bottom 会暂时比 top 小 1。
+ */
+typedef struct {
+    int32_t top __attribute__((aligned(CACHE_LINE)));       // 小偷改 (CAS)
+    int32_t bottom __attribute__((aligned(CACHE_LINE)));    // 只有主人改
+    work_pool_job_t *buf[DEQUE_SIZE];
+} ws_deque_t;
+
+static bool deque_push(ws_deque_t *q, work_pool_job_t *job)
+{
+    int32_t b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED);
+    int32_t t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    if (b - t >= DEQUE_SIZE) {
+        return false;
+    }
+    q->buf[b & DEQUE_MASK] = job;
+    // 先让槽里的指针可见，再发布新的 bottom
+    __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static work_pool_job_t *deque_pop(ws_deque_t *q)
+{
+    // [A] 先把 bottom 减 1 "预订" 最后一个槽，再看 top：两步之间必须是全序
+    int32_t b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&q->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t t = __atomic_load_n(&q->top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+        // 空
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    work_pool_job_t *job = q->buf[b & DEQUE_MASK];
+    if (t == b) {
+        // [B] 只剩一个：和小偷抢 top
+        if (!__atomic_compare_exchange_n(&q->top, &t, t + 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            job = NULL;
+        }
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+// 返回 NULL 且 *lost 为 true 表示有活但 CAS 没抢到
+static work_pool_job_t *deque_steal(ws_deque_t *q, bool *lost)
+{
+    int32_t t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t b = __atomic_load_n(&q->bottom, __ATOMIC_ACQUIRE);
+
+    *lost = false;
+    if (t >= b) {
+        return NULL;
+    }
+    work_pool_job_t *job = q->buf[t & DEQUE_MASK];
+    if (!__atomic_compare_exchange_n(&q->top, &t, t + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        *lost = true;
+        return NULL;
+    }
+    return job;
+}
+
+static bool deque_maybe_nonempty(const ws_deque_t *q)
+{
+    return __atomic_load_n(&q->bottom, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->top, __ATOMIC_ACQUIRE) > 0;
+}
+
+// ----------------------------------------------------------------------
+// 2. Worker 状态
+// ----------------------------------------------------------------------
+typedef struct {
+    ws_deque_t deque;
+    TaskHandle_t task;
+    uint32_t sleeping __attribute__((aligned(CACHE_LINE)));    // 1 = 阻塞在通知上
+    work_pool_stats_t stats;
+} worker_t;
+
+static worker_t s_workers[WORK_POOL_MAX_WORKERS];
+static int s_count = 0;
+static QueueHandle_t s_inject = NULL;           // 池外提交的任务 (指针)
+static SemaphoreHandle_t s_exited = NULL;
+static volatile bool s_running = false;
+
+static worker_t *current_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < s_count; i++) {
+        if (s_workers[i].task == self) {
+            return &s_workers[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 新任务出现后叫醒睡着的 worker。
+ * 与 worker 入睡前的 "置 sleeping -> 再查一遍有没有活" 配对 (两边都有全序栅栏)：
+ * 要么 worker 再查时看到了任务，要么这里看到了 sleeping = 1，不会两边都错过。
+ */
+static void wake_sleepers(const worker_t *self)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (int i = 0; i < s_count; i++) {
+        worker_t *w = &s_workers[i];
+        if (w != self && __atomic_load_n(&w->sleeping, __ATOMIC_RELAXED)) {
+            xTaskNotifyGive(w->task);
+        }
+    }
+}
+
+static void run_job(worker_t *w, work_pool_job_t *job)
+{
+    work_pool_group_t *g = job->group;
+    job->fn(job->arg);
+    if (w) {
+        w->stats.executed++;
+    }
+
+    // job 的存储属于调用者，fn 返回后就不再碰它。
+    // waiter 要在减计数之前取：减到 0 的那一刻等待者可能已经返回，group 所在的栈随之失效
+    if (g) {
+        TaskHandle_t waiter = g->waiter;
+        if (__atomic_sub_fetch(&g->pending, 1, __ATOMIC_ACQ_REL) == 0 && waiter) {
+            xTaskNotifyGiveIndexed(waiter, GROUP_NOTIFY_INDEX);
+        }
+    }
+}
+
+// 按 自己的 deque -> 注入队列 -> 别人的 deque 的顺序找一个任务
+static work_pool_job_t *find_job(worker_t *w)
+{
+    work_pool_job_t *job = deque_pop(&w->deque);
+    if (job) {
+        w->stats.local++;
+        return job;
+    }
+
+    if (xQueueReceive(s_inject, &job, 0) == pdTRUE) {
+        w->stats.injected++;
+        return job;
+    }
+
+    for (int i = 1; i < s_count; i++) {
+        worker_t *victim = &s_workers[(w - s_workers + i) % s_count];
+        bool lost;
+        job = deque_steal(&victim->deque, &lost);
+        if (job) {
+            w->stats.stolen++;
+            return job;
+        }
+        if (lost) {
+            w->stats.steal_fails++;
+        }
+    }
+    return NULL;
+}
+
+static bool any_work_visible(void)
+{
+    if (uxQueueMessagesWaiting(s_inject) > 0) {
+        return true;
+    }
+    for (int i = 0; i < s_count; i++) {
+        if (deque_maybe_nonempty(&s_workers[i].deque)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void worker_task(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+
+    while (s_running) {
+        work_pool_job_t *job = find_job(w);
+        if (job) {
+            run_job(w, job);
+            continue;
+        }
+
+        // 没活：先宣布要睡，再查一遍，确实没有才阻塞
+        __atomic_store_n(&w->sleeping, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (!any_work_visible() && s_running) {
+            w->stats.sleeps++;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        __atomic_store_n(&w->sleeping, 0, __ATOMIC_RELAXED);
+    }
+
+    xSemaphoreGive(s_exited);
+    vTaskDelete(NULL);
+}
+
+// ----------------------------------------------------------------------
+// 3. Public API
+// ----------------------------------------------------------------------
+esp_err_t work_pool_init(void)
+{
+    if (s_running) {
+        return ESP_OK;
+    }
+
+    s_inject = xQueueCreate(CONFIG_WORK_POOL_INJECT_DEPTH, sizeof(work_pool_job_t *));
+    s_exited = xSemaphoreCreateCounting(WORK_POOL_MAX_WORKERS, 0);
+    if (s_inject == NULL || s_exited == NULL) {
+        work_pool_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(s_workers, 0, sizeof(s_workers));
+    s_count = (portNUM_PROCESSORS < WORK_POOL_MAX_WORKERS) ? portNUM_PROCESSORS : WORK_POOL_MAX_WORKERS;
+    s_running = true;
+
+    for (int i = 0; i < s_count; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "PoolWorker%d", i);
+        if (xTaskCreatePinnedToCore(worker_task, name, CONFIG_WORK_POOL_STACK_SIZE, &s_workers[i],
+                                    CONFIG_WORK_POOL_TASK_PRIORITY, &s_workers[i].task, i) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create worker %d", i);
+            s_count = i;
+            work_pool_deinit();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "%d workers, deque %d, inject queue %d",
+             s_count, DEQUE_SIZE, CONFIG_WORK_POOL_INJECT_DEPTH);
+    return ESP_OK;
+}
+
+void work_pool_deinit(void)
+{
+    if (s_running) {
+        s_running = false;
+        for (int i = 0; i < s_count; i++) {
+            xTaskNotifyGive(s_workers[i].task);
+        }
+        for (int i = 0; i < s_count; i++) {
+            xSemaphoreTake(s_exited, portMAX_DELAY);
+        }
+    }
+    s_count = 0;
+    if (s_inject) {
+        vQueueDelete(s_inject);
+        s_inject = NULL;
+    }
+    if (s_exited) {
+        vSemaphoreDelete(s_exited);
+        s_exited = NULL;
+    }
+}
+
+void work_pool_group_init(work_pool_group_t *group)
+{
+    group->pending = 0;
+    group->waiter = xTaskGetCurrentTaskHandle();
+
+    // 上一组的最后一个任务可能在等待者看到计数归零、wait 返回之后才发出通知
+    xTaskNotifyStateClearIndexed(NULL, GROUP_NOTIFY_INDEX);
+    ulTaskNotifyValueClearIndexed(NULL, GROUP_NOTIFY_INDEX, UINT32_MAX);
+}
+
+esp_err_t work_pool_submit(work_pool_job_t *job, work_pool_fn_t fn, void *arg, work_pool_group_t *group)
+{
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    job->fn = fn;
+    job->arg = arg;
+    job->group = group;
+    if (group) {
+        __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+    }
+
+    worker_t *w = current_worker();
+    if (w) {
+        // 任务里提交：压进自己的 deque；满了就地执行 (深度优先，不会无限堆积)
+        if (!deque_push(&w->deque, job)) {
+            w->stats.inline_runs++;
+            run_job(w, job);
+            return ESP_OK;
+        }
+    } else {
+        xQueueSend(s_inject, &job, portMAX_DELAY);
+    }
+
+    wake_sleepers(w);
+    return ESP_OK;
+}
+
+void work_pool_wait(work_pool_group_t *group)
+{
+    worker_t *w = current_worker();
+
+    if (w) {
+        // worker 里等：边等边干活
+        while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0) {
+            work_pool_job_t *job = find_job(w);
+            if (job) {
+                run_job(w, job);
+            }
+        }
+        return;
+    }
+
+    // 本组里计数中途归零过 (边提交边完成) 也会多出通知，醒来后总是重新检查计数
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0) {
+        ulTaskNotifyTakeIndexed(GROUP_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    }
+}
+
+int work_pool_worker_count(void)
+{
+    return s_count;
+}
+
+void work_pool_get_stats(int worker, work_pool_stats_t *out)
+{
+    if (worker < 0 || worker >= s_count) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = s_workers[worker].stats;
+}
+
+void work_pool_reset_stats(void)
+{
+    for (int i = 0; i < s_count; i++) {
+        memset(&s_workers[i].stats, 0, sizeof(s_workers[i].stats));
+    }
+}
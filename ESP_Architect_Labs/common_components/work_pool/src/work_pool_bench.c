@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "work_pool.h"
+
+static const char *TAG = "POOL_BENCH";
+
+// ----------------------------------------------------------------------
+// 1. 参数
+// ----------------------------------------------------------------------
+#define BENCH_JOBS      1024
+#define BENCH_GRAIN     8           // 拆分到 <= 8 个条目就不再拆，直接循环做完
+#define BENCH_HEAVY     4           // 前 1/4 的条目代价是其余的 4 倍 (按下标静态对半分会失衡)
+
+static const uint32_t s_work_sizes[] = { 50, 500, 5000 };   // 每个条目的循环次数
+
+// ----------------------------------------------------------------------
+// 2. 被测的工作
+// ----------------------------------------------------------------------
+static uint32_t s_work = 0;
+static uint32_t s_results[BENCH_JOBS];
+
+static void bench_item_run(uint32_t i)
+{
+    uint32_t n = (i < BENCH_JOBS / 4) ? s_work * BENCH_HEAVY : s_work;
+    uint32_t x = i + 1;
+    for (uint32_t k = 0; k < n; k++) {
+        x = x * 1664525u + 1013904223u;
+    }
+    s_results[i] = x;
+}
+
+static uint32_t results_sum(void)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < BENCH_JOBS; i++) {
+        sum = sum * 31 + s_results[i];
+        s_results[i] = 0;
+    }
+    return sum;
+}
+
+// [平铺] 每个条目一个任务，全部从池外提交 (走注入队列)
+static work_pool_job_t s_flat_jobs[BENCH_JOBS];
+
+static void bench_flat_job(void *arg)
+{
+    bench_item_run((uint32_t)(uintptr_t)arg);
+}
+
+// [拆分] 一个根任务，在任务里对半拆：右半边压进自己的 deque 等着被偷，自己接着拆左半边
+typedef struct {
+    uint16_t lo;
+    uint16_t hi;
+} bench_range_t;
+
+#define BENCH_RANGE_NODES   (BENCH_JOBS / BENCH_GRAIN + 1)
+
+static work_pool_job_t s_range_jobs[BENCH_RANGE_NODES];
+static bench_range_t s_ranges[BENCH_RANGE_NODES];
+static uint32_t s_range_used = 0;
+static work_pool_group_t s_group;
+
+static void bench_split_job(void *arg)
+{
+    const bench_range_t *r = (const bench_range_t *)arg;
+    uint32_t lo = r->lo;
+    uint32_t hi = r->hi;
+
+    while (hi - lo > BENCH_GRAIN) {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t k = __atomic_fetch_add(&s_range_used, 1, __ATOMIC_RELAXED);
+        s_ranges[k].lo = mid;
+        s_ranges[k].hi = hi;
+        work_pool_submit(&s_range_jobs[k], bench_split_job, &s_ranges[k], &s_group);
+        hi = mid;
+    }
+    for (uint32_t i = lo; i < hi; i++) {
+        bench_item_run(i);
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3. 运行一种方式
+// ----------------------------------------------------------------------
+typedef enum {
+    BENCH_SINGLE_CORE,
+    BENCH_POOL_FLAT,
+    BENCH_POOL_SPLIT,
+} bench_mode_t;
+
+static const char *const s_mode_names[] = { "single_core", "pool_flat", "pool_split" };
+
+static int64_t run_mode(bench_mode_t mode)
+{
+    int64_t t0 = esp_timer_get_time();
+
+    switch (mode) {
+    case BENCH_SINGLE_CORE:
+        for (uint32_t i = 0; i < BENCH_JOBS; i++) {
+            bench_item_run(i);
+        }
+        break;
+
+    case BENCH_POOL_FLAT:
+        work_pool_group_init(&s_group);
+        for (uint32_t i = 0; i < BENCH_JOBS; i++) {
+            work_pool_submit(&s_flat_jobs[i], bench_flat_job, (void *)(uintptr_t)i, &s_group);
+        }
+        work_pool_wait(&s_group);
+        break;
+
+    case BENCH_POOL_SPLIT:
+        work_pool_group_init(&s_group);
+        s_range_used = 1;
+        s_ranges[0].lo = 0;
+        s_ranges[0].hi = BENCH_JOBS;
+        work_pool_submit(&s_range_jobs[0], bench_split_job, &s_ranges[0], &s_group);
+        work_pool_wait(&s_group);
+        break;
+    }
+
+    return esp_timer_get_time() - t0;
+}
+
+// ----------------------------------------------------------------------
+// 4. 基准
+// ----------------------------------------------------------------------
+esp_err_t work_pool_bench_run(void)
+{
+    if (work_pool_worker_count() == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    printf("WORK_POOL_BENCH_BEGIN\n");
+    printf("mode,jobs,work_iters,elapsed_us,speedup,w0_executed,w1_executed,"
+           "w0_stolen,w1_stolen,steal_fails,injected,sleeps\n");
+
+    esp_err_t result = ESP_OK;
+    for (size_t s = 0; s < sizeof(s_work_sizes) / sizeof(s_work_sizes[0]); s++) {
+        s_work = s_work_sizes[s];
+        int64_t base_us = 0;
+        uint32_t expected = 0;
+
+        for (int m = BENCH_SINGLE_CORE; m <= BENCH_POOL_SPLIT; m++) {
+            work_pool_reset_stats();
+            int64_t us = run_mode(m);
+            uint32_t sum = results_sum();
+
+            if (m == BENCH_SINGLE_CORE) {
+                base_us = us;
+                expected = sum;
+            } else if (sum != expected) {
+                ESP_LOGE(TAG, "%s work=%lu: result mismatch", s_mode_names[m], (unsigned long)s_work);
+                result = ESP_FAIL;
+                continue;
+            }
+
+            work_pool_stats_t st[WORK_POOL_MAX_WORKERS];
+            uint32_t fails = 0, injected = 0, sleeps = 0;
+            for (int w = 0; w < WORK_POOL_MAX_WORKERS; w++) {
+                work_pool_get_stats(w, &st[w]);
+                fails += st[w].steal_fails;
+                injected += st[w].injected;
+                sleeps += st[w].sleeps;
+            }
+
+            printf("%s,%d,%lu,%lld,%.2f,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                   s_mode_names[m], BENCH_JOBS, (unsigned long)s_work, (long long)us,
+                   us > 0 ? (float)base_us / us : 0.0f,
+                   (unsigned long)st[0].executed, (unsigned long)st[1].executed,
+                   (unsigned long)st[0].stolen, (unsigned long)st[1].stolen,
+                   (unsigned long)fails, (unsigned long)injected, (unsigned long)sleeps);
+            fflush(stdout);
+        }
+    }
+
+    printf("WORK_POOL_BENCH_END\n");
+    return result;
+}